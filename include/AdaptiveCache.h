@@ -15,6 +15,8 @@
 #include <thread>
 #include "CachePolicy.h"
 #include "MemoryPool.h"
+#include "ShardedCounter.h"
+#include "TaskScheduler.h"
 
 // 可配置和自适应的缓存系统
 class AdaptiveCache {
@@ -39,7 +41,7 @@ public:
         // 自适应大小调整间隔（秒）
         std::chrono::seconds adjustment_interval;
         
-        // 内存池块大小
+        // 内存池块大小（保留：缓存项直接存放在链表节点中，不再单独分配）
         size_t memory_pool_block_size;
         
         // 是否启用自适应大小调整
@@ -86,12 +88,25 @@ public:
     
     // 基本操作接口
     void put(const std::string& key, const std::string& value);
+    // 批量写入：按分片分组，每组只加一次分片锁、一次策略锁；同一键按出现顺序生效
+    using KeyValueRefs = std::vector<std::pair<const std::string*, const std::string*>>;
+    void put_batch(const KeyValueRefs& items);
     std::optional<std::string> get(const std::string& key);
+    // 命中时把值赋给 out（复用 out 的容量），未命中返回 false
+    bool get_into(const std::string& key, std::string& out);
     bool contains(const std::string& key);
     bool remove(const std::string& key);
+    // 移除并返回缓存中的值，由调用方决定在哪里释放
+    std::optional<std::string> take(const std::string& key);
     
     // 管理接口
     void clear();
+    // 清空缓存但不在调用线程释放：各分片的数据整体移出并返回
+    struct Detached {
+        std::vector<std::list<CacheItem>> items;
+        std::vector<std::unordered_map<std::string, std::list<CacheItem>::iterator>> maps;
+    };
+    Detached detach_all();
     size_t size() const;
     size_t capacity() const;
     double hit_ratio() const;
@@ -131,22 +146,9 @@ private:
         using ItemIterator = typename ItemList::iterator;
         using KeyToItemMap = std::unordered_map<std::string, ItemIterator>;
         
-        ItemList items;                // 缓存项列表
+        ItemList items;                // 缓存项列表（节点即缓存项本身）
         KeyToItemMap item_map;         // 键到缓存项的映射
         mutable std::shared_mutex mutex; // 分片锁
-        MemoryPool<CacheItem> item_pool; // 缓存项对象池
-        
-        explicit Shard(size_t pool_block_size) : item_pool(pool_block_size) {}
-        
-        // 从内存池分配新的缓存项
-        CacheItem* allocate_item(const std::string& key, const std::string& value) {
-            return item_pool.allocate(key, value);
-        }
-        
-        // 释放缓存项回内存池
-        void deallocate_item(CacheItem* item) {
-            item_pool.deallocate(item);
-        }
     };
     
     // 决定key应该在哪个分片
@@ -155,21 +157,34 @@ private:
     // 获取特定分片
     Shard& get_shard(const std::string& key);
     
+    // 批量写入时延后的策略通知：true 为新增，false 为访问（调用方持有分片写锁）
+    using PendingNotify = std::vector<std::pair<bool, Shard::ItemIterator>>;
+    void notify_policy_locked(PendingNotify& pending);
+    
     // 驱逐过期或低优先级的项目
     void evict_items(Shard& shard, size_t count);
+    void evict_items_locked(Shard& shard, size_t count);  // 调用方已持有分片写锁
     
     // 检查并清理过期项
     void cleanup_expired(Shard& shard);
     
-    // 定期自适应调整大小的线程函数
-    void adjustment_thread_func();
+    // 按策略建议调整一次容量（后台调度器周期执行）
+    void adjust_capacity();
+    void start_adjustment_task();
+    
+    // 计算应该驱逐的项数（按分片本地项数估算，不读取全局计数）
+    size_t calculate_items_to_evict(const Shard& shard) const;
     
-    // 计算应该驱逐的项数
-    size_t calculate_items_to_evict() const;
+    // 分片容量：总容量平均分到各分片
+    size_t shard_capacity() const;
     
     // 更新缓存大小统计
     void update_size_stats(int delta);
     
+    // 更新内存用量统计
+    void update_memory_stats(ptrdiff_t delta);
+    static size_t item_footprint(const std::string& key, const std::string& value);
+    
     // 基本配置
     const size_t shard_count_;
     std::vector<std::unique_ptr<Shard>> shards_;
@@ -185,21 +200,20 @@ private:
     bool enable_adaptive_sizing_;
     std::chrono::seconds adjustment_interval_;
     
-    // 统计信息
-    alignas(CACHE_LINE_SIZE) mutable std::mutex stats_mutex_;
-    std::atomic<size_t> size_{0};
-    std::atomic<size_t> hits_{0};
-    std::atomic<size_t> misses_{0};
-    std::atomic<size_t> evictions_{0};
-    std::atomic<size_t> expirations_{0};
+    // 统计信息（分片计数，热路径上不争抢同一缓存行）
+    ShardedCounter size_;
+    ShardedCounter hits_;
+    ShardedCounter misses_;
+    ShardedCounter evictions_;
+    ShardedCounter expirations_;
+    ShardedCounter memory_usage_;
     
     // 清理阈值
     double cleanup_threshold_;
     double cleanup_target_;
     
-    // 自适应调整线程
-    std::thread adjustment_thread_;
-    std::atomic<bool> should_stop_{false};
+    // 自适应调整任务（后台任务调度器）
+    TaskScheduler::TaskId adjustment_task_ = 0;
     
     // 启动时间
     std::chrono::steady_clock::time_point start_time_;
@@ -0,0 +1,59 @@
+#pragma once
+#include "ShardedCounter.h"
+#include <atomic>
+#include <cstdint>
+
+/**
+ * 基于排队延迟的准入控制（CoDel 风格），每个 Worker 一个实例
+ * 排队延迟取就绪事件从 epoll_wait 返回到开始处理的时间（同一轮中排在前面的事件越慢，后面的等得越久）。
+ * 每个观测区间结束时，若区间内的最小排队延迟仍高于目标值，说明队列持续积压而非瞬时突发，
+ * 下一个区间进入过载状态；最小延迟回落到目标值以下即退出。
+ * 过载期间按优先级拒绝命令（回复 -BUSY），接受线程在所有 Worker 都过载时直接拒绝新连接。
+ * 只有所属 Worker 线程写入，过载标志可被其他线程无锁读取。
+ */
+class AdmissionControl {
+public:
+    struct Options {
+        bool enabled;
+        uint32_t target_us;     // 排队延迟目标
+        uint32_t interval_ms;   // 观测区间
+
+        Options()
+            : enabled(false)
+            , target_us(5000)
+            , interval_ms(100) {}
+    };
+
+    // 命令优先级：过载时低优先级最先被拒绝
+    enum class Priority {
+        Low,        // 慢命令：过载即拒绝
+        Normal,     // 普通读写：过载且本次排队超过 2 倍目标时拒绝
+        Critical,   // 管理与诊断命令：从不拒绝
+    };
+
+    explicit AdmissionControl(const Options& options = Options{});
+
+    bool enabled() const { return options_.enabled; }
+
+    // 事件循环每处理一个就绪事件调用一次
+    void on_event(uint64_t now_us, uint64_t sojourn_us);
+
+    // 事件循环空闲（epoll_wait 超时返回）：没有积压，立即退出过载状态
+    void on_idle();
+
+    bool overloaded() const { return overloaded_.load(std::memory_order_relaxed); }
+
+    // 过载时决定是否拒绝当前事件中的命令
+    bool should_shed(Priority priority) const;
+
+    uint64_t shed_count() const { return shed_.load(std::memory_order_relaxed); }
+    void record_shed() { single_writer_add(shed_); }
+
+private:
+    Options options_;
+    uint64_t interval_start_us_ = 0;
+    uint64_t min_sojourn_us_ = UINT64_MAX;
+    uint64_t current_sojourn_us_ = 0;
+    std::atomic<bool> overloaded_{false};
+    std::atomic<uint64_t> shed_{0};
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include "RedisServer.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * 启动时的硬件探测结果（Linux 下读取 sysfs / sysconf / getrlimit，其余平台只有 CPU 数）
+ */
+struct HardwareInfo {
+    size_t online_cpus = 0;      // 在线逻辑 CPU 数
+    size_t usable_cpus = 0;      // 进程亲和性掩码允许使用的逻辑 CPU 数
+    size_t physical_cores = 0;   // 可用逻辑 CPU 对应的物理核心数（SMT 兄弟线程算一个）
+    size_t numa_nodes = 1;
+    size_t l3_bytes = 0;         // 末级缓存大小（0=未知）
+    size_t total_memory = 0;     // 物理内存字节数（0=未知）
+    size_t page_size = 4096;
+    size_t fd_limit = 0;         // RLIMIT_NOFILE 软限制（0=不限或未知）
+
+    static HardwareInfo probe();
+};
+
+/**
+ * 硬件感知的自动调参：配置项取值为 auto 时，根据 CPU 拓扑、L3 大小、NUMA、内存与
+ * 文件描述符上限推导取值，并为每一项记录所选的值和依据。
+ * 开启 tuning.calibrate 时对有多个候选值的参数做一次短暂的压测（约 1 秒），取吞吐最高者。
+ */
+class AutoTune {
+public:
+    // 取值为 auto 的参数（RedisServer::Config::auto_params 位掩码）
+    enum Param : uint32_t {
+        WORKER_THREADS   = 1u << 0,
+        SLOW_THREADS     = 1u << 1,
+        SHARD_COUNT      = 1u << 2,
+        BUCKET_PER_SHARD = 1u << 3,
+        MAX_CONNECTIONS  = 1u << 4,
+        BUFFER_SIZE      = 1u << 5,
+    };
+
+    // 解析 config.auto_params 中的参数并写回 config
+    static void apply(RedisServer::Config& config);
+    static void apply(RedisServer::Config& config, const HardwareInfo& hw);
+
+private:
+    // 自校准：threads 个线程对 shards 个带锁分片做读多写少的随机访问，返回每秒操作数
+    static double measure(size_t threads, size_t shards, size_t buckets);
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include "ShardedCounter.h"
+#include <atomic>
+#include <cstdint>
+
+/**
+ * 自适应忙轮询（事件循环混合等待），每个 Worker 一个实例
+ * 阻塞在 epoll_wait 中的 Worker 被唤醒要经过一次调度，中等负载下这段延迟占了请求耗时的大头。
+ * 开启后，每次处理完事件都进入一个自旋窗口：窗口内以 0 超时轮询 epoll，窗口过去仍无事件才回到阻塞等待。
+ * 窗口按负载自适应：窗口内等到了事件就加倍（不超过 window_us），空转到期就减半（不低于 window_us / 16），
+ * 负载低到自旋总是落空时只剩很短的窗口，CPU 开销随之下降。
+ * 另外可在 TCP 连接上设置 SO_BUSY_POLL / SO_PREFER_BUSY_POLL，让内核在读取时直接轮询网卡队列。
+ * 只有所属 Worker 线程写入，统计可被其他线程无锁读取。
+ */
+class BusyPoll {
+public:
+    struct Options {
+        bool enabled;
+        uint32_t window_us;         // 活动后自旋窗口的上限
+        uint32_t socket_busy_poll_us;   // 连接上的 SO_BUSY_POLL（0 = 不设置）
+
+        Options()
+            : enabled(false)
+            , window_us(100)
+            , socket_busy_poll_us(50) {}
+    };
+
+    struct Stats {
+        uint64_t spin_wakeups = 0;      // 自旋轮询中等到的事件批次（省去一次调度唤醒）
+        uint64_t blocking_wakeups = 0;  // 阻塞等待后被唤醒的次数
+        uint64_t spin_timeouts = 0;     // 自旋窗口空转到期的次数
+        uint64_t spin_us = 0;           // 自旋窗口中未等到事件而空转的时间（额外消耗的 CPU）
+        uint32_t window_us = 0;         // 当前窗口
+    };
+
+    explicit BusyPoll(const Options& options = Options{});
+
+    bool enabled() const { return options_.enabled; }
+
+    // 本轮 epoll_wait 的超时：自旋窗口内为 0，否则为 blocking_ms
+    int timeout_ms(uint64_t now_us, int blocking_ms);
+
+    // epoll_wait 返回后调用：events 为返回的事件数，timeout_ms 为本轮使用的超时
+    void on_wait(uint64_t now_us, int events, int timeout_ms);
+
+    // 本轮事件处理完毕：开始新的自旋窗口
+    void on_processed(uint64_t now_us);
+
+    // 对新连接设置内核忙轮询选项（内核或权限不支持时忽略）
+    void configure_socket(int fd) const;
+
+    Stats stats() const;
+
+private:
+    Options options_;
+    uint32_t min_window_us_;
+    bool spinning_ = false;
+    uint64_t spin_start_us_ = 0;
+    uint64_t spin_deadline_us_ = 0;
+    uint64_t spin_end_us_ = 0;      // 最近一次窗口空转到期的时刻
+    std::atomic<uint32_t> window_us_;
+    std::atomic<uint64_t> spin_wakeups_{0};
+    std::atomic<uint64_t> blocking_wakeups_{0};
+    std::atomic<uint64_t> spin_timeouts_{0};
+    std::atomic<uint64_t> spin_us_{0};
+};
@@ -3,25 +3,32 @@
 #include <chrono>
 #include <cstdint>
 #include <memory>
+#include <vector>
+#include "Clock.h"
 
 // 缓存项的基类，记录基本的缓存指标
 class CacheItemMetrics {
 public:
-    // 访问时间
-    std::chrono::steady_clock::time_point last_access_time;
+    // 访问时间（粗粒度时钟的32位相对毫秒数）
+    uint32_t last_access_ms;
     
     // 访问次数
     uint32_t access_count = 0;
     
     CacheItemMetrics() 
-        : last_access_time(std::chrono::steady_clock::now()) {}
+        : last_access_ms(Clock::coarse_ms32()) {}
     
     // 记录访问，更新统计信息
     virtual void record_access() {
-        last_access_time = std::chrono::steady_clock::now();
+        last_access_ms = Clock::coarse_ms32();
         access_count++;
     }
     
+    // 距上次访问的毫秒数
+    uint32_t idle_ms() const {
+        return Clock::elapsed_ms(last_access_ms, Clock::coarse_ms32());
+    }
+    
     // 重置计数
     virtual void reset() {
         access_count = 0;
@@ -90,9 +97,8 @@ public:
     }
     
     double get_priority(const std::string& key, const CacheItemMetrics& metrics) const override {
-        // 返回上次访问时间的时间戳（越旧优先级越高）
-        return std::chrono::duration_cast<std::chrono::milliseconds>(
-            metrics.last_access_time.time_since_epoch()).count();
+        // 返回空闲时长（越久未访问优先级越高）
+        return metrics.idle_ms();
     }
     
     int get_size_adjustment() const override {
@@ -104,6 +110,11 @@ public:
     }
 };
 
+// 所有可用的缓存策略（离线缓存模拟器逐个对比）
+inline std::vector<CachePolicy::Type> all_cache_policy_types() {
+    return {CachePolicy::Type::LRU};
+}
+
 // 创建缓存策略的工厂函数
 inline std::unique_ptr<CachePolicy> create_cache_policy(CachePolicy::Type type) {
     // 只支持LRU策略
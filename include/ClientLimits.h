@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * 客户端资源限制
+ * 1. 令牌桶限速：按客户端名（CLIENT SETNAME）或来源地址匹配规则，限制每秒命令数与请求字节数；
+ *    超出时暂停读取该连接直到令牌补足（请求被延后而不是报错）。
+ * 2. 输出缓冲区限制（同 Redis client-output-buffer-limit normal）：超过硬限制立即断开，
+ *    持续超过软限制达到指定秒数后断开。
+ * 3. 全局客户端内存上限：所有连接的输入/输出缓冲区总和超过上限时，从占用最多的连接开始逐出。
+ */
+struct ClientLimits {
+    struct RateRule {
+        std::string pattern;        // glob 模式
+        bool match_name;            // true 匹配客户端名，false 匹配来源地址（ip:port 或 unix 套接字路径）
+        double commands_per_sec;    // 0 = 不限
+        double bytes_per_sec;       // 0 = 不限
+
+        RateRule()
+            : match_name(false)
+            , commands_per_sec(0)
+            , bytes_per_sec(0) {}
+    };
+
+    std::vector<RateRule> rate_rules;   // 按顺序匹配，第一条命中的规则生效
+    size_t output_hard_bytes;           // 0 = 不限
+    size_t output_soft_bytes;           // 0 = 不限
+    uint32_t output_soft_seconds;
+    size_t max_client_memory;           // 所有连接缓冲区总和上限，0 = 不限
+
+    ClientLimits()
+        : output_hard_bytes(0)
+        , output_soft_bytes(0)
+        , output_soft_seconds(0)
+        , max_client_memory(0) {}
+
+    // 解析规则："name:<glob>|addr:<glob> [commands=<n>] [bytes=<n>[kb|mb|gb]]"，失败返回 false 并写入 error
+    static bool parse_rule(const std::string& spec, RateRule& rule, std::string& error);
+
+    // 规则的文本形式（parse_rule 的逆过程，CONFIG GET / REWRITE 使用）
+    static std::string format_rule(const RateRule& rule);
+    
+    // 查找适用的规则，未命中返回 nullptr
+    const RateRule* match(const std::string& name, const std::string& addr) const;
+};
+
+/**
+ * 令牌桶（单线程使用）：字节令牌可以透支，透支后需等待补足到非负才能继续读取
+ */
+struct TokenBucket {
+    double rate = 0;        // 每秒补充的令牌数，0 表示不限
+    double tokens = 0;
+    uint64_t last_us = 0;
+
+    bool limited() const { return rate > 0; }
+
+    // 桶容量为一秒的令牌量
+    void configure(double new_rate, uint64_t now_us) {
+        rate = new_rate;
+        tokens = new_rate;
+        last_us = now_us;
+    }
+
+    // 透支式扣减：用于无法拆分的量（一次 recv 读到的字节数）
+    void consume(double amount, uint64_t now_us) {
+        if (!limited()) return;
+        refill(now_us);
+        tokens -= amount;
+    }
+
+    // 令牌足够才扣减：用于逐条放行的命令
+    bool try_consume(double amount, uint64_t now_us) {
+        if (!limited()) return true;
+        refill(now_us);
+        if (tokens < amount) return false;
+        tokens -= amount;
+        return true;
+    }
+
+    // 令牌补足到 needed 所需的等待时间（微秒）
+    uint64_t wait_us(double needed = 0) const {
+        if (!limited() || tokens >= needed) return 0;
+        return static_cast<uint64_t>((needed - tokens) / rate * 1e6) + 1;
+    }
+
+    void refill(uint64_t now_us) {
+        if (now_us > last_us) {
+            tokens += (now_us - last_us) * rate / 1e6;
+            if (tokens > rate) tokens = rate;
+            last_us = now_us;
+        }
+    }
+};
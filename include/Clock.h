@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+/**
+ * 进程级时间服务
+ * 1. 粗粒度时钟：后台线程每毫秒刷新一次，热路径只读一个原子变量，用于 LRU、
+ *    过期与空闲判定等只需毫秒精度的时间戳；以进程启动为起点的32位毫秒数存储，
+ *    约49.7天回绕一次，比较时一律用无符号减法（elapsed_ms）得到正确的间隔。
+ * 2. 精确计时：x86 上读取经过校准的不变 TSC（rdtsc），其他平台或 TSC 不可靠时
+ *    回退到 steady_clock，用于命令延迟等微秒级测量。
+ * 未启动后台线程时粗粒度时钟直接读取 steady_clock，结果相同只是开销更大。
+ */
+class Clock {
+public:
+    struct Options {
+        std::chrono::milliseconds tick_interval;
+        std::chrono::milliseconds calibration_time;
+
+        Options()
+            : tick_interval(1)
+            , calibration_time(20) {}
+    };
+
+    static Clock& instance();
+
+    void start(const Options& options = Options{});
+    void stop();
+
+    // 粗粒度时钟：进程启动以来的毫秒数
+    static uint64_t coarse_ms() {
+        if (ticking_.load(std::memory_order_relaxed)) {
+            return coarse_ms_.load(std::memory_order_relaxed);
+        }
+        return precise_ms();
+    }
+
+    // 32位相对时间戳，用于在条目中紧凑存储
+    static uint32_t coarse_ms32() { return static_cast<uint32_t>(coarse_ms()); }
+
+    // 两个32位时间戳之间的间隔（处理回绕）
+    static uint32_t elapsed_ms(uint32_t since, uint32_t now) { return now - since; }
+
+    // 精确计时：读取计时单位（TSC周期或纳秒），差值用 ticks_to_us 换算
+    static uint64_t ticks();
+    static double ticks_to_us(uint64_t ticks) { return ticks * us_per_tick_; }
+
+    static bool using_tsc() { return use_tsc_; }
+    static double ticks_per_us() { return 1.0 / us_per_tick_; }
+
+private:
+    Clock();
+    ~Clock();
+
+    Clock(const Clock&) = delete;
+    Clock& operator=(const Clock&) = delete;
+
+    static uint64_t precise_ms();
+    void tick_loop(std::chrono::milliseconds interval);
+    void calibrate(std::chrono::milliseconds duration);
+
+    // 热路径读取的状态为静态成员，读取时无需经过单例的初始化检查
+    static inline std::atomic<uint64_t> coarse_ms_{0};
+    static inline std::atomic<bool> ticking_{false};
+    // 仅在 start() 中、工作线程创建之前写入
+    static inline bool use_tsc_ = false;
+    static inline double us_per_tick_ = 0.001;  // 默认以纳秒为计时单位
+
+    std::atomic<bool> running_{false};
+    std::thread tick_thread_;
+};
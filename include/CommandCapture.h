@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 缓存行大小
+#define CACHE_LINE_SIZE 64
+
+/**
+ * 命令流量抓取
+ * 工作线程把收到的命令（带时间戳与连接ID）编码后写入自己的无锁字节环形缓冲区，
+ * 后台线程周期性排空各缓冲区并顺序写入追踪文件（格式见 TraceFormat.h）。
+ * 按连接采样：被选中的连接记录全部命令，保证回放时单个连接的命令序列完整。
+ * 缓冲区满时丢弃记录并计数，不阻塞工作线程。
+ */
+class CommandCapture {
+public:
+    struct Options {
+        std::string file_name;        // 追踪文件名（位于抓取目录下）
+        uint32_t sample_rate;         // 每 sample_rate 个连接记录1个（1=全部记录）
+        uint64_t max_bytes;           // 文件达到该大小后自动停止（0=不限制）
+        size_t ring_capacity;         // 每个工作线程缓冲区字节数
+        std::chrono::milliseconds flush_interval;
+
+        Options()
+            : sample_rate(1)
+            , max_bytes(1024ull * 1024 * 1024)
+            , ring_capacity(1024 * 1024)
+            , flush_interval(10) {}
+    };
+
+    struct Status {
+        bool active = false;
+        std::string path;
+        uint32_t sample_rate = 0;
+        uint64_t records = 0;         // 已写入文件的记录数
+        uint64_t dropped = 0;         // 缓冲区满丢弃的记录数
+        uint64_t bytes_written = 0;
+    };
+
+    static CommandCapture& instance();
+
+    // 抓取文件所在目录
+    void set_directory(const std::string& directory);
+
+    bool start(const Options& options, std::string& error);
+    void stop();
+
+    bool active() const { return active_.load(std::memory_order_relaxed); }
+
+    // 工作线程调用：记录一条命令
+    void record(uint64_t connection_id, const std::vector<std::string>& args);
+
+    Status status() const;
+
+private:
+    CommandCapture() = default;
+    ~CommandCapture();
+
+    CommandCapture(const CommandCapture&) = delete;
+    CommandCapture& operator=(const CommandCapture&) = delete;
+
+    // 单生产者单消费者字节环：每帧为 [len u32][session u32][payload]
+    struct ByteRing {
+        explicit ByteRing(size_t capacity);
+
+        bool push(uint32_t session, const std::string& payload);  // 生产者
+        void drain(std::string& out);                              // 消费者：追加所有完整帧
+
+        const size_t mask;
+        std::unique_ptr<char[]> data;
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> head{0};  // 生产者写
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail{0};  // 消费者写
+        alignas(CACHE_LINE_SIZE) std::atomic<bool> retired{false};
+
+    private:
+        void copy_in(size_t pos, const void* src, size_t len);
+        void copy_out(size_t pos, char* dst, size_t len) const;
+    };
+
+    ByteRing* local_ring();
+    void writer_loop();
+    void flush_rings(std::string& scratch);
+    void close_file();
+
+    std::atomic<bool> active_{false};
+    std::atomic<uint32_t> session_{0};        // 每次 start 递增，丢弃上次会话残留的帧
+    std::atomic<uint32_t> sample_rate_{1};
+    std::atomic<size_t> ring_capacity_{1024 * 1024};  // 线程首次记录时按此大小创建缓冲区
+    std::atomic<uint64_t> start_ticks_{0};
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+
+    // start/stop/status 之间的互斥
+    mutable std::mutex control_mutex_;
+    std::string directory_ = "./traces";
+    std::string path_;
+    Options options_;
+    FILE* file_ = nullptr;
+    std::thread writer_thread_;
+    std::atomic<bool> writer_running_{false};
+
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<ByteRing>> rings_;
+};
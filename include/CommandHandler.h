@@ -4,46 +4,121 @@
 #include <unordered_map>
 #include <functional>
 #include <memory>
+#include <atomic>
+#include <mutex>
 #include "DataStore.h"
+#include "HotKeys.h"
+#include "NearCache.h"
+#include "Metrics.h"
+#include "ModuleManager.h"
+#include "ReplyBuilder.h"
+#include "ConfigRegistry.h"
 
 class CommandHandler {
 public:
-    explicit CommandHandler(std::shared_ptr<DataStore> store = nullptr);
+    explicit CommandHandler(std::shared_ptr<DataStore> store = nullptr,
+                            const HotKeyTracker::Options& hotkey_options = HotKeyTracker::Options{});
 
-    // 单个命令处理
+    // 命令标志
+    static constexpr uint32_t CMD_SLOW = 1;   // 可能耗时：由 Worker 交给慢命令线程池执行
+    static constexpr uint32_t CMD_ADMIN = 2;  // 管理与诊断命令：过载时也不拒绝
+
+    // 单个命令处理：回复追加到 reply 指向的输出缓冲区
+    void handle(const std::vector<std::string>& cmd, ReplyBuilder& reply);
+    
+    // 同上，回复以独立字符串返回（慢命令线程池、共享内存会话等不直接持有连接缓冲区的调用方）
     std::string handle(const std::vector<std::string>& cmd);
     
+    // 管道写合并：从 begin 开始的连续 SET 一次批量写入存储，回复按顺序追加；
+    // 返回合并执行的命令数，不足两条时返回 0（由调用方逐条执行）
+    size_t handle_set_run(const std::vector<std::vector<std::string>>& commands, size_t begin,
+                          ReplyBuilder& reply);
+    
+    // 命令是否应交给慢命令线程池（带 CMD_SLOW 标志且参数数达到阈值）
+    bool is_slow(const std::vector<std::string>& cmd) const;
+    
+    // 命令标志（名称不区分大小写），未知命令返回 0；只在过载判定等冷路径上使用
+    uint32_t command_flags(const std::vector<std::string>& cmd) const;
+    
+    // 命令统计快照（汇总各线程计数，不阻塞命令执行）
+    std::vector<CommandMetrics::Snapshot> get_command_stats() const { return cmd_metrics_.snapshot(); }
+
+    // 加载模块并注册其命令（只能在服务启动前调用），失败时抛出 std::runtime_error
+    void load_module(const std::string& spec);
+    
+    // CONFIG GET/SET/REWRITE 使用的参数注册表（只能在服务启动前设置，未设置时 CONFIG 返回错误）
+    void set_config_registry(std::shared_ptr<ConfigRegistry> registry) { config_registry_ = std::move(registry); }
+    
+    // 管道写合并单次最多合并的 SET 条数（运行时可修改）
+    void set_max_set_run(size_t count) { max_set_run_.store(count, std::memory_order_relaxed); }
+    
+    // 每个线程近端缓存的条目数（0 = 关闭，运行时可修改，各线程下一次读取时生效）；
+    // 准入依赖热点键采样，采样关闭时近端缓存不会有条目
+    void set_near_cache_capacity(size_t entries) { near_cache_capacity_.store(entries, std::memory_order_relaxed); }
+    NearCache::Stats get_near_cache_stats();
 
 private:
     // 命令处理函数类型
-    using CommandFunc = std::function<std::string(const std::vector<std::string>&)>;
+    using CommandFunc = std::function<void(const std::vector<std::string>&, ReplyBuilder&)>;
     
-    // 命令处理函数缓存
-    std::unordered_map<std::string, CommandFunc> cmd_handlers_;
-    
-    // 命令统计
-    struct CommandStats {
-        uint64_t calls{0};        // 调用次数
-        uint64_t total_time{0};   // 总执行时间(微秒)
-        uint64_t max_time{0};     // 最长执行时间
-        uint64_t min_time{~0ull}; // 最短执行时间
+    // 命令表项：处理函数 + 统计槽下标 + 标志
+    struct CommandEntry {
+        CommandFunc func;
+        size_t stats_index;
+        uint32_t flags;
+        size_t slow_min_args;   // CMD_SLOW 命令在参数数（含命令名）不少于该值时才算慢命令
     };
-    std::unordered_map<std::string, CommandStats> cmd_stats_;
+    
+    // 命令处理函数缓存
+    std::unordered_map<std::string, CommandEntry> cmd_handlers_;
+    
+    // 带 CMD_SLOW 标志的命令（名称与阈值），is_slow 在此线性比较，避免每条命令多一次查表
+    std::vector<std::pair<std::string, size_t>> slow_commands_;
+    
+    // 命令统计（每线程无锁计数）
+    CommandMetrics cmd_metrics_;
+    size_t set_stats_index_ = 0;  // 合并执行的 SET 计入该统计槽
+    std::atomic<size_t> max_set_run_{128};
 
     // 数据存储
     std::shared_ptr<DataStore> store_;
 
+    // 热点键采样
+    HotKeyTracker hotkeys_;
+    
+    // 各线程的近端缓存（注册后不移除，生命周期与处理器一致）
+    NearCache& local_near_cache(size_t capacity);
+    const uint64_t id_;     // 处理器实例ID，线程本地的近端缓存按它区分实例（不复用）
+    std::atomic<size_t> near_cache_capacity_{0};
+    std::mutex near_caches_mutex_;
+    std::vector<std::unique_ptr<NearCache>> near_caches_;
+
+    // 服务器端模块
+    ModuleManager modules_;
+    
+    // 运行时配置
+    std::shared_ptr<ConfigRegistry> config_registry_;
+
     // 初始化命令处理函数
     void init_handlers();
-    
-    // 更新命令统计
-    void update_command_stats(const std::string& cmd_name, uint64_t execution_time);
+    void register_command(const std::string& name, CommandFunc func,
+                          uint32_t flags = 0, size_t slow_min_args = 0);
     
     // 常用命令的处理函数
-    std::string handle_set(const std::vector<std::string>& args);
-    std::string handle_get(const std::vector<std::string>& args);
-    std::string handle_del(const std::vector<std::string>& args);
-    std::string handle_mset(const std::vector<std::string>& args);
-    std::string handle_mget(const std::vector<std::string>& args);
-    std::string handle_info(const std::vector<std::string>& args);
+    void handle_set(const std::vector<std::string>& args, ReplyBuilder& reply);
+    void handle_get(const std::vector<std::string>& args, ReplyBuilder& reply);
+    // GET / MGET 的单键读取：近端缓存、热点准入，其余走共享缓存与存储
+    void reply_value(const std::string& key, ReplyBuilder& reply);
+    void handle_del(const std::vector<std::string>& args, ReplyBuilder& reply);
+    void handle_unlink(const std::vector<std::string>& args, ReplyBuilder& reply);
+    void handle_flushall(const std::vector<std::string>& args, ReplyBuilder& reply);
+    void handle_mset(const std::vector<std::string>& args, ReplyBuilder& reply);
+    void handle_mget(const std::vector<std::string>& args, ReplyBuilder& reply);
+    void handle_keys(const std::vector<std::string>& args, ReplyBuilder& reply);
+    void handle_info(const std::vector<std::string>& args, ReplyBuilder& reply);
+    void handle_hotkeys(const std::vector<std::string>& args, ReplyBuilder& reply);
+    void handle_latency(const std::vector<std::string>& args, ReplyBuilder& reply);
+    void handle_capture(const std::vector<std::string>& args, ReplyBuilder& reply);
+    void handle_module(const std::vector<std::string>& args, ReplyBuilder& reply);
+    void handle_config(const std::vector<std::string>& args, ReplyBuilder& reply);
 };
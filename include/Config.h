@@ -1,14 +1,14 @@
 #pragma once
 #include "RedisServer.h"
+#include "ConfigRegistry.h"
 #include <string>
 
 class Config {
 public:
+    // 加载配置文件：未知参数给出警告，非法值抛出 std::runtime_error
     static RedisServer::Config load_from_file(const std::string& filename);
     static RedisServer::Config get_default_config();
-    
-private:
-    static int parse_int(const std::string& str, int default_val);
-    static size_t parse_size_t(const std::string& str, size_t default_val);
-    static bool parse_bool(const std::string& str, bool default_val);
+
+    // 把全部配置参数注册到 registry，绑定到 config 的字段（config 须比 registry 存活更久）
+    static void register_parameters(RedisServer::Config& config, ConfigRegistry& registry);
 };
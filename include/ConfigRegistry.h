@@ -0,0 +1,144 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * 配置快照（RCU 风格发布）：写者构造新对象后整体替换，读者拿到的 shared_ptr 在用完前一直有效，
+ * 旧快照在最后一个读者释放后回收。热路径只比较版本号（一次原子读），变化时才重新获取快照。
+ */
+template <typename T>
+class ConfigSnapshot {
+public:
+    explicit ConfigSnapshot(const T& initial = T{}) : current_(std::make_shared<const T>(initial)) {}
+
+    std::shared_ptr<const T> load() const {
+        return std::atomic_load_explicit(&current_, std::memory_order_acquire);
+    }
+
+    // 先替换快照再递增版本号：读者看到新版本号时一定能取到新快照
+    void publish(const T& value) {
+        std::atomic_store_explicit(&current_, std::make_shared<const T>(value), std::memory_order_release);
+        version_.fetch_add(1, std::memory_order_release);
+    }
+
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+private:
+    std::shared_ptr<const T> current_;
+    std::atomic<uint64_t> version_{0};
+};
+
+/**
+ * 配置参数注册表：配置文件加载与 CONFIG GET / SET / REWRITE 共用
+ * 1. 每个参数名为 "section.key"，绑定到配置结构体的字段，带类型与取值校验；
+ *    数值支持乘法表达式（"1024 * 256"），字节数支持 kb/mb/gb 单位；
+ * 2. 注册了 on_change 回调的参数可在运行时修改，SET 写入字段后调用回调使其生效，
+ *    其余参数只能在启动时通过配置文件设置；
+ * 3. REWRITE 只改写运行时修改过的参数所在的行，其余行与注释保持原样。
+ * 所有操作在内部互斥锁下进行，可从任意线程调用。
+ */
+class ConfigRegistry {
+public:
+    // 参数标志
+    static constexpr uint32_t REPEATABLE = 1;  // 配置文件中每行一项、可重复出现；CONFIG 中各项以 ';' 分隔
+
+    // 校验并写入绑定的字段，失败返回 false 并写入 error（字段保持不变）
+    using Setter = std::function<bool(const std::string& value, std::string& error)>;
+    // 当前值的文本形式（CONFIG GET 返回、REWRITE 写入）
+    using Getter = std::function<std::string()>;
+
+    void add(const std::string& section, const std::string& key, Setter set, Getter get, uint32_t flags = 0);
+
+    template <typename T>
+    void add_integer(const std::string& section, const std::string& key, T& field,
+                     unsigned long long min = 0,
+                     unsigned long long max = std::numeric_limits<T>::max()) {
+        add_number(section, key, field, min, max, false);
+    }
+
+    // 字节数：允许 kb/mb/gb 单位
+    template <typename T>
+    void add_bytes(const std::string& section, const std::string& key, T& field,
+                   unsigned long long min = 0,
+                   unsigned long long max = std::numeric_limits<T>::max()) {
+        add_number(section, key, field, min, max, true);
+    }
+
+    void add_bool(const std::string& section, const std::string& key, bool& field);
+    void add_string(const std::string& section, const std::string& key, std::string& field);
+    // 取值只能是 choices 之一（不区分大小写，保存为小写）
+    void add_enum(const std::string& section, const std::string& key, std::string& field,
+                  std::vector<std::string> choices);
+
+    // 运行时修改后的生效回调；未注册回调的参数不能通过 CONFIG SET 修改
+    void on_change(const std::string& name, std::function<void()> hook);
+
+    // 从配置文件加载：未知参数给出警告，非法值抛出 std::runtime_error（带文件名与行号）；
+    // 文件不存在时保留默认值。记录路径供 REWRITE 使用
+    void load_file(const std::string& path);
+
+    // 配置文件路径（REWRITE 写回的位置），启动时已由其他注册表加载过文件时使用
+    void set_path(const std::string& path);
+
+    // CONFIG GET：参数名匹配 glob 模式（不区分大小写），按注册顺序返回 (名称, 值)
+    std::vector<std::pair<std::string, std::string>> get(const std::string& pattern) const;
+
+    // CONFIG SET：全部成功才生效，任一参数失败时已写入的参数恢复原值
+    bool set(const std::vector<std::pair<std::string, std::string>>& items, std::string& error);
+
+    // CONFIG REWRITE：把运行时修改过的参数写回配置文件（写临时文件后原子替换）
+    bool rewrite(std::string& error);
+
+    // 数值解析："<n>[单位] [* <n>[单位]]..."，bytes 为 false 时不允许单位
+    static bool parse_number(const std::string& text, bool bytes, unsigned long long& value);
+    static bool parse_bool(const std::string& text, bool& value);
+
+private:
+    struct Parameter {
+        std::string name;       // section.key
+        std::string section;
+        std::string key;
+        uint32_t flags;
+        Setter set;
+        Getter get;
+        std::function<void()> on_change;
+    };
+
+    template <typename T>
+    void add_number(const std::string& section, const std::string& key, T& field,
+                    unsigned long long min, unsigned long long max, bool bytes) {
+        add(section, key,
+            [&field, min, max, bytes](const std::string& value, std::string& error) {
+                unsigned long long number = 0;
+                if (!parse_number(value, bytes, number)) {
+                    error = "invalid number '" + value + "'";
+                    return false;
+                }
+                if (number < min || number > max) {
+                    error = "value " + std::to_string(number) + " out of range [" + std::to_string(min) +
+                            ", " + std::to_string(max) + "]";
+                    return false;
+                }
+                field = static_cast<T>(number);
+                return true;
+            },
+            [&field] { return std::to_string(field); });
+    }
+
+    Parameter* find(const std::string& name);
+
+    std::vector<Parameter> params_;                     // 注册顺序
+    std::unordered_map<std::string, size_t> index_;     // 名称 -> params_ 下标
+    std::set<size_t> dirty_;                            // 运行时修改过、尚未写回文件的参数
+    std::string path_;
+    mutable std::mutex mutex_;
+};
@@ -10,13 +10,15 @@
 #include <list>
 #include <chrono>
 #include <fstream>
-#include <zlib.h>
 #include <shared_mutex>
 #include <thread>
 #include <atomic>
+#include <condition_variable>
 #include "MemoryPool.h"
 #include "AdaptiveCache.h"
 #include "CachePolicy.h"
+#include "LazyFree.h"
+#include "TaskScheduler.h"
 #include <array>
 
 // 定义缓存行大小为64字节，通常CPU缓存行大小
@@ -35,6 +37,9 @@ public:
         size_t cache_shards;            // 缓存的分片数量
         CachePolicy::Type cache_policy; // 缓存策略类型
         bool adaptive_cache_sizing;     // 是否启用自适应缓存大小调整
+        size_t lazyfree_threshold;      // UNLINK 时值不小于该字节数则交给后台线程释放
+        bool enable_cache;              // 是否在存储前放一层共享缓存（AdaptiveCache）
+        bool enable_persistence;        // 是否启动时加载、周期落盘、析构时保存
 
         // 默认配置值
         static constexpr size_t DEFAULT_SHARD_COUNT = 128;
@@ -45,6 +50,7 @@ public:
         static constexpr size_t DEFAULT_MEMORY_POOL_BLOCK_SIZE = 4096;
         static constexpr size_t DEFAULT_BUCKET_PER_SHARD = 16;  // 每个分片默认16个桶
         static constexpr size_t DEFAULT_CACHE_SHARDS = 32;      // 缓存默认32个分片
+        static constexpr size_t DEFAULT_LAZYFREE_THRESHOLD = 64 * 1024;
 
         Options()
             : 
@@ -57,26 +63,94 @@ public:
             , bucket_per_shard(DEFAULT_BUCKET_PER_SHARD)
             , cache_shards(DEFAULT_CACHE_SHARDS)
             , cache_policy(CachePolicy::Type::LRU)
-            , adaptive_cache_sizing(true) {}
+            , adaptive_cache_sizing(true)
+            , lazyfree_threshold(DEFAULT_LAZYFREE_THRESHOLD)
+            , enable_cache(true)
+            , enable_persistence(true) {}
     };
 
     explicit DataStore(const Options& options = Options{});
     ~DataStore();
 
-    // 使用string_view版本接口，减少字符串拷贝
+    // string_view 接口：转换为 std::string 后调用下面的版本
     void set(std::string_view key, std::string_view value);
     std::optional<std::string> get(std::string_view key);
     bool del(std::string_view key);
     
     
-    // 保留原有的std::string接口以保持兼容性
-    void set(const std::string& key, const std::string& value);
+    // std::string 接口：键值直接使用，不再拷贝出临时字符串
+    void set(const std::string& key, const std::string& value) { ops_.set(*this, key, value); }
     std::optional<std::string> get(const std::string& key);
-    bool del(const std::string& key);
+    bool del(const std::string& key) { return ops_.del(*this, key); }
     
+    // 读取到调用方的缓冲区（复用其容量），不存在返回 false；GET 热路径使用
+    bool get_into(const std::string& key, std::string& out) { return ops_.get_into(*this, key, out); }
     
+    // 值所在子map的写入纪元快照：纪元未变说明读取之后该子map没有任何写入提交
+    struct Version {
+        const std::atomic<uint64_t>* epoch = nullptr;
+        uint64_t value = 0;
+        
+        bool current() const { return epoch && epoch->load(std::memory_order_acquire) == value; }
+    };
+    // 绕过共享缓存，在子map读锁内读取值与纪元（两者一致）；供线程本地近端缓存填充
+    bool get_versioned(const std::string& key, std::string& out, Version& version) {
+        return ops_.get_versioned(*this, key, out, version);
+    }
+    
+    // 批量写入（管道中连续的 SET、MSET）：同一子map的写入在一次加锁内完成，
+    // 同一键按出现顺序生效，结果与逐条 set 相同；键和值由调用方持有
+    void set_batch(const AdaptiveCache::KeyValueRefs& items) { ops_.set_batch(*this, items); }
+    
+    // 与 del 相同，但值在锁内移出、锁外释放，大值交给后台线程释放
+    bool unlink(std::string_view key);
+    // 清空所有数据；async 时各子map整体移出后由后台线程释放
+    void flush_all(bool async);
+    
+    // 匹配 glob 模式的全部键：逐个子map加读锁遍历，耗时与键总数成正比
+    std::vector<std::string> keys(const std::string& pattern);
+    
+    // 持久化统计
+    struct PersistenceStats {
+        uint64_t saves = 0;                 // 完成的全量落盘次数
+        uint64_t failures = 0;              // 落盘失败的分片次数
+        double last_duration_sec = 0.0;     // 最近一次落盘耗时
+        double total_duration_sec = 0.0;    // 累计落盘耗时
+        int64_t last_save_time = 0;         // 最近一次落盘完成时间（Unix秒）
+    };
+    
+    PersistenceStats get_persistence_stats() const;
+    AdaptiveCache::Stats get_cache_stats() const { return cache_.get_stats(); }
+    
+    // 运行时调整（CONFIG SET）
+    void set_cache_capacity(size_t capacity) { cache_.set_capacity(capacity); }
+    void set_cache_policy(CachePolicy::Type policy) { cache_.set_policy(policy); }
+    // 修改落盘间隔：从上一次落盘结束起按新间隔重新计算下一次落盘时间
+    void set_sync_interval(std::chrono::seconds interval);
+    LazyFree::Stats get_lazyfree_stats() const { return lazyfree_.stats(); }
+
+    // 每个桶的固定内存占用（子map头与各自的锁），自动调参据此估算锁元数据是否放得进 L3
+    static size_t bucket_bytes();
+
+    // 多键原子访问（读-改-写）：见文件末尾 KeyGuard
+    class KeyGuard;
+    KeyGuard lock_keys(const std::vector<std::string>& keys);
 
 private:
+    /**
+     * 热路径按功能组合预先实例化（Engine<值编码, 缓存层>，定义在 DataStore.cpp），
+     * 构造时按配置选定一组：运行期间读写路径不再判断是否压缩、是否经过共享缓存。
+     */
+    struct Ops {
+        void (*set)(DataStore&, const std::string&, const std::string&);
+        void (*set_batch)(DataStore&, const AdaptiveCache::KeyValueRefs&);
+        bool (*get_into)(DataStore&, const std::string&, std::string&);
+        bool (*get_versioned)(DataStore&, const std::string&, std::string&, Version&);
+        bool (*del)(DataStore&, const std::string&);
+    };
+    template <class Codec, class CacheLayer> struct Engine;
+    static const Ops& select_ops(const Options& options);
+
     void flush();
     // 存储桶结构，每个桶有自己的锁
     struct alignas(CACHE_LINE_SIZE) Bucket {
@@ -85,7 +159,13 @@ private:
         
         struct SubMap {
             std::unordered_map<std::string, std::string> store;
+            // 写入纪元：每次修改 store 时在写锁内递增（开启共享缓存时，写入在更新共享缓存之前
+            // 还会在锁外先递增一次）。与哈希表头同在第一条缓存行，只有写入
+            // 才会修改这条缓存行，近端缓存校验纪元时读的是各核心的共享副本，不与读锁计数争抢
+            std::atomic<uint64_t> epoch{0};
             alignas(CACHE_LINE_SIZE) mutable std::shared_mutex mutex; // 对齐互斥锁
+            
+            void bump() { epoch.fetch_add(1, std::memory_order_release); }
         };
         
         std::array<SubMap, SUB_MAPS_COUNT> sub_maps;
@@ -109,20 +189,16 @@ private:
         }
     };
 
-    // 压缩功能
-    static std::string compress(const std::string& data);
-    static std::string decompress(const std::string& data);
-
     // 持久化功能
-    void persist_shard(size_t shard_index);
+    bool persist_shard(size_t shard_index);
+    void persist_all();
     void load_shard(size_t shard_index);
-    void start_sync_thread();
-    void sync_routine();
 
     // 一致性哈希
     size_t get_shard_index(const std::string& key) const;
     size_t get_bucket_index(const std::string& key, size_t bucket_count) const;
     uint32_t hash(const std::string& key) const;
+    Bucket::SubMap& submap_for(const std::string& key);
 
     std::vector<std::unique_ptr<Shard>> shards_;
     const size_t shard_count_;
@@ -131,11 +207,49 @@ private:
     // 使用自适应缓存替代原来的LRUCache
     AdaptiveCache cache_;
     
+    const Ops& ops_;
     const bool enable_compression_;
+    const bool enable_cache_;
+    const bool enable_persistence_;
     const std::string persist_path_;
-    std::chrono::seconds sync_interval_;
+    const size_t lazyfree_threshold_;
     
-    // 同步线程
-    std::thread sync_thread_;
-    alignas(CACHE_LINE_SIZE) std::atomic<bool> should_stop_{false}; // 对齐原子变量
+    // 持久化统计（由落盘任务写入，指标读取方无锁读取）
+    std::atomic<uint64_t> persist_saves_{0};
+    std::atomic<uint64_t> persist_failures_{0};
+    std::atomic<uint64_t> persist_last_duration_us_{0};
+    std::atomic<uint64_t> persist_total_duration_us_{0};
+    std::atomic<int64_t> persist_last_save_time_{0};
+    
+    // 周期落盘任务（后台任务调度器）
+    TaskScheduler::TaskId sync_task_ = 0;
+
+    // 后台释放线程（最后声明：析构时最先停止并释放完队列）
+    LazyFree lazyfree_;
+
+public:
+    /**
+     * 对一组键所在的子map加写锁，持有期间对这些键的读写是原子的。
+     * 子map按地址排序后依次加锁（同一子map只锁一次），多个 KeyGuard 之间不会死锁。
+     * 只能访问加锁时声明的键；持有期间不要再调用 DataStore 的普通接口访问同一子map。
+     */
+    class KeyGuard {
+    public:
+        KeyGuard(KeyGuard&&) = default;
+        KeyGuard& operator=(KeyGuard&&) = default;
+
+        bool holds(const std::string& key) const;
+        std::optional<std::string> get(const std::string& key) const;
+        void set(const std::string& key, std::string_view value);
+        bool del(const std::string& key);
+
+    private:
+        friend class DataStore;
+        explicit KeyGuard(DataStore* store) : store_(store) {}
+        Bucket::SubMap* find(const std::string& key) const;
+
+        DataStore* store_;
+        std::vector<std::pair<std::string, Bucket::SubMap*>> keys_;
+        std::vector<std::unique_lock<std::shared_mutex>> locks_;
+    };
 };
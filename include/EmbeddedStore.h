@@ -0,0 +1,63 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * 进程内嵌入式存储（simple_redis_core 库的稳定 C++ 接口）
+ * 与服务器共用 DataStore / AdaptiveCache / 持久化实现，但调用方直接在本进程内读写，
+ * 不经过 TCP 回环与 RESP 编解码。
+ * 接口只暴露标准库类型，实现细节藏在 Impl 之后：库内部结构变化不影响调用方的二进制兼容。
+ * 所有方法均可被多个线程并发调用；构造失败（如持久化目录无法创建）时抛出 std::exception。
+ */
+class EmbeddedStore {
+public:
+    struct Options {
+        size_t shard_count;
+        size_t cache_size;                  // 缓存条目数
+        size_t cache_shards;
+        bool enable_compression;
+        std::string persist_path;           // 持久化目录（以 '/' 结尾）
+        std::chrono::seconds sync_interval; // 后台落盘周期
+
+        Options()
+            : shard_count(128)
+            , cache_size(200000)
+            , cache_shards(32)
+            , enable_compression(false)
+            , persist_path("./data/")
+            , sync_interval(600) {}
+    };
+
+    struct Stats {
+        uint64_t cache_hits = 0;
+        uint64_t cache_misses = 0;
+        uint64_t cache_evictions = 0;
+        uint64_t cache_items = 0;
+        uint64_t persistence_saves = 0;
+        uint64_t persistence_failures = 0;
+    };
+
+    explicit EmbeddedStore(const Options& options = Options{});
+    ~EmbeddedStore();  // 停止后台同步并把全部数据落盘
+
+    EmbeddedStore(EmbeddedStore&&) noexcept;
+    EmbeddedStore& operator=(EmbeddedStore&&) noexcept;
+    EmbeddedStore(const EmbeddedStore&) = delete;
+    EmbeddedStore& operator=(const EmbeddedStore&) = delete;
+
+    void set(std::string_view key, std::string_view value);
+    std::optional<std::string> get(std::string_view key);
+    // 读到调用方提供的字符串中，便于循环调用时复用其容量
+    bool get(std::string_view key, std::string& value);
+    bool del(std::string_view key);
+
+    Stats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
@@ -0,0 +1,143 @@
+#pragma once
+#include "TaskScheduler.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Space-Saving 热点键草图
+ * 固定容量 k 个计数器，保证任何真实频次 > N/k 的键一定在表中，
+ * 每个计数器同时记录最大高估误差 error，估计值区间为 [count - error, count]
+ */
+class SpaceSavingSketch {
+public:
+    struct Counter {
+        std::string key;
+        uint64_t count = 0;
+        uint64_t error = 0;
+    };
+
+    explicit SpaceSavingSketch(size_t capacity = 64);
+
+    // 记录一次（或 weight 次）访问，返回该键的确定计数下界（count - error）
+    uint64_t offer(std::string_view key, uint64_t weight = 1);
+
+    // 合并另一个草图（带误差传递）
+    void merge(const SpaceSavingSketch& other);
+
+    // 按 count 降序返回前 n 项
+    std::vector<Counter> top(size_t n) const;
+
+    void clear();
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return counters_.size(); }
+    uint64_t total() const { return total_; }
+
+private:
+    size_t find_min() const;
+
+    size_t capacity_;
+    uint64_t total_ = 0;
+    std::vector<Counter> counters_;
+    std::unordered_map<std::string, size_t> index_;
+    std::string lookup_key_;    // offer 查找用的键缓冲区（复用容量）
+};
+
+/**
+ * 热点键追踪器
+ * 每个工作线程拥有独立的采样草图（thread_local 注册），热路径只做一次随机采样判断，
+ * 命中采样时才加锁（锁仅与合并线程竞争，几乎无争用）。
+ * 后台任务每隔 merge_interval 把各线程草图取出（清空）并合并成一个时间窗口的结果：
+ * 速率按窗口计算，线程本地的热点判定也只看最近一个窗口的采样，与查询频率无关。
+ */
+class HotKeyTracker {
+public:
+    struct Options {
+        bool enabled;
+        uint32_t sample_rate;                       // 每 sample_rate 次访问采样一次（向上取整为 2 的幂）
+        size_t sketch_capacity;                     // 每个草图的计数器数量
+        std::chrono::milliseconds merge_interval;   // 合并窗口
+
+        Options()
+            : enabled(true)
+            , sample_rate(16)
+            , sketch_capacity(64)
+            , merge_interval(1000) {}
+    };
+
+    struct HotKey {
+        std::string key;
+        uint64_t estimated_accesses = 0;    // 窗口内估计访问次数（已乘以采样率）
+        uint64_t error = 0;                 // 估计误差上界（已乘以采样率）
+        double ops_per_sec = 0.0;           // 窗口内估计访问速率
+    };
+
+    explicit HotKeyTracker(const Options& options = Options{});
+    ~HotKeyTracker();
+
+    HotKeyTracker(const HotKeyTracker&) = delete;
+    HotKeyTracker& operator=(const HotKeyTracker&) = delete;
+
+    // 热路径：记录一次键访问（按采样率过滤）。
+    // 本次被采样且该键在本线程草图中已是热点时返回 true（近端缓存据此准入）
+    bool record(std::string_view key) {
+        if (!enabled_) return false;
+        auto& state = local_state();
+        // xorshift 随机采样，避免固定步长与流水线模式产生混叠
+        state.rng ^= state.rng << 13;
+        state.rng ^= state.rng >> 7;
+        state.rng ^= state.rng << 17;
+        if ((state.rng & sample_mask_) != 0) return false;
+        return record_sampled(state, key);
+    }
+
+    // 返回最近一个完整窗口的前 n 个热点键（只读取已合并的结果）
+    std::vector<HotKey> top(size_t n);
+
+    // 结束当前窗口并合并（由周期任务调用，也可手动强制）
+    void merge();
+
+    bool enabled() const { return enabled_; }
+    uint32_t sample_rate() const { return sample_mask_ + 1; }
+
+private:
+    struct LocalSketch {
+        std::mutex mutex;
+        SpaceSavingSketch sketch;
+        explicit LocalSketch(size_t capacity) : sketch(capacity) {}
+    };
+
+    struct ThreadState {
+        LocalSketch* sketch = nullptr;
+        uint64_t rng = 0x9E3779B97F4A7C15ull;
+    };
+
+    // 判定热点所需的最少采样次数
+    static constexpr uint64_t HOT_MIN_SAMPLES = 8;
+
+    ThreadState& local_state();
+    ThreadState register_thread();
+    bool record_sampled(ThreadState& state, std::string_view key);
+
+    const uint64_t id_;  // 追踪器实例ID，线程本地注册按它区分实例（不复用）
+    const bool enabled_;
+    const uint32_t sample_mask_;
+    const size_t sketch_capacity_;
+    const std::chrono::milliseconds merge_interval_;
+
+    // 各线程草图（注册后不会移除，生命周期与追踪器一致）
+    std::mutex sketches_mutex_;
+    std::vector<std::unique_ptr<LocalSketch>> sketches_;
+
+    // 最近一次合并的窗口结果
+    std::mutex merge_mutex_;
+    std::vector<HotKey> last_window_;
+    std::chrono::steady_clock::time_point window_start_;
+
+    TaskScheduler::TaskId merge_task_ = 0;  // 周期合并任务（未启用时为 0）
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <atomic>
+
+/**
+ * 延迟事件监控（仿 Redis LATENCY 子系统）
+ * 超过阈值的事件（事件循环卡顿、慢命令等）按事件名记录最近 HISTORY_SIZE 个样本，
+ * 同一秒内的多个样本只保留最大值。事件很少发生，内部用一把互斥锁即可。
+ */
+class LatencyMonitor {
+public:
+    static constexpr size_t HISTORY_SIZE = 160;
+
+    struct Sample {
+        int64_t time = 0;       // Unix秒
+        uint64_t latency_ms = 0;
+    };
+
+    struct EventInfo {
+        std::string name;
+        Sample latest;
+        uint64_t max_latency_ms = 0;
+        uint64_t count = 0;             // 累计发生次数（含同秒合并）
+        uint64_t total_latency_ms = 0;
+        std::string last_detail;        // 最近一次附带的诊断信息（如卡顿线程的栈）
+    };
+
+    static LatencyMonitor& instance();
+
+    void set_threshold_ms(uint64_t ms) { threshold_ms_.store(ms, std::memory_order_relaxed); }
+    uint64_t threshold_ms() const { return threshold_ms_.load(std::memory_order_relaxed); }
+    bool enabled() const { return threshold_ms() > 0; }
+
+    // 超过阈值时记录一个样本；detail 为可选诊断信息
+    void add_sample_if_needed(const std::string& event, uint64_t latency_ms, const std::string& detail = "");
+
+    std::vector<EventInfo> latest() const;
+    std::vector<Sample> history(const std::string& event) const;
+    size_t reset(const std::vector<std::string>& events);  // 为空时重置全部，返回重置的事件数
+    std::string doctor() const;
+
+private:
+    LatencyMonitor() = default;
+
+    struct EventTimeSeries {
+        Sample samples[HISTORY_SIZE];
+        size_t next = 0;                // 下一个写入位置
+        EventInfo info;
+    };
+
+    std::atomic<uint64_t> threshold_ms_{100};
+    mutable std::mutex mutex_;
+    std::map<std::string, EventTimeSeries> events_;
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include "TaskScheduler.h"
+
+/**
+ * 后台惰性释放
+ * 大对象（大值、整批清空的子map）在锁内整体移出后交给后台任务调度器析构，
+ * 释放内存的耗时不再落在 Worker 线程上。对象以 shared_ptr<void> 排队，析构时使用其原本的类型；
+ * 队列由空变为非空时提交一次低优先级的释放任务，任务排空队列后结束。
+ * 析构 LazyFree 时会先释放完队列中剩余的对象。
+ */
+class LazyFree {
+public:
+    struct Stats {
+        uint64_t pending = 0;   // 排队等待释放的对象数
+        uint64_t freed = 0;     // 已在后台释放的对象数
+    };
+
+    LazyFree();
+    ~LazyFree();
+
+    LazyFree(const LazyFree&) = delete;
+    LazyFree& operator=(const LazyFree&) = delete;
+
+    // 接管对象（移动构造），稍后在后台线程析构
+    template <typename T>
+    void free(T&& object) {
+        enqueue(std::make_shared<std::decay_t<T>>(std::forward<T>(object)));
+    }
+
+    Stats stats() const;
+
+private:
+    void enqueue(std::shared_ptr<void> object);
+    // 释放任务：排空队列，期间新入队的对象一并释放
+    void drain();
+
+    std::mutex mutex_;
+    std::deque<std::shared_ptr<void>> queue_;
+    TaskScheduler::TaskId task_ = 0;    // 已提交、尚未结束的释放任务（受 mutex_ 保护）
+    std::atomic<uint64_t> pending_{0};
+    std::atomic<uint64_t> freed_{0};
+};
@@ -0,0 +1,133 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 缓存行大小
+#define CACHE_LINE_SIZE 64
+
+/**
+ * 异步分级日志
+ * - 每个线程一个无锁 SPSC 环形缓冲区，调用方只做一次格式化和内存拷贝，不进入内核也不持有全局锁
+ * - 后台线程周期性汇集所有缓冲区，批量写出并只刷新一次
+ * - 每个调用点独立限速（每秒最多 rate_limit 条），超出部分计数并在下个窗口汇报
+ * - 缓冲区满时丢弃并计数，绝不阻塞调用方
+ * 后台线程未启动时（启动早期/关闭之后）退化为同步写出。
+ */
+class Logger {
+public:
+    enum class Level : uint8_t {
+        Debug = 0,
+        Info,
+        Warning,
+        Error,
+        Off
+    };
+
+    struct Options {
+        Level level;
+        uint32_t rate_limit_per_sec;            // 每个调用点每秒最多输出条数（0 表示不限速）
+        size_t ring_capacity;                   // 每线程缓冲区记录数（向上取整为 2 的幂）
+        std::chrono::milliseconds flush_interval;
+
+        Options()
+            : level(Level::Info)
+            , rate_limit_per_sec(100)
+            , ring_capacity(512)
+            , flush_interval(10) {}
+    };
+
+    // 调用点状态（由日志宏以静态变量形式提供），用于限速
+    struct CallSite {
+        std::atomic<int64_t> window{0};
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint32_t> suppressed{0};
+    };
+
+    static Logger& instance();
+
+    void start(const Options& options = Options{});
+    void stop();
+
+    void set_level(Level level) { level_.store(level, std::memory_order_relaxed); }
+    Level level() const { return level_.load(std::memory_order_relaxed); }
+    bool enabled(Level level) const { return level >= level_.load(std::memory_order_relaxed); }
+
+    void set_rate_limit(uint32_t per_sec) { rate_limit_.store(per_sec, std::memory_order_relaxed); }
+
+    void log(Level level, CallSite& site, const char* fmt, ...) __attribute__((format(printf, 4, 5)));
+
+    // 统计：因缓冲区满被丢弃、因限速被抑制的日志条数
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t suppressed() const { return suppressed_.load(std::memory_order_relaxed); }
+
+    static bool parse_level(const std::string& name, Level& level);
+    static const char* level_name(Level level);
+
+private:
+    Logger() = default;
+    ~Logger();
+
+    static constexpr size_t MESSAGE_SIZE = 240;
+
+    struct Record {
+        int64_t timestamp_us;
+        Level level;
+        uint16_t length;
+        char message[MESSAGE_SIZE];
+    };
+
+    // 单生产者（所属线程）单消费者（后台线程）环形缓冲区
+    struct Ring {
+        explicit Ring(size_t capacity);
+
+        bool push(const Record& record);
+        bool pop(Record& record);
+
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> head{0};  // 生产者写
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail{0};  // 消费者写
+        alignas(CACHE_LINE_SIZE) std::atomic<bool> retired{false};  // 所属线程已退出
+        const size_t mask;
+        std::unique_ptr<Record[]> records;
+    };
+
+    Ring* local_ring();
+    void drain_loop();
+    size_t drain_once(std::string& out);
+    static void format_record(std::string& out, const Record& record);
+    static void write_out(const std::string& out);
+
+    std::atomic<Level> level_{Level::Info};
+    std::atomic<uint32_t> rate_limit_{100};
+    size_t ring_capacity_ = 512;
+    std::chrono::milliseconds flush_interval_{10};
+
+    std::atomic<bool> running_{false};
+    std::thread drain_thread_;
+
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<Ring>> rings_;
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> suppressed_{0};
+};
+
+#define LOG_AT(lvl, fmt, ...)                                                    \
+    do {                                                                         \
+        auto& _logger = Logger::instance();                                      \
+        if (_logger.enabled(lvl)) {                                              \
+            static Logger::CallSite _log_site;                                   \
+            _logger.log(lvl, _log_site, fmt, ##__VA_ARGS__);                     \
+        }                                                                        \
+    } while (0)
+
+#define LOG_DEBUG(fmt, ...) LOG_AT(Logger::Level::Debug, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...) LOG_AT(Logger::Level::Info, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...) LOG_AT(Logger::Level::Warning, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(fmt, ...) LOG_AT(Logger::Level::Error, fmt, ##__VA_ARGS__)
@@ -8,6 +8,8 @@
 #include <algorithm>
 #include <array>
 #include <limits>
+#include <atomic>
+#include "ShardedCounter.h"
 
 // 缓存行大小
 #define CACHE_LINE_SIZE 64
@@ -47,6 +49,14 @@ public:
     // 获取已分配的区域数量
     size_t allocated_chunks() const;
     
+    // 进程内所有块池的汇总统计（无锁读取）
+    struct GlobalStats {
+        size_t reserved_bytes = 0;  // 已向系统申请的区域总字节数
+        size_t used_bytes = 0;      // 已分配出去的块总字节数
+        size_t chunks = 0;          // 区域总数
+    };
+    static GlobalStats global_stats();
+    
 private:
     // 根据块大小计算每个区域包含的块数量
     // 小块使用更多数量，大块使用更少数量
@@ -75,6 +85,11 @@ private:
     
     // 保护池的互斥锁
     mutable std::mutex mutex_;
+    
+    // 全局汇总计数
+    static std::atomic<size_t> global_reserved_bytes_;
+    static ShardedCounter global_used_bytes_;   // 每次分配/释放都会更新，分片计数
+    static std::atomic<size_t> global_chunks_;
 };
 
 /**
@@ -0,0 +1,89 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ShardedCounter.h"
+
+/**
+ * 命令执行指标（每线程无锁计数）
+ * 每个线程在首次记录时注册一组独立的计数槽，只有该线程写入（relaxed 原子操作，
+ * 不产生跨核写竞争）；读取方（INFO / 指标导出）汇总所有线程的槽，从不阻塞数据路径。
+ */
+class CommandMetrics {
+public:
+    // 延迟直方图桶上界（微秒），最后一个桶为 +Inf
+    static constexpr std::array<uint64_t, 14> BUCKET_BOUNDS_US = {
+        1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 100000
+    };
+    static constexpr size_t BUCKET_COUNT = BUCKET_BOUNDS_US.size() + 1;
+
+    // 汇总后的单个命令统计
+    struct Snapshot {
+        std::string name;
+        uint64_t calls = 0;
+        uint64_t total_time_us = 0;
+        uint64_t max_time_us = 0;
+        uint64_t min_time_us = ~0ull;
+        std::array<uint64_t, BUCKET_COUNT> buckets{};  // 非累积计数
+    };
+
+    CommandMetrics();
+
+    CommandMetrics(const CommandMetrics&) = delete;
+    CommandMetrics& operator=(const CommandMetrics&) = delete;
+
+    // 注册命令，返回统计槽下标；必须在工作线程开始记录之前完成
+    size_t register_command(const std::string& name);
+
+    // 热路径：记录一次命令执行耗时
+    void record(size_t index, uint64_t time_us) {
+        auto& slot = local_slots()[index];
+        single_writer_add(slot.calls);
+        single_writer_add(slot.total_time_us, time_us);
+        if (time_us > slot.max_time_us.load(std::memory_order_relaxed)) {
+            slot.max_time_us.store(time_us, std::memory_order_relaxed);
+        }
+        if (time_us < slot.min_time_us.load(std::memory_order_relaxed)) {
+            slot.min_time_us.store(time_us, std::memory_order_relaxed);
+        }
+        auto& bucket = slot.buckets[bucket_index(time_us)];
+        single_writer_add(bucket);
+    }
+
+    // 汇总所有线程的统计（只返回调用过的命令）
+    std::vector<Snapshot> snapshot() const;
+
+    static size_t bucket_index(uint64_t time_us) {
+        for (size_t i = 0; i < BUCKET_BOUNDS_US.size(); ++i) {
+            if (time_us <= BUCKET_BOUNDS_US[i]) return i;
+        }
+        return BUCKET_BOUNDS_US.size();
+    }
+
+private:
+    // 单线程写入的计数槽
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> total_time_us{0};
+        std::atomic<uint64_t> max_time_us{0};
+        std::atomic<uint64_t> min_time_us{~0ull};
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+    };
+
+    struct ThreadSlots {
+        std::unique_ptr<Slot[]> slots;
+        size_t count = 0;
+    };
+
+    Slot* local_slots();
+
+    const uint64_t id_;  // 实例ID，线程本地注册按它区分实例（不复用）
+    std::vector<std::string> names_;
+
+    mutable std::mutex threads_mutex_;
+    std::vector<std::unique_ptr<ThreadSlots>> threads_;
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+/**
+ * Prometheus 指标导出器
+ * 在独立端口上运行一个极简 HTTP 监听（单独线程，逐个处理请求），
+ * GET /metrics 时调用渲染回调生成 Prometheus 文本格式；工作线程完全不参与。
+ */
+class MetricsExporter {
+public:
+    using RenderFunc = std::function<std::string()>;
+
+    MetricsExporter(std::string host, int port, RenderFunc render);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    void start();
+    void stop();
+
+    int port() const { return port_; }
+
+private:
+    void serve_loop();
+    void handle_connection(int client_fd);
+
+    std::string host_;
+    int port_;
+    RenderFunc render_;
+    int listen_fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+// Prometheus 文本格式辅助函数
+namespace prometheus {
+    // 输出 HELP/TYPE 头
+    void header(std::string& out, const std::string& name, const std::string& type, const std::string& help);
+    // 输出一个样本；labels 形如 worker="0"，为空时不输出花括号
+    void sample(std::string& out, const std::string& name, const std::string& labels, double value);
+    void sample(std::string& out, const std::string& name, const std::string& labels, uint64_t value);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "DataStore.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct sr_module;
+
+/**
+ * 服务器端模块管理（接口见 simple_redis_module.h）
+ * dlopen 加载模块共享库并调用 sr_module_onload，把模块注册的命令包装为普通命令处理函数：
+ * 执行前按声明的键位置对所有键加写锁，回调在锁内读写存储并构造回复。
+ * 命令表在服务器启动前构建、运行期间只读（Worker 无锁查表），因此模块只在启动时加载。
+ */
+class ModuleManager {
+public:
+    using CommandFunc = std::function<std::string(const std::vector<std::string>&)>;
+
+    struct Command {
+        std::string name;
+        CommandFunc func;
+    };
+
+    struct ModuleInfo {
+        std::string name;
+        int version = 0;
+        std::string path;
+        std::vector<std::string> commands;
+    };
+
+    explicit ModuleManager(std::shared_ptr<DataStore> store);
+    ~ModuleManager();
+
+    ModuleManager(const ModuleManager&) = delete;
+    ModuleManager& operator=(const ModuleManager&) = delete;
+
+    // spec 为 "路径 [参数...]"；command_exists 用于检查命令名冲突。失败时抛出 std::runtime_error
+    std::vector<Command> load(const std::string& spec,
+                              const std::function<bool(const std::string&)>& command_exists);
+
+    std::vector<ModuleInfo> list() const;
+
+private:
+    friend struct ::sr_module;
+    struct Module;
+
+    std::shared_ptr<DataStore> store_;
+    std::vector<std::unique_ptr<Module>> modules_;
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include "DataStore.h"
+#include "ShardedCounter.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Worker 线程本地的近端缓存（只放极热的读多写少键）
+ * 共享缓存与存储的读取都要获取子map读锁，读锁计数所在的缓存行在各核心之间来回迁移；
+ * 近端缓存命中时只读本线程的哈希表和值所在子map的写入纪元（只有写入才修改，各核心保有共享副本）。
+ * 1. 只准入热点采样判定为热点的键（HotKeyTracker::record 返回 true），值不超过 MAX_VALUE_SIZE；
+ * 2. 条目记录填充时子map的写入纪元，查找时纪元未变才算命中，否则丢弃条目；
+ *    写入方推进两次纪元：更新共享缓存之前在锁外一次（此后填充的条目读到的仍是旧值，
+ *    纪元却已是新的），提交时在写锁内再一次（使这些条目随之失效）；填充在读锁内同时读取
+ *    值与纪元，因此命中返回的值与写入之间保持线性一致；
+ * 3. 容量满时替换最久未命中的条目。
+ * 非线程安全：每个线程各持一份，由 CommandHandler 按线程创建；只有统计计数可从其他线程读取。
+ */
+class NearCache {
+public:
+    static constexpr size_t MAX_VALUE_SIZE = 16 * 1024;
+
+    explicit NearCache(size_t capacity = 0) : capacity_(capacity) {}
+
+    // 调整容量：变小时清空（0 = 关闭）
+    void set_capacity(size_t capacity);
+    size_t capacity() const { return capacity_; }
+
+    // 命中且纪元未变时返回缓存的值（到下一次修改本缓存前有效）；条目已失效时将其移除
+    const std::string* find(const std::string& key);
+
+    // 准入热点键：从存储读取值与纪元后放入缓存，value 返回读到的值。
+    // 键不存在返回 false（不缓存不存在的键）
+    bool admit(const std::string& key, DataStore& store, std::string& value);
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t invalidations = 0;     // 因子map有写入而丢弃的条目
+        uint64_t admissions = 0;
+        uint64_t entries = 0;
+    };
+    // 可从其他线程读取
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::string value;
+        DataStore::Version version;
+        uint64_t last_hit = 0;
+    };
+
+    size_t capacity_;
+    uint64_t tick_ = 0;
+    std::unordered_map<std::string, Entry> entries_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> invalidations_{0};
+    std::atomic<uint64_t> admissions_{0};
+    std::atomic<uint64_t> entry_count_{0};
+};
@@ -1,80 +1,55 @@
 #pragma once
 #include <string>
 #include <vector>
-#include <stdexcept>
 #include <string_view>
-#include <optional>
-#include <deque>
-#include <memory>
 
-// RESP协议解析器，支持增量解析和零拷贝
+// RESP协议解析器：增量解析客户端命令（由批量字符串组成的数组）
+// 不完整的消息留在内部缓冲区，下次收到数据后从该消息起点重新解析。
+// 解析结果直接写入命令数组，不构造中间的值树；配合 spare/recycle 复用命令数组和参数字符串，
+// 稳定状态下解析不分配内存。
 class RESPParser {
 public:
-    // 用于表示一个RESP类型的值
-    struct RESPValue {
-        enum class Type {
-            SimpleString,
-            Error,
-            Integer,
-            BulkString,
-            Array,
-            Invalid
-        };
-        
-        Type type = Type::Invalid;
-        std::string_view value; // 原始值的视图
-        std::vector<std::unique_ptr<RESPValue>> array; // 仅用于数组类型
-        
-        // 将RESPValue转换为命令格式（字符串数组）
-        std::vector<std::string> to_command() const;
-    };
-    
-    // 构造函数
+    using Command = std::vector<std::string>;
+    using CommandList = std::vector<Command>;
+
+    // 协议上限（与 Redis 默认值相同），超出视为协议错误
+    static constexpr long long MAX_BULK_LENGTH = 512LL * 1024 * 1024;
+    static constexpr long long MAX_ARRAY_LENGTH = 1024 * 1024;
+
     RESPParser() = default;
-    
-    // 增量解析，处理部分数据
-    // 返回解析出的完整命令列表，未完成的保持在内部状态中
-    std::vector<std::vector<std::string>> parse(std::string_view data);
-    
-    // 获取并清除当前已解析的所有命令
-    std::vector<std::vector<std::string>> get_commands();
+
+    // 增量解析，返回本次数据补全的全部命令
+    CommandList parse(std::string_view data);
+
+    // 同上，结果写入 commands（先清空）；命令数组优先从 spare 中取用（保留了上次的容量）
+    void parse(std::string_view data, CommandList& commands, CommandList& spare);
+
+    // 执行完毕后把命令归还到 spare 供下次解析复用，commands 清空
+    static void recycle(CommandList& commands, CommandList& spare);
 
 private:
-    // 解析状态
-    enum class ParseState {
-        Initial,        // 初始状态
-        ExpectingType,  // 期望类型标记(*,$,:,+,-)
-        ReadingBulkLen, // 正在读取批量字符串长度
-        ReadingBulk,    // 正在读取批量字符串内容
-        ReadingArrayLen,// 正在读取数组长度
-        ReadingArray,   // 正在读取数组元素
-        Complete        // 完成解析
-    };
-    
-    struct ParseContext {
-        ParseState state = ParseState::Initial;
-        std::string buffer; // 收集完整的数据缓冲区
-        size_t position = 0; // 当前解析位置
-        int remaining = 0; // 剩余元素数或剩余字节数
-        std::unique_ptr<RESPValue> current_value; // 当前正在解析的值
-        std::deque<std::unique_ptr<RESPValue>> completed_values; // 已完成的值
-        std::vector<std::unique_ptr<RESPValue>> value_stack; // 解析栈
+    enum class Result {
+        Complete,   // 解析出一条完整消息
+        Incomplete, // 数据不完整，等待更多数据
+        Invalid     // 协议错误
     };
-    
-    // 解析上下文
-    ParseContext context_;
-    
-    // 内部解析方法
-    std::optional<std::unique_ptr<RESPValue>> try_parse_next(std::string_view data);
-    std::optional<std::unique_ptr<RESPValue>> parse_simple_string(std::string_view data, size_t& pos);
-    std::optional<std::unique_ptr<RESPValue>> parse_error(std::string_view data, size_t& pos);
-    std::optional<std::unique_ptr<RESPValue>> parse_integer(std::string_view data, size_t& pos);
-    std::optional<std::unique_ptr<RESPValue>> parse_bulk_string(std::string_view data, size_t& pos);
-    std::optional<std::unique_ptr<RESPValue>> parse_array(std::string_view data, size_t& pos);
-    
+
+    // 从 pos 开始解析一条顶层消息；只有元素全是批量字符串的非空数组才是命令（写入 cmd）
+    Result parse_message(std::string_view data, size_t& pos, Command& cmd, bool& is_command);
+
+    // 跳过一个任意类型的值（命令数组中的非批量字符串元素、嵌套数组）
+    Result skip_value(std::string_view data, size_t& pos, int depth);
+
+    // 读取 pos 处类型标记之后到 CRLF 的内容，pos 移到 CRLF 之后
+    static Result read_line(std::string_view data, size_t& pos, std::string_view& line);
+    static bool parse_length(std::string_view text, long long& value);
+
     // 查找CRLF
     static size_t find_crlf(std::string_view data, size_t start);
-    
-    // 添加已完成的命令
-    void add_completed_command(std::unique_ptr<RESPValue> value);
+
+    static bool is_type_marker(char c) {
+        return c == '+' || c == '-' || c == ':' || c == '$' || c == '*';
+    }
+
+    std::string buffer_;    // 上次未解析完的数据（只保存不完整的尾部）
 };
@@ -2,7 +2,12 @@
 #include "ThreadPool.h"
 #include "CommandHandler.h"
 #include "DataStore.h"
+#include "MetricsExporter.h"
+#include "Watchdog.h"
+#include "ConfigRegistry.h"
+#include "TaskScheduler.h"
 #include <string>
+#include <vector>
 #include <memory>
 #include <atomic>
 #include <thread>
@@ -12,15 +17,57 @@ public:
     struct Config {
         int port = 6379;
         std::string host = "127.0.0.1";
+        std::string unixsocket;             // 非空时额外监听该 Unix 域套接字
+        uint32_t unixsocket_perm = 0700;
         size_t worker_threads = 32;
         size_t io_threads = 8;
+        size_t slow_threads = 2;
+        size_t slow_queue_limit = 1024;
+        size_t background_threads = 2;      // 后台任务调度器线程数（落盘、缓存调整、惰性释放等）
+        bool enable_admission = false;
+        uint32_t admission_target_ms = 5;
+        uint32_t admission_interval_ms = 100;
+        bool enable_busy_poll = false;
+        uint32_t busy_poll_window_us = 100;
+        uint32_t busy_poll_socket_us = 50;
+        std::string connection_steering = "least_loaded";   // least_loaded | incoming_cpu
         size_t shard_count = 16;
+        size_t bucket_per_shard = 16;
         size_t max_connections = 10000;
         size_t buffer_size = 32768;
+        size_t batch_size = 128;            // 管道中连续 SET 合并写入的最大条数
+        ClientLimits client_limits;         // 限速规则、输出缓冲区限制、客户端内存上限
         size_t cache_size_mb = 200;
+        std::string cache_policy = "lru";
+        bool enable_cache = true;
         bool enable_compression = false;
         bool enable_persistence = true;
         int sync_interval_sec = 300;
+        size_t lazyfree_threshold_kb = 64;
+        bool enable_hotkeys = true;
+        uint32_t hotkey_sample_rate = 16;
+        size_t hotkey_capacity = 64;
+        size_t near_cache_entries = 0;      // 每个线程近端缓存的热点键数（0 = 关闭）
+        std::string log_level = "info";
+        uint32_t log_rate_limit = 100;
+        bool enable_metrics = false;
+        int metrics_port = 9121;
+        uint32_t latency_monitor_threshold_ms = 100;
+        bool enable_watchdog = true;
+        uint32_t watchdog_threshold_ms = 100;
+        std::string capture_dir = "./traces";
+        bool enable_capture = false;
+        uint32_t capture_sample_rate = 1;
+        size_t capture_max_mb = 1024;
+        bool enable_shm = false;
+        std::string shm_path = "/tmp/simple_redis.shm.sock";
+        uint32_t shm_perm = 0700;
+        size_t shm_ring_kb = 1024;
+        size_t shm_arena_mb = 16;
+        std::vector<std::string> modules;   // 启动时加载的模块："路径 [参数...]"
+        std::string config_file;            // 加载的配置文件（CONFIG REWRITE 写回）
+        uint32_t auto_params = 0;           // 取值为 auto、启动时按硬件推导的参数（AutoTune::Param）
+        bool auto_calibrate = false;        // 推导时对候选值做短暂压测
     };
 
 public:
@@ -30,6 +77,9 @@ public:
     void run();
     void stop();
     
+    // 可在信号处理函数中调用：只置位停止标志，accept线程随即退出，run() 返回后再调用 stop() 清理
+    void request_stop() { running_ = false; }
+    
     // 统计信息
     struct Stats {
         uint64_t total_connections;
@@ -43,12 +93,21 @@ public:
 
 private:
     void accept_loop();
-    void print_stats_loop();
+    void accept_connection(int listen_fd, bool tcp);
+    void setup_unix_socket();
+    void shm_accept_loop();
+    void setup_shm_socket();
+    void print_stats();
     void setup_server_socket();
     void optimize_socket(int sockfd);
+    std::string render_metrics() const;
+    void setup_runtime_config();
     
     Config config_;
+    // 运行时配置（CONFIG GET/SET/REWRITE），参数绑定到 config_ 的字段
+    std::shared_ptr<ConfigRegistry> config_registry_;
     int server_fd_;
+    int unix_fd_ = -1;
     std::atomic<bool> running_{false};
     
     // 简化的组件
@@ -58,10 +117,21 @@ private:
     
     // 只有一个accept线程
     std::thread accept_thread_;
-    std::thread stats_thread_;
+    
+    // 共享内存传输的握手监听（Unix套接字）
+    int shm_fd_ = -1;
+    std::thread shm_accept_thread_;
+    TaskScheduler::TaskId stats_task_ = 0;  // 周期统计输出
+    
+    // 可选的Prometheus指标导出器（独立端口、独立线程）
+    std::unique_ptr<MetricsExporter> metrics_exporter_;
+    
+    // 事件循环卡顿看门狗
+    std::unique_ptr<Watchdog> watchdog_;
     
     // 统计信息
     std::atomic<uint64_t> total_connections_{0};
     std::atomic<uint64_t> current_connections_{0};
+    std::atomic<uint64_t> rejected_connections_{0};  // 过载时拒绝的连接
     std::chrono::steady_clock::time_point start_time_;
 };
@@ -0,0 +1,80 @@
+#pragma once
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * RESP 回复构造器：命令处理函数通过它把回复直接追加到连接的输出缓冲区
+ * 1. 数字用 std::to_chars 写入栈上缓冲区，不经过 std::to_string 的临时字符串；
+ * 2. OK、nil、0、1 等常见回复是预编码的常量，直接整段追加；
+ * 3. 输出缓冲区在连接上复用，容量稳定后 SET/GET/DEL 的回复路径不再分配内存。
+ * 不持有缓冲区，只在一次命令批处理期间使用。
+ */
+class ReplyBuilder {
+public:
+    // 预编码的常量回复
+    static constexpr std::string_view OK = "+OK\r\n";
+    static constexpr std::string_view NIL = "$-1\r\n";
+    static constexpr std::string_view ZERO = ":0\r\n";
+    static constexpr std::string_view ONE = ":1\r\n";
+    static constexpr std::string_view EMPTY_ARRAY = "*0\r\n";
+
+    explicit ReplyBuilder(std::string& out) : out_(out) {}
+
+    void ok() { out_ += OK; }
+    void nil() { out_ += NIL; }
+    void boolean(bool value) { out_ += value ? ONE : ZERO; }
+
+    // +<status>\r\n
+    void simple(std::string_view status) {
+        out_ += '+';
+        out_ += status;
+        out_ += "\r\n";
+    }
+
+    // -<message>\r\n，message 不含前缀 '-' 和结尾 CRLF，如 "ERR syntax error"
+    void error(std::string_view message) {
+        out_ += '-';
+        out_ += message;
+        out_ += "\r\n";
+    }
+
+    void integer(int64_t value) {
+        if (value == 0) {
+            out_ += ZERO;
+        } else if (value == 1) {
+            out_ += ONE;
+        } else {
+            prefixed_number(':', value);
+        }
+    }
+
+    void bulk(std::string_view value) {
+        out_.reserve(out_.size() + value.size() + 24);
+        prefixed_number('$', static_cast<int64_t>(value.size()));
+        out_ += value;
+        out_ += "\r\n";
+    }
+
+    void array(size_t count) {
+        prefixed_number('*', static_cast<int64_t>(count));
+    }
+
+    // 已编码好的完整 RESP 片段（模块回复、兼容旧接口的字符串回复）
+    void raw(std::string_view encoded) { out_ += encoded; }
+
+    size_t size() const { return out_.size(); }
+
+private:
+    void prefixed_number(char prefix, int64_t value) {
+        char buf[24];
+        buf[0] = prefix;
+        auto result = std::to_chars(buf + 1, buf + sizeof(buf) - 2, value);
+        result.ptr[0] = '\r';
+        result.ptr[1] = '\n';
+        out_.append(buf, result.ptr + 2 - buf);
+    }
+
+    std::string& out_;
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+// 缓存行大小
+#define CACHE_LINE_SIZE 64
+
+/**
+ * 单写者计数：只有一个线程写入、其他线程只读的统计值，用普通的读改写代替带锁前缀的原子加；
+ * 读取方仍能无锁看到完整的值（不会读到撕裂的数）。多个线程写同一计数时必须用 fetch_add 或 ShardedCounter。
+ */
+template <typename T>
+inline void single_writer_add(std::atomic<T>& counter, typename std::atomic<T>::value_type delta = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+/**
+ * 分片计数器
+ * 计数分散到按缓存行对齐的多个槽中，每个线程固定写自己的槽（线程数超过槽数时
+ * 多个线程共享一个槽，仍然正确，只是有少量竞争），避免所有核心争抢同一缓存行；
+ * 读取时汇总所有槽，适合写多读少的统计计数。
+ */
+class ShardedCounter {
+public:
+    ShardedCounter()
+        : mask_(slot_count() - 1)
+        , slots_(std::make_unique<Slot[]>(mask_ + 1)) {}
+
+    ShardedCounter(const ShardedCounter&) = delete;
+    ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+    void add(int64_t delta) {
+        slots_[thread_index() & mask_].value.fetch_add(delta, std::memory_order_relaxed);
+    }
+    void sub(int64_t delta) { add(-delta); }
+    void inc() { add(1); }
+    void dec() { add(-1); }
+
+    // 汇总所有槽（与并发写入之间不是原子快照）
+    int64_t sum() const {
+        int64_t total = 0;
+        for (size_t i = 0; i <= mask_; ++i) {
+            total += slots_[i].value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // 非负计数的便捷读取（并发增减时汇总值可能短暂为负）
+    size_t load() const {
+        int64_t total = sum();
+        return total > 0 ? static_cast<size_t>(total) : 0;
+    }
+
+    void reset() {
+        for (size_t i = 0; i <= mask_; ++i) {
+            slots_[i].value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<int64_t> value{0};
+    };
+
+    // 槽数：硬件线程数向上取2的幂，上限64
+    static size_t slot_count() {
+        static const size_t count = [] {
+            size_t hw = std::thread::hardware_concurrency();
+            size_t n = 1;
+            while (n < hw && n < 64) n <<= 1;
+            return n;
+        }();
+        return count;
+    }
+
+    // 线程首次使用时按顺序分配编号，所有计数器共用
+    static size_t thread_index() {
+        static std::atomic<size_t> next_index{0};
+        thread_local size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include "ShmTransport.h"
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * 共享内存传输客户端（simple_redis_shm_client 库）
+ * 通过 Unix 套接字握手拿到共享内存段与门铃后，请求与回复都经由共享内存通道传递，不再经过套接字。
+ * 回复为原始 RESP 文本；单个 ShmClient 只能由一个线程使用。
+ *
+ * 大值免拷贝发送：先用 reserve 在请求数据区预留空间并原地写入，再把指向该空间的 string_view
+ * 作为参数传给紧接着的 command/pipeline 调用，发送时不再复制（服务器分发前仍会复制一次，见 ShmTransport.h）。
+ */
+class ShmClient {
+public:
+    ShmClient() = default;
+    ~ShmClient();
+
+    ShmClient(const ShmClient&) = delete;
+    ShmClient& operator=(const ShmClient&) = delete;
+
+    bool connect(const std::string& path, std::string& error);
+    void close();
+    bool connected() const { return base_ != nullptr; }
+    // 服务器分配的连接ID（与 CLIENT LIST、流量抓取中的 id 一致）
+    uint64_t connection_id() const { return connection_id_; }
+
+    char* reserve(size_t len);
+
+    // 执行一条命令；reply 指向共享内存中的回复，在下一次调用之前有效
+    bool command(const std::vector<std::string_view>& args, std::string_view& reply);
+
+    // 流水线：发送全部命令并按顺序对每条回复调用 on_reply（回复视图只在回调内有效）
+    bool pipeline(const std::vector<std::vector<std::string_view>>& commands,
+                  const std::function<void(std::string_view)>& on_reply);
+
+    const std::string& last_error() const { return error_; }
+
+private:
+    bool run(const std::vector<std::vector<std::string_view>>& commands,
+             const std::function<void(std::string_view)>* on_reply, std::string_view* held_reply);
+    bool wait_doorbell();
+    void ring_server();
+    void release_held();
+
+    int control_fd_ = -1;
+    int server_doorbell_ = -1;
+    int client_doorbell_ = -1;
+    void* base_ = nullptr;
+    size_t size_ = 0;
+    int spin_limit_ = 0;
+    uint64_t connection_id_ = 0;
+
+    shm::Producer requests_;
+    shm::Consumer responses_;
+    shm::Consumer::Message message_;
+    bool holding_ = false;      // command 返回的回复尚未释放
+    std::string error_;
+};
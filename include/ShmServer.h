@@ -0,0 +1,74 @@
+#pragma once
+#include "ShmTransport.h"
+#include "ClientLimits.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * 共享内存传输的服务端会话
+ * 由 RedisServer 的共享内存监听线程在握手时创建（分配 memfd 共享段与两个 eventfd 门铃，
+ * 通过 SCM_RIGHTS 交给客户端），之后交给某个 Worker，由其事件循环监听服务器门铃与控制连接。
+ * 控制连接（Unix 套接字）握手后不再传输数据，只用于感知客户端退出。
+ */
+class ShmSession {
+public:
+    struct Options {
+        size_t frame_capacity;  // 每个方向的消息环字节数（向上取整为2的幂）
+        size_t arena_capacity;  // 每个方向的数据区字节数（向上取整为2的幂）
+
+        Options()
+            : frame_capacity(1024 * 1024)
+            , arena_capacity(16 * 1024 * 1024) {}
+    };
+
+    // 在已接受的控制连接上完成握手，id 为分配给该连接的连接ID（随握手告知客户端）；
+    // control_fd 的所有权转移给会话（失败时同样关闭），失败时抛出 std::runtime_error
+    static std::unique_ptr<ShmSession> accept(int control_fd, uint64_t id, const Options& options);
+    ~ShmSession();
+
+    ShmSession(const ShmSession&) = delete;
+    ShmSession& operator=(const ShmSession&) = delete;
+
+    int control_fd() const { return control_fd_; }
+    int doorbell_fd() const { return server_doorbell_; }
+
+    uint64_t id() const { return id_; }
+
+    shm::Consumer& requests() { return requests_; }
+
+    // 写入一条回复；响应通道已满时返回 false（已登记等待，客户端释放空间后会敲响服务器门铃），
+    // 客户端破坏了响应通道时同样返回 false，此时 broken() 为 true
+    bool send_response(const std::string& response);
+
+    // 客户端写入了越界或不一致的通道字段：会话必须关闭，不能再读写共享段
+    bool broken() const { return requests_.corrupted() || responses_.protocol_error(); }
+
+    void ring_client();
+    void clear_doorbell();
+
+    // 以下由所属 Worker 维护，含义与 TCP 连接的对应字段相同
+    std::string pending_response;  // 响应通道已满时暂存的回复
+    bool parked = false;           // 慢命令执行中：暂停读取请求，保证回复顺序
+    std::string addr;              // 握手套接字路径（unix:<path>），用于匹配限速规则
+    TokenBucket command_bucket;
+    TokenBucket byte_bucket;
+    bool throttled = false;        // 令牌透支：请求留在通道中，到 throttle_until_us 再继续
+    uint64_t throttle_until_us = 0;
+    std::atomic<size_t> memory{0}; // 已计入全局客户端内存的字节数（暂存回复），线程池统计占用时会读取
+
+private:
+    ShmSession() = default;
+
+    int control_fd_ = -1;
+    int memfd_ = -1;
+    int server_doorbell_ = -1;
+    int client_doorbell_ = -1;
+    void* base_ = nullptr;
+    size_t size_ = 0;
+    uint64_t id_ = 0;
+
+    shm::Consumer requests_;
+    shm::Producer responses_;
+};
@@ -0,0 +1,418 @@
+#pragma once
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+/**
+ * 同机共享内存传输（服务器与客户端库共用的内存布局与收发逻辑）
+ *
+ * 每个客户端独占一块 memfd 共享内存段，包含两个方向的通道：
+ *   请求通道：客户端生产、服务器消费；响应通道：服务器生产、客户端消费。
+ * 每个通道由两段单生产者单消费者的环形空间组成：
+ *   - 消息环：存放消息帧，小片段直接内联在帧中；
+ *   - 数据区：大片段按偏移引用，调用方可先 reserve 再原地写入，发送时不再拷贝。
+ * 两段空间的位置都是单调递增的64位计数，消费者按顺序释放。
+ *
+ * 限制：传输本身不拷贝，但服务器端的命令处理仍以 std::string 为参数和结果——
+ * 请求参数在分发前复制出共享段，回复先在堆上生成再写入响应通道（大回复写入数据区时再复制一次）。
+ * 因此省下的是套接字的系统调用与内核拷贝，大值依旧按值大小付出两次内存拷贝。
+ *
+ * 唤醒：消费者睡眠前置位 consumer_waiting 并复查，生产者发布后发现该标志才写 eventfd 门铃，
+ * 双方都忙碌时不进入内核；生产者因空间不足等待时置位 producer_waiting，由消费者释放空间后唤醒。
+ * 每端只有一个门铃：服务器的门铃表示“有新请求或响应空间已释放”，客户端的门铃反之。
+ *
+ * 消息帧（8字节对齐）：
+ *   size u32 | count u32 | arena_end u64 | count × (len u32 | where u32 | 内联字节补齐到8 或 数据区偏移 u64)
+ * count 为 PADDING 的帧只用于跳过消息环末尾放不下的空间。
+ *
+ * 共享段对端可写：对端写入的位置与帧字段一律视为不可信，越界或不一致时
+ * 消费端置 corrupted()、生产端置 protocol_error()，调用方应立即关闭会话。
+ */
+namespace shm {
+
+constexpr uint32_t MAGIC = 0x4d525253;      // "SRRM"
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t PADDING = 0xffffffffu;
+constexpr size_t INLINE_LIMIT = 4096;       // 超过该大小的片段放入数据区
+constexpr uint32_t WHERE_INLINE = 0;
+constexpr uint32_t WHERE_ARENA = 1;
+constexpr size_t CACHE_LINE = 64;           // 两端各自写入的字段分属不同缓存行
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory atomics must be lock-free");
+
+inline constexpr uint64_t align8(uint64_t v) { return (v + 7) & ~uint64_t(7); }
+
+struct ChannelState {
+    alignas(CACHE_LINE) std::atomic<uint64_t> frame_head{0};       // 生产者写
+    alignas(CACHE_LINE) std::atomic<uint64_t> frame_tail{0};       // 消费者写
+    std::atomic<uint64_t> arena_tail{0};
+    alignas(CACHE_LINE) std::atomic<uint32_t> consumer_waiting{0};
+    alignas(CACHE_LINE) std::atomic<uint32_t> producer_waiting{0};
+};
+
+struct SegmentHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t frame_capacity;    // 2的幂
+    uint64_t arena_capacity;    // 2的幂
+    ChannelState request;
+    ChannelState response;
+};
+
+// 段内布局：头部 | 请求消息环 | 请求数据区 | 响应消息环 | 响应数据区
+struct Layout {
+    uint64_t frame_capacity = 0;
+    uint64_t arena_capacity = 0;
+
+    uint64_t header_size() const { return (sizeof(SegmentHeader) + CACHE_LINE - 1) & ~uint64_t(CACHE_LINE - 1); }
+    uint64_t request_frames() const { return header_size(); }
+    uint64_t request_arena() const { return request_frames() + frame_capacity; }
+    uint64_t response_frames() const { return request_arena() + arena_capacity; }
+    uint64_t response_arena() const { return response_frames() + frame_capacity; }
+    uint64_t total_size() const { return response_arena() + arena_capacity; }
+};
+
+// 握手：服务器通过 Unix 套接字发送本结构，并以 SCM_RIGHTS 附带 [memfd, 服务器门铃, 客户端门铃]
+struct Handshake {
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint64_t frame_capacity = 0;
+    uint64_t arena_capacity = 0;
+    uint64_t connection_id = 0;
+};
+
+constexpr int HANDSHAKE_FDS = 3;
+
+inline bool send_with_fds(int sock, const void* data, size_t len, const int* fds, int nfds) {
+    iovec iov{const_cast<void*>(data), len};
+    char control[CMSG_SPACE(sizeof(int) * HANDSHAKE_FDS)] = {};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+    std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+    return sendmsg(sock, &msg, MSG_NOSIGNAL) == static_cast<ssize_t>(len);
+}
+
+// 接收数据与描述符；返回收到的描述符数量，失败返回 -1
+inline int recv_with_fds(int sock, void* data, size_t len, int* fds, int max_fds) {
+    iovec iov{data, len};
+    char control[CMSG_SPACE(sizeof(int) * HANDSHAKE_FDS)] = {};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) != static_cast<ssize_t>(len)) return -1;
+    int received = 0;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            int n = static_cast<int>((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+            for (int i = 0; i < n; ++i) {
+                int fd;
+                std::memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+                if (received < max_fds) fds[received++] = fd;
+            }
+        }
+    }
+    return received;
+}
+
+/**
+ * 通道生产端
+ */
+class Producer {
+public:
+    void attach(ChannelState* state, char* frames, uint64_t frame_capacity, char* arena, uint64_t arena_capacity) {
+        state_ = state;
+        frames_ = frames;
+        frame_mask_ = frame_capacity - 1;
+        arena_ = arena;
+        arena_mask_ = arena_capacity - 1;
+        frame_head_ = state->frame_head.load(std::memory_order_relaxed);
+        arena_head_ = state->arena_tail.load(std::memory_order_relaxed);
+    }
+
+    uint64_t arena_capacity() const { return arena_mask_ + 1; }
+
+    // 在数据区预留 len 字节供调用方原地写入，随后把指向它的片段交给 send 即按偏移引用；
+    // 预留的空间必须随紧接着发送的那条消息一起发出；空间不足返回 nullptr
+    char* reserve(size_t len) {
+        uint64_t pos;
+        if (!allocate(len, pos)) return nullptr;
+        return arena_ + (pos & arena_mask_);
+    }
+
+    // 发送一条由若干片段组成的消息；空间不足返回 false 且不产生任何效果，
+    // 此时若 oversized() 为 true 表示该消息永远放不下，不应再等待重试；
+    // protocol_error() 为 true 表示对端写入的释放位置非法
+    bool send(const std::string_view* parts, size_t count) {
+        if (protocol_error_) return false;
+        uint64_t saved_arena_head = arena_head_;
+        oversized_ = false;
+        uint64_t frame_size = 16;
+        scratch_.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            const auto& part = parts[i];
+            auto& placement = scratch_[i];
+            placement = Placement{};
+            if (in_arena(part)) {
+                placement.where = WHERE_ARENA;
+                placement.offset = static_cast<uint64_t>(part.data() - arena_);
+            } else if (part.size() > INLINE_LIMIT) {
+                uint64_t pos;
+                if (!allocate(part.size(), pos)) {
+                    oversized_ = !protocol_error_ && align8(part.size()) > (arena_mask_ + 1) / 2;
+                    arena_head_ = saved_arena_head;
+                    return false;
+                }
+                placement.where = WHERE_ARENA;
+                placement.offset = pos & arena_mask_;
+                placement.copy = true;
+            } else {
+                placement.where = WHERE_INLINE;
+            }
+            frame_size += 8 + (placement.where == WHERE_INLINE ? align8(part.size()) : 8);
+        }
+
+        uint64_t capacity = frame_mask_ + 1;
+        uint64_t tail = state_->frame_tail.load(std::memory_order_acquire);
+        if (!valid_tail(tail, frame_head_, capacity)) {
+            arena_head_ = saved_arena_head;
+            return false;
+        }
+        uint64_t offset = frame_head_ & frame_mask_;
+        uint64_t padding = offset + frame_size > capacity ? capacity - offset : 0;
+        if (padding + frame_size > capacity - (frame_head_ - tail)) {
+            oversized_ = frame_size > capacity / 2;
+            arena_head_ = saved_arena_head;
+            return false;
+        }
+
+        if (padding > 0) {
+            write_u32(offset, static_cast<uint32_t>(padding));
+            write_u32(offset + 4, PADDING);
+            frame_head_ += padding;
+            offset = 0;
+        }
+
+        write_u32(offset, static_cast<uint32_t>(frame_size));
+        write_u32(offset + 4, static_cast<uint32_t>(count));
+        write_u64(offset + 8, arena_head_);
+        uint64_t p = offset + 16;
+        for (size_t i = 0; i < count; ++i) {
+            const auto& part = parts[i];
+            const auto& placement = scratch_[i];
+            write_u32(p, static_cast<uint32_t>(part.size()));
+            write_u32(p + 4, placement.where);
+            p += 8;
+            if (placement.where == WHERE_INLINE) {
+                std::memcpy(frames_ + p, part.data(), part.size());
+                p += align8(part.size());
+            } else {
+                if (placement.copy) std::memcpy(arena_ + placement.offset, part.data(), part.size());
+                write_u64(p, placement.offset);
+                p += 8;
+            }
+        }
+        frame_head_ += frame_size;
+        state_->frame_head.store(frame_head_, std::memory_order_release);
+        return true;
+    }
+
+    bool send(const std::vector<std::string_view>& parts) { return send(parts.data(), parts.size()); }
+
+    bool oversized() const { return oversized_; }
+    bool protocol_error() const { return protocol_error_; }
+
+    // 发布后调用：消费者正在睡眠时返回 true，调用方需敲响对方门铃
+    bool consumer_needs_wakeup() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return state_->consumer_waiting.load(std::memory_order_relaxed) != 0 &&
+               state_->consumer_waiting.exchange(0) != 0;
+    }
+
+    // 空间不足准备等待：置位标志，调用方随后应重试一次发送再睡眠
+    void mark_waiting() {
+        state_->producer_waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+private:
+    struct Placement {
+        uint32_t where = WHERE_INLINE;
+        uint64_t offset = 0;
+        bool copy = false;
+    };
+
+    bool in_arena(std::string_view part) const {
+        return part.size() > 0 && part.data() >= arena_ && part.data() + part.size() <= arena_ + arena_mask_ + 1;
+    }
+
+    // 在数据区分配连续空间，放不下时跳过末尾剩余部分
+    bool allocate(size_t len, uint64_t& pos) {
+        uint64_t capacity = arena_mask_ + 1;
+        uint64_t size = align8(len);
+        uint64_t offset = arena_head_ & arena_mask_;
+        uint64_t skip = offset + size > capacity ? capacity - offset : 0;
+        uint64_t tail = state_->arena_tail.load(std::memory_order_acquire);
+        if (!valid_tail(tail, arena_head_, capacity)) return false;
+        if (skip + size > capacity - (arena_head_ - tail)) return false;
+        pos = arena_head_ + skip;
+        arena_head_ = pos + size;
+        return true;
+    }
+
+    // 消费者释放的位置不能超过已发布的位置，也不能落后超过一圈
+    bool valid_tail(uint64_t tail, uint64_t head, uint64_t capacity) {
+        if (tail <= head && head - tail <= capacity) return true;
+        protocol_error_ = true;
+        return false;
+    }
+
+    void write_u32(uint64_t offset, uint32_t v) { std::memcpy(frames_ + offset, &v, 4); }
+    void write_u64(uint64_t offset, uint64_t v) { std::memcpy(frames_ + offset, &v, 8); }
+
+    ChannelState* state_ = nullptr;
+    char* frames_ = nullptr;
+    uint64_t frame_mask_ = 0;
+    char* arena_ = nullptr;
+    uint64_t arena_mask_ = 0;
+    uint64_t frame_head_ = 0;
+    uint64_t arena_head_ = 0;
+    bool oversized_ = false;
+    bool protocol_error_ = false;
+    std::vector<Placement> scratch_;
+};
+
+/**
+ * 通道消费端：peek 得到的片段直接指向共享内存，release 之前一直有效
+ */
+class Consumer {
+public:
+    struct Message {
+        std::vector<std::string_view> parts;
+        uint64_t frame_end = 0;
+        uint64_t arena_end = 0;
+    };
+
+    void attach(ChannelState* state, const char* frames, uint64_t frame_capacity,
+                const char* arena, uint64_t arena_capacity) {
+        state_ = state;
+        frames_ = frames;
+        frame_mask_ = frame_capacity - 1;
+        arena_ = arena;
+        arena_capacity_ = arena_capacity;
+        read_pos_ = state->frame_tail.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const { return read_pos_ == state_->frame_head.load(std::memory_order_acquire); }
+
+    // 读取下一条消息；没有消息时返回 false，对端写入的帧损坏时同样返回 false 并置 corrupted()
+    bool peek(Message& message) {
+        if (corrupted_) return false;
+        uint64_t capacity = frame_mask_ + 1;
+        while (true) {
+            uint64_t head = state_->frame_head.load(std::memory_order_acquire);
+            if (read_pos_ == head) return false;
+            // 已发布的数据不会超过一圈（也覆盖了 head 回退的情况）
+            if (head - read_pos_ > capacity) return fail();
+            uint64_t offset = read_pos_ & frame_mask_;
+            uint32_t size = read_u32(offset);
+            uint32_t count = read_u32(offset + 4);
+            // 帧必须 8 字节对齐、落在已发布范围内，且不跨越消息环末尾
+            if (size < 8 || (size & 7) != 0 || size > head - read_pos_ || offset + size > capacity) return fail();
+            if (count == PADDING) {
+                read_pos_ += size;
+                continue;
+            }
+            if (size < 16) return fail();
+
+            message.parts.clear();
+            message.arena_end = read_u64(offset + 8);
+            uint64_t p = offset + 16;
+            uint64_t end = offset + size;
+            for (uint32_t i = 0; i < count; ++i) {
+                if (p + 8 > end) return fail();
+                uint32_t len = read_u32(p);
+                uint32_t where = read_u32(p + 4);
+                p += 8;
+                if (where == WHERE_INLINE) {
+                    if (len > end - p) return fail();
+                    message.parts.emplace_back(frames_ + p, len);
+                    p += align8(len);
+                } else if (where == WHERE_ARENA) {
+                    if (p + 8 > end) return fail();
+                    uint64_t arena_offset = read_u64(p);
+                    if (arena_offset > arena_capacity_ || len > arena_capacity_ - arena_offset) return fail();
+                    message.parts.emplace_back(arena_ + arena_offset, len);
+                    p += 8;
+                } else {
+                    return fail();
+                }
+            }
+            read_pos_ += size;
+            message.frame_end = read_pos_;
+            return true;
+        }
+    }
+
+    bool corrupted() const { return corrupted_; }
+
+    // 释放消息占用的空间（须按 peek 的顺序）；生产者在等待空间时返回 true，调用方需敲响对方门铃
+    bool release(const Message& message) {
+        state_->arena_tail.store(message.arena_end, std::memory_order_release);
+        state_->frame_tail.store(message.frame_end, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return state_->producer_waiting.load(std::memory_order_relaxed) != 0 &&
+               state_->producer_waiting.exchange(0) != 0;
+    }
+
+    // 准备睡眠：置位等待标志后复查；返回 false 表示期间有新消息到达，不应睡眠
+    bool prepare_wait() {
+        state_->consumer_waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!empty()) {
+            state_->consumer_waiting.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool fail() {
+        corrupted_ = true;
+        return false;
+    }
+
+    uint32_t read_u32(uint64_t offset) const {
+        uint32_t v;
+        std::memcpy(&v, frames_ + offset, 4);
+        return v;
+    }
+
+    uint64_t read_u64(uint64_t offset) const {
+        uint64_t v;
+        std::memcpy(&v, frames_ + offset, 8);
+        return v;
+    }
+
+    ChannelState* state_ = nullptr;
+    const char* frames_ = nullptr;
+    uint64_t frame_mask_ = 0;
+    const char* arena_ = nullptr;
+    uint64_t arena_capacity_ = 0;
+    uint64_t read_pos_ = 0;
+    bool corrupted_ = false;
+};
+
+} // namespace shm
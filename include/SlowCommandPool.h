@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * 慢命令执行池
+ * Worker 把标记为慢命令的请求（KEYS、大批量 MGET、同步 FLUSHALL 等）交给这里的少量线程执行，
+ * 发起请求的连接暂停处理后续命令，事件循环继续服务其他连接；结果由任务自行投递回所属 Worker。
+ * 队列有上限：队列已满时 submit 返回 false，调用方改为就地执行，压力不会无限堆积。
+ */
+class SlowCommandPool {
+public:
+    struct Options {
+        size_t threads;         // 执行线程数
+        size_t queue_limit;     // 排队任务上限
+
+        Options()
+            : threads(2)
+            , queue_limit(1024) {}
+    };
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t completed = 0;
+        uint64_t rejected = 0;  // 队列已满而被拒绝（由 Worker 就地执行）
+        size_t queued = 0;
+    };
+
+    explicit SlowCommandPool(const Options& options = Options{});
+    ~SlowCommandPool();
+
+    SlowCommandPool(const SlowCommandPool&) = delete;
+    SlowCommandPool& operator=(const SlowCommandPool&) = delete;
+
+    void start();
+    // 停止前执行完已排队的任务
+    void stop();
+
+    bool submit(std::function<void()> task);
+
+    Stats stats() const;
+
+private:
+    void run();
+
+    Options options_;
+    std::vector<std::thread> threads_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> queue_;
+    bool stopping_ = false;
+
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> rejected_{0};
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 进程级后台任务调度器
+ * 落盘、缓存容量调整、统计输出、惰性释放等后台工作共用少量线程，不再各自占一个睡眠循环的线程：
+ * 1. 每个线程有按优先级划分的就绪队列，空闲时从其他线程队列尾部窃取任务；
+ * 2. 定时与周期任务由计时表驱动，周期任务在上一次执行结束后按周期重新计时；
+ * 3. 周期任务可设 CPU 预算（平均占用单核的比例），某次执行耗时过长时相应推迟下一次执行；
+ * 4. 线程可绑定到 Worker 之外的 CPU，避免后台工作抢占事件循环。
+ * 未调用 start() 时第一次提交任务会以默认参数启动（嵌入式使用）；stop() 之后提交的任务不再执行。
+ */
+class TaskScheduler {
+public:
+    enum class Priority : uint8_t { HIGH = 0, NORMAL = 1, LOW = 2 };
+    static constexpr size_t PRIORITY_LEVELS = 3;
+
+    using Task = std::function<void()>;
+    using TaskId = uint64_t;  // 0 表示无效
+
+    struct Options {
+        size_t threads;
+
+        Options()
+            : threads(2) {}
+    };
+
+    struct TaskOptions {
+        std::string name;
+        Priority priority;
+        std::chrono::milliseconds delay;    // 首次执行前的延迟
+        std::chrono::milliseconds period;   // 0 = 一次性任务
+        double cpu_budget;                  // 周期任务平均占用单核的比例上限（0 = 不限）
+
+        TaskOptions()
+            : name("task")
+            , priority(Priority::NORMAL)
+            , delay(0)
+            , period(0)
+            , cpu_budget(0) {}
+    };
+
+    struct Stats {
+        size_t threads = 0;
+        size_t tasks = 0;               // 已登记（等待、排队或执行中）的任务数
+        uint64_t executed = 0;          // 累计执行次数
+        uint64_t stolen = 0;            // 从其他线程队列窃取执行的次数
+        uint64_t throttled = 0;         // 因超出 CPU 预算被推迟的次数
+        double cpu_seconds = 0;         // 任务累计消耗的 CPU 时间
+    };
+
+    static TaskScheduler& instance();
+
+    void start(const Options& options = Options{});
+    // 停止并等待线程退出，未执行的任务被丢弃
+    void stop();
+
+    TaskId schedule(Task task, const TaskOptions& options = TaskOptions{});
+    // 取消任务：任务正在其他线程执行时等待其结束，返回后任务不会再开始执行。
+    // 可以在任务自身中调用（不等待）
+    bool cancel(TaskId id);
+    // 修改周期任务的周期，从上一次执行结束（或登记）时起按新周期重新计时
+    bool set_period(TaskId id, std::chrono::milliseconds period);
+
+    // 把调度线程绑定到这组 CPU（空 = 不绑定），之后启动的线程同样生效
+    void set_cpu_affinity(const std::vector<int>& cpus);
+
+    Stats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        TaskId id = 0;
+        std::string name;
+        Priority priority = Priority::NORMAL;
+        std::chrono::milliseconds period{0};
+        double cpu_budget = 0;
+        Task task;
+        // 以下受 mutex_ 保护
+        Clock::time_point last_finish;
+        std::multimap<Clock::time_point, TaskId>::iterator timer;
+        bool armed = false;             // 在计时表中
+        bool queued = false;            // 在某个就绪队列中
+        bool running = false;
+        bool cancelled = false;
+        std::thread::id runner;
+    };
+
+    struct alignas(64) Worker {
+        std::mutex mutex;
+        std::array<std::deque<std::shared_ptr<Job>>, PRIORITY_LEVELS> ready;
+        std::thread thread;
+    };
+
+    TaskScheduler() = default;
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    void worker_loop(size_t index);
+    std::shared_ptr<Job> pop_local(size_t index);
+    std::shared_ptr<Job> steal(size_t index);
+    void run_job(const std::shared_ptr<Job>& job);
+    // 以下要求持有 mutex_
+    void arm(const std::shared_ptr<Job>& job, Clock::time_point due);
+    void disarm(Job& job);
+    void enqueue(const std::shared_ptr<Job>& job);
+    bool release_due_timers(Clock::time_point now);
+    void bind_threads();
+
+    enum class State { IDLE, RUNNING, STOPPED };
+
+    std::mutex lifecycle_mutex_;        // start / stop 串行化
+    std::atomic<State> state_{State::IDLE};
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<int> cpus_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;        // 有任务就绪或计时表变化
+    std::condition_variable done_cv_;   // 任务执行结束（cancel 等待）
+    std::unordered_map<TaskId, std::shared_ptr<Job>> jobs_;
+    std::multimap<Clock::time_point, TaskId> timers_;
+    size_t queued_ = 0;                 // 各就绪队列中的任务总数
+    size_t next_worker_ = 0;            // 外部线程提交时轮流放入各线程队列
+    TaskId next_id_ = 1;
+
+    std::atomic<uint64_t> executed_{0};
+    std::atomic<uint64_t> stolen_{0};
+    std::atomic<uint64_t> throttled_{0};
+    std::atomic<uint64_t> cpu_ns_{0};
+};
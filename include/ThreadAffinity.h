@@ -10,9 +10,10 @@
 
 #include <thread>
 #include <vector>
-#include <iostream>
 #include <algorithm>
 #include <string>
+#include <fstream>
+#include "Logger.h"
 
 /**
  * 线程亲和性管理类
@@ -40,16 +41,14 @@ public:
         
         int result = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
         if (result != 0) {
-            std::cerr << "Failed to set thread affinity to CPU " << cpu_id 
-                      << ": " << strerror(result) << std::endl;
+            LOG_ERROR("Failed to set thread affinity to CPU %d: %s", cpu_id, strerror(result));
             return false;
         }
         
-        std::cout << "Thread " << std::this_thread::get_id() 
-                  << " bound to CPU " << cpu_id << std::endl;
+        LOG_DEBUG("Thread %lu bound to CPU %d", static_cast<unsigned long>(pthread_self()), cpu_id);
         return true;
 #else
-        std::cout << "Thread affinity not supported on this platform" << std::endl;
+        LOG_WARN("Thread affinity not supported on this platform");
         return false;
 #endif
     }
@@ -68,16 +67,14 @@ public:
         
         int result = pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuset);
         if (result != 0) {
-            std::cerr << "Failed to set thread affinity to CPU " << cpu_id 
-                      << ": " << strerror(result) << std::endl;
+            LOG_ERROR("Failed to set thread affinity to CPU %d: %s", cpu_id, strerror(result));
             return false;
         }
         
-        std::cout << "Thread " << thread.get_id() 
-                  << " bound to CPU " << cpu_id << std::endl;
+        LOG_DEBUG("Thread %lu bound to CPU %d", static_cast<unsigned long>(thread.native_handle()), cpu_id);
         return true;
 #else
-        std::cout << "Thread affinity not supported on this platform" << std::endl;
+        LOG_WARN("Thread affinity not supported on this platform");
         return false;
 #endif
     }
@@ -148,7 +145,7 @@ public:
         
         int result = pthread_setschedparam(pthread_self(), policy, &param);
         if (result != 0) {
-            std::cerr << "Failed to set thread scheduling: " << strerror(result) << std::endl;
+            LOG_ERROR("Failed to set thread scheduling: %s", strerror(result));
             return false;
         }
         
@@ -158,18 +155,64 @@ public:
 #endif
     }
     
+    /**
+     * 与指定CPU同一物理核心的SMT兄弟线程（含自身；无法读取拓扑时为空）
+     */
+    static std::vector<int> smt_siblings(int cpu_id) {
+        return read_cpu_list("/sys/devices/system/cpu/cpu" + std::to_string(cpu_id) +
+                             "/topology/thread_siblings_list");
+    }
+    
+    /**
+     * 与指定CPU共享末级缓存（L3）的CPU（含自身；无法读取拓扑时为空）
+     */
+    static std::vector<int> llc_siblings(int cpu_id) {
+        return read_cpu_list("/sys/devices/system/cpu/cpu" + std::to_string(cpu_id) +
+                             "/cache/index3/shared_cpu_list");
+    }
+    
+    /**
+     * 读取 sysfs 中的CPU列表（如 "0-3,8,10-11"）
+     */
+    static std::vector<int> read_cpu_list(const std::string& path) {
+        std::vector<int> cpus;
+        std::ifstream file(path);
+        std::string text;
+        if (!file || !std::getline(file, text)) {
+            return cpus;
+        }
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t end = text.find(',', pos);
+            if (end == std::string::npos) end = text.size();
+            std::string range = text.substr(pos, end - pos);
+            size_t dash = range.find('-');
+            try {
+                int first = std::stoi(range.substr(0, dash));
+                int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu) {
+                    cpus.push_back(cpu);
+                }
+            } catch (const std::exception&) {
+                return {};
+            }
+            pos = end + 1;
+        }
+        return cpus;
+    }
+    
     /**
      * 打印系统CPU拓扑信息
      */
     static void print_system_info() {
-        std::cout << "=== System CPU Information ===" << std::endl;
-        std::cout << "CPU Count: " << get_cpu_count() << std::endl;
+        LOG_INFO("=== System CPU Information ===");
+        LOG_INFO("CPU Count: %u", get_cpu_count());
         
         auto current_affinity = get_current_thread_affinity();
-        std::cout << "Current Thread CPU Affinity: ";
+        std::string cpus;
         for (int cpu : current_affinity) {
-            std::cout << cpu << " ";
+            cpus += std::to_string(cpu) + " ";
         }
-        std::cout << std::endl;
+        LOG_INFO("Current Thread CPU Affinity: %s", cpus.c_str());
     }
 };
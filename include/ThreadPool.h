@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <array>
 #include <thread>
 #include <atomic>
 #include <memory>
@@ -9,20 +10,56 @@
 #include "RESPParser.h"
 #include "CommandHandler.h"
 #include "ThreadAffinity.h"
+#include "Watchdog.h"
+#include "ShmServer.h"
+#include "SlowCommandPool.h"
+#include "AdmissionControl.h"
+#include "BusyPoll.h"
+#include "ClientLimits.h"
+#include "ConfigRegistry.h"
+#include "TaskScheduler.h"
 
 // 统一分片常量
 constexpr size_t OPTIMAL_SHARD_COUNT = 16;
 
+class ThreadPool;
+
 class WorkerThread {
 public:
-    WorkerThread(int worker_id, std::shared_ptr<CommandHandler> handler, int cpu_id = -1);
+    WorkerThread(int worker_id, std::shared_ptr<CommandHandler> handler, int cpu_id = -1,
+                 const AdmissionControl::Options& admission = AdmissionControl::Options{},
+                 const ClientLimits& limits = ClientLimits{},
+                 const BusyPoll::Options& busy_poll = BusyPoll::Options{});
     ~WorkerThread();
     
     void start();
     void stop();
-    void add_client(int client_fd);
+    void add_client(int client_fd, bool tcp = true);
     void remove_client(int client_fd);
     
+    // 共享内存会话（与TCP连接一样计入连接数）
+    void add_shm_session(std::unique_ptr<ShmSession> session);
+    
+    // 慢命令线程池（为空时慢命令也在事件循环中就地执行），须在 start 之前设置
+    void set_slow_pool(SlowCommandPool* pool) { slow_pool_ = pool; }
+    // 由慢命令线程调用：投递执行结果并唤醒本 Worker 的事件循环
+    void post_completion(int client_fd, uint64_t client_id, std::string response);
+    
+    // 所属线程池（CLIENT LIST 汇总所有Worker的连接），须在 start 之前设置
+    void set_pool(ThreadPool* pool) { pool_ = pool; }
+    // 追加本Worker所有连接的描述（CLIENT LIST 格式），可从任意线程调用
+    void describe_clients(std::string& out);
+    
+    // 客户端内存逐出：线程池汇总所有Worker的占用，选出全局最大的连接后交给所属Worker关闭
+    struct MemoryUsage {
+        size_t memory;
+        int fd;          // 共享内存会话为门铃描述符
+        uint64_t id;     // 连接ID，防止描述符被复用后误关闭
+        size_t worker;
+    };
+    void collect_memory_usage(size_t worker, std::vector<MemoryUsage>& out);
+    void request_eviction(const MemoryUsage& usage, size_t limit);
+    
     // 线程亲和性相关
     void set_cpu_affinity(int cpu_id);
     int get_cpu_affinity() const { return cpu_id_; }
@@ -31,12 +68,55 @@ public:
     // 统计信息
     size_t get_client_count() const { return client_count_.load(); }
     uint64_t get_processed_commands() const { return processed_commands_.load(); }
+    
+    // 事件循环心跳（供看门狗检测卡顿）
+    LoopHeartbeat* get_heartbeat() { return &heartbeat_; }
+    
+    // 准入控制状态
+    bool is_overloaded() const { return admission_.overloaded(); }
+    uint64_t get_shed_commands() const { return admission_.shed_count(); }
+    
+    // 忙轮询统计（自旋/阻塞唤醒次数与自旋耗时）
+    BusyPoll::Stats get_busy_poll_stats() const { return busy_poll_.stats(); }
 
 private:
+    struct ClientInfo;
+    struct Completion;
+    
     void worker_loop();
     void handle_client_event(int client_fd, uint32_t events);
+    ClientInfo* find_client(int client_fd);
     void process_client_data(int client_fd);
-    void send_response(int client_fd, const std::string& response);
+    void process_client_data(int client_fd, ClientInfo& client);
+    bool execute_commands(int client_fd, ClientInfo& client,
+                          std::vector<std::vector<std::string>>& commands, size_t begin);
+    bool should_shed(const std::vector<std::string>& cmd);
+    bool offload(int client_fd, uint64_t client_id, const std::vector<std::string>& cmd);
+    void handle_completions();
+    void handle_client_command(int client_fd, ClientInfo& client, const std::vector<std::string>& cmd,
+                               ReplyBuilder& reply);
+    void describe_client(const ClientInfo& client, int client_fd, std::string& out);
+    void apply_rate_rule(ClientInfo& client, const ClientLimits& limits);
+    void apply_rate_rule(ShmSession& session, const ClientLimits& limits);
+    void refresh_limits();
+    void throttle(int client_fd, ClientInfo& client, uint64_t wait_us);
+    bool throttle_if_needed(int client_fd, ClientInfo& client);
+    void resume_throttled();
+    void resume_throttled_shm(int fd, uint64_t id, uint64_t now);
+    
+    // 输出：先直接发送，发不完的部分留在连接的输出缓冲区，等 EPOLLOUT 再发；
+    // 超过输出缓冲区限制时断开连接并返回 false
+    bool send_response(int client_fd, ClientInfo& client, const std::string& response);
+    bool flush_output(int client_fd, ClientInfo& client);
+    void update_client_memory(ClientInfo& client);
+    void update_client_memory(ShmSession& session);
+    void handle_evictions();
+    std::shared_ptr<ShmSession> find_shm_session(int fd);
+    void handle_shm_event(int fd);
+    void process_shm_requests(const std::shared_ptr<ShmSession>& shared);
+    void complete_shm_request(Completion& completion);
+    void throttle(ShmSession& session, uint64_t wait_us);
+    void remove_shm_session(const std::shared_ptr<ShmSession>& session);
     
     int worker_id_;
     int cpu_id_;  // CPU亲和性绑定的核心ID (-1表示未绑定)
@@ -49,24 +129,82 @@ private:
     // 客户端管理
     struct ClientInfo {
         std::vector<char> read_buffer;
-        std::vector<char> write_buffer;
+        std::string write_buffer;     // 输出缓冲区：命令回复直接写入，从 write_pos 开始尚未发出
         size_t read_pos = 0;
         size_t write_pos = 0;
         RESPParser parser;
-        std::chrono::steady_clock::time_point last_active;
+        uint32_t last_active_ms = 0;  // 粗粒度时钟的相对毫秒数
+        uint32_t created_ms = 0;
+        uint64_t id = 0;              // 连接ID（进程内唯一，用于流量抓取）
+        bool parked = false;          // 慢命令执行中：暂停读取与执行，保证回复顺序
+        std::vector<std::vector<std::string>> parked_commands;  // 慢命令之后或限速时已解析、尚未执行的命令
+        
+        // 名称与来源地址只在持有 clients_mutex_ 时写入（CLIENT LIST 会从其他线程读取）
+        std::string name;
+        std::string addr;
         
-        ClientInfo() : read_buffer(8192), write_buffer(8192) {}
+        // 限速：令牌透支后暂停读取，到 throttle_until_us 再继续
+        TokenBucket command_bucket;
+        TokenBucket byte_bucket;
+        bool throttled = false;
+        uint64_t throttle_until_us = 0;
+        
+        uint32_t soft_limit_since_ms = 0;   // 输出缓冲区开始超过软限制的时间（0 = 未超过）
+        std::atomic<size_t> memory{0};      // 已计入全局客户端内存的字节数
+        
+        ClientInfo() : read_buffer(8192) {}
     };
     
     std::unordered_map<int, std::unique_ptr<ClientInfo>> clients_;
+    // 解析结果与回收的命令数组（本线程复用，稳定状态下解析不分配）
+    RESPParser::CommandList batch_;
+    RESPParser::CommandList spare_commands_;
+    // 共享内存会话：门铃与控制连接两个描述符都映射到同一会话
+    std::unordered_map<int, std::shared_ptr<ShmSession>> shm_sessions_;
     std::mutex clients_mutex_;
-    std::atomic<size_t> client_count_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> client_count_{0};  // accept线程与本线程都会写
     
     // 命令处理器
     std::shared_ptr<CommandHandler> handler_;
     
-    // 统计
-    std::atomic<uint64_t> processed_commands_{0};
+    // 客户端限制与限速中的连接（描述符与连接ID，防止描述符被复用后误恢复；共享内存会话为门铃描述符）；
+    // limits_ 只在本线程读写，线程池发布新快照后在下一轮事件循环开始时更新
+    ClientLimits limits_;
+    uint64_t limits_version_ = 0;
+    std::vector<std::pair<int, uint64_t>> throttled_;
+    ThreadPool* pool_ = nullptr;
+    
+    // 慢命令卸载：结果经 completion_fd_（eventfd）通知本线程；
+    // 共享内存会话以门铃描述符代替连接描述符
+    struct Completion {
+        int client_fd;
+        uint64_t client_id;
+        std::string response;
+    };
+    SlowCommandPool* slow_pool_ = nullptr;
+    int completion_fd_ = -1;
+    std::mutex completion_mutex_;
+    std::vector<Completion> completions_;
+    
+    // 线程池选中待逐出的连接，与慢命令结果共用 completion_fd_ 唤醒
+    struct Eviction {
+        int fd;
+        uint64_t id;
+        size_t memory;
+        size_t limit;
+    };
+    std::vector<Eviction> evictions_;
+    
+    // 统计（仅本线程写入，独占缓存行，避免与其他Worker的字段伪共享）
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> processed_commands_{0};
+    
+    alignas(CACHE_LINE_SIZE) LoopHeartbeat heartbeat_;
+    
+    // 准入控制（排队延迟超过目标时拒绝命令）
+    alignas(CACHE_LINE_SIZE) AdmissionControl admission_;
+    
+    // 活动后的自旋轮询窗口
+    alignas(CACHE_LINE_SIZE) BusyPoll busy_poll_;
 };
 
 class ThreadPool {
@@ -76,6 +214,12 @@ public:
         bool enable_cpu_affinity = true;    // 是否启用CPU亲和性
         bool auto_detect_topology = true;   // 是否自动检测CPU拓扑
         std::vector<int> custom_cpu_assignment; // 自定义CPU分配
+        size_t slow_threads = 2;            // 慢命令线程数（0 = 慢命令在事件循环中就地执行）
+        size_t slow_queue_limit = 1024;     // 慢命令排队上限，超出时就地执行
+        AdmissionControl::Options admission;    // 过载保护
+        ClientLimits client_limits;             // 限速、输出缓冲区与客户端内存上限
+        BusyPoll::Options busy_poll;            // 事件循环忙轮询
+        bool steer_by_incoming_cpu = false;     // TCP连接交给收包CPU附近的Worker（需要CPU亲和性）
     };
     
     ThreadPool(size_t worker_count, std::shared_ptr<CommandHandler> handler);
@@ -86,13 +230,19 @@ public:
     void stop();
     
     // 负载均衡：将客户端分配给负载最轻的Worker
-    void assign_client(int client_fd);
+    void assign_client(int client_fd, bool tcp = true);
     void remove_client(int client_fd);
+    void assign_shm_session(std::unique_ptr<ShmSession> session);
+    
+    // 分配连接ID（TCP 与共享内存连接共用同一序列，共享内存会话在握手前取得）
+    static uint64_t next_connection_id();
     
     // CPU亲和性管理
     void enable_cpu_affinity(bool enable);
     bool is_cpu_affinity_enabled() const { return options_.enable_cpu_affinity; }
     void print_cpu_assignment() const;
+    // Worker 绑定的 CPU（未绑定的不列出）
+    std::vector<int> worker_cpus() const;
     
     // 统计信息
     struct Stats {
@@ -101,16 +251,50 @@ public:
         std::vector<size_t> worker_clients;
         std::vector<uint64_t> worker_commands;
         std::vector<int> worker_cpu_assignments; // 工作线程CPU分配
+        uint64_t offloaded_commands = 0;    // 交给慢命令线程池执行的命令数
+        uint64_t offload_rejected = 0;      // 慢命令队列已满而就地执行的次数
+        uint64_t shed_commands = 0;         // 过载时以 -BUSY 拒绝的命令数
+        size_t overloaded_workers = 0;      // 当前处于过载状态的Worker数
+        size_t client_memory = 0;           // 所有连接的缓冲区总和
+        uint64_t evicted_clients = 0;       // 因输出缓冲区或客户端内存上限被断开的连接数
+        std::vector<BusyPoll::Stats> worker_busy_poll;  // 各Worker的忙轮询统计（未开启时全为 0）
+        // 按收包CPU引导的TCP连接：交给同一CPU、SMT兄弟、同一L3上的Worker，以及未能就近分配的
+        uint64_t steered_same_cpu = 0;
+        uint64_t steered_smt = 0;
+        uint64_t steered_llc = 0;
+        uint64_t steered_remote = 0;
     };
     
     Stats get_stats() const;
     
+    // 当前连接总数（只汇总各Worker的原子计数，accept 路径上逐个连接调用）
+    size_t client_count() const;
+    
+    // 各Worker的事件循环心跳
+    std::vector<LoopHeartbeat*> get_heartbeats() const;
+    
+    // 所有Worker都处于过载状态（准入控制开启时），接受线程据此拒绝新连接
+    bool overloaded() const;
+    
+    // CLIENT LIST：所有Worker的连接
+    std::string describe_clients();
+    
+    // 客户端限制（CONFIG SET 修改后发布新快照，各Worker在下一轮事件循环时生效）
+    void set_client_limits(const ClientLimits& limits) { client_limits_.publish(limits); }
+    const ConfigSnapshot<ClientLimits>& client_limits() const { return client_limits_; }
+    
 private:
     std::vector<std::unique_ptr<WorkerThread>> workers_;
     std::atomic<size_t> current_worker_{0};  // 轮询分配
     std::shared_ptr<CommandHandler> handler_;
     Options options_;  // 线程池选项
     std::vector<int> cpu_assignments_;  // CPU分配方案
+    std::unique_ptr<SlowCommandPool> slow_pool_;
+    ConfigSnapshot<ClientLimits> client_limits_;
+    
+    // 客户端内存上限：后台任务周期性汇总所有Worker的占用，按全局从大到小逐出
+    TaskScheduler::TaskId memory_task_ = 0;
+    void enforce_client_memory_cap();
     
     // 客户端到Worker的映射
     std::unordered_map<int, int> client_to_worker_;
@@ -118,4 +302,12 @@ private:
     
     // 初始化CPU分配
     void initialize_cpu_assignment(size_t worker_count);
+    
+    // 连接引导：每个CPU按距离分层的候选Worker（同一CPU、SMT兄弟、共享L3）
+    static constexpr size_t LOCALITY_TIERS = 3;
+    std::vector<std::array<std::vector<size_t>, LOCALITY_TIERS>> cpu_locality_;
+    std::array<std::atomic<uint64_t>, LOCALITY_TIERS + 1> steered_{};  // 最后一项为未能就近分配
+    void initialize_locality();
+    // 按连接的 SO_INCOMING_CPU 选择就近的Worker，候选都明显比最空闲的Worker忙时返回 fallback
+    size_t steer(int client_fd, size_t fallback, size_t min_clients);
 };
@@ -0,0 +1,149 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * 命令流量追踪文件格式（服务器抓取与离线工具共用）
+ *
+ * 文件头（24字节，小端）：
+ *   magic[8] = "SRTRACE1" | version u32 | reserved u32 | start_unix_us u64
+ * 之后是连续的记录，所有整数均为 LEB128 变长编码：
+ *   timestamp_us（相对 start_unix_us） | connection_id | argc | argc × (len | bytes)
+ * 不同 Worker 的记录按写出顺序交错，同一连接内的记录保持先后顺序；
+ * 需要全局时间顺序的工具按 timestamp_us 稳定排序。
+ */
+namespace trace {
+
+constexpr char MAGIC[8] = {'S', 'R', 'T', 'R', 'A', 'C', 'E', '1'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 24;
+
+struct Record {
+    uint64_t timestamp_us = 0;
+    uint64_t connection_id = 0;
+    std::vector<std::string> args;
+};
+
+inline void put_varint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+inline bool get_varint(const char*& p, const char* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+inline void put_u32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+
+inline void put_u64(std::string& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+
+inline uint64_t get_le(const char* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) v |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+    return v;
+}
+
+inline std::string encode_header(uint64_t start_unix_us) {
+    std::string out(MAGIC, sizeof(MAGIC));
+    put_u32(out, VERSION);
+    put_u32(out, 0);
+    put_u64(out, start_unix_us);
+    return out;
+}
+
+inline void encode_record(std::string& out, uint64_t timestamp_us, uint64_t connection_id,
+                          const std::vector<std::string>& args) {
+    put_varint(out, timestamp_us);
+    put_varint(out, connection_id);
+    put_varint(out, args.size());
+    for (const auto& arg : args) {
+        put_varint(out, arg.size());
+        out.append(arg);
+    }
+}
+
+// 解码一条记录；数据不完整或损坏时返回 false，p 的位置不确定
+inline bool decode_record(const char*& p, const char* end, Record& record) {
+    uint64_t argc = 0;
+    if (!get_varint(p, end, record.timestamp_us) ||
+        !get_varint(p, end, record.connection_id) ||
+        !get_varint(p, end, argc)) {
+        return false;
+    }
+    record.args.resize(argc);
+    for (auto& arg : record.args) {
+        uint64_t len = 0;
+        if (!get_varint(p, end, len) || static_cast<uint64_t>(end - p) < len) return false;
+        arg.assign(p, len);
+        p += len;
+    }
+    return true;
+}
+
+/**
+ * 顺序读取追踪文件
+ */
+class Reader {
+public:
+    // 读入整个文件；失败时返回 false 并设置 error
+    bool open(const std::string& path, std::string& error) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) {
+            error = "cannot open " + path;
+            return false;
+        }
+        char chunk[65536];
+        size_t n;
+        while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) {
+            data_.append(chunk, n);
+        }
+        std::fclose(f);
+
+        if (data_.size() < HEADER_SIZE || std::memcmp(data_.data(), MAGIC, sizeof(MAGIC)) != 0) {
+            error = path + " is not a trace file";
+            return false;
+        }
+        if (get_le(data_.data() + 8, 4) != VERSION) {
+            error = "unsupported trace version";
+            return false;
+        }
+        start_unix_us_ = get_le(data_.data() + 16, 8);
+        pos_ = data_.data() + HEADER_SIZE;
+        return true;
+    }
+
+    // 读取下一条记录；文件结束或末尾记录不完整（抓取被中断）时返回 false
+    bool next(Record& record) {
+        const char* end = data_.data() + data_.size();
+        if (pos_ >= end) return false;
+        const char* p = pos_;
+        if (!decode_record(p, end, record)) return false;
+        pos_ = p;
+        return true;
+    }
+
+    uint64_t start_unix_us() const { return start_unix_us_; }
+
+private:
+    std::string data_;
+    const char* pos_ = nullptr;
+    uint64_t start_unix_us_ = 0;
+};
+
+} // namespace trace
@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+
+/**
+ * 事件循环心跳
+ * 工作线程在处理一批就绪事件前写入 busy_since_us，处理完清零；
+ * 阻塞在 epoll_wait 中时为 0，不算卡顿。
+ */
+struct LoopHeartbeat {
+    std::atomic<int64_t> busy_since_us{0};  // 本轮处理开始时间（steady clock 微秒），0 表示空闲
+    std::atomic<bool> thread_valid{false};
+    pthread_t thread{};
+
+    // 看门狗为当前卡顿抓取的栈（由工作线程在本轮结束时取走）
+    std::mutex stack_mutex;
+    std::string stack_sample;
+    int64_t sampled_busy_since_us = 0;      // 已抓栈的那一轮，避免同一次卡顿重复抓取
+
+    static int64_t now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void attach_current_thread() {
+        thread = pthread_self();
+        thread_valid.store(true, std::memory_order_release);
+    }
+
+    void begin() { busy_since_us.store(now_us(), std::memory_order_relaxed); }
+
+    // 结束本轮处理，返回本轮耗时（微秒）
+    int64_t end() {
+        int64_t started = busy_since_us.exchange(0, std::memory_order_relaxed);
+        return started > 0 ? now_us() - started : 0;
+    }
+
+    std::string take_stack_sample() {
+        std::lock_guard<std::mutex> lock(stack_mutex);
+        std::string sample;
+        sample.swap(stack_sample);
+        return sample;
+    }
+};
+
+/**
+ * 事件循环卡顿看门狗
+ * 后台线程周期检查每个工作线程的心跳；某一轮处理超过阈值仍未结束时，
+ * 通过信号让卡住的线程在自身栈上执行 backtrace()，把栈记录进日志，
+ * 并交给工作线程在本轮结束时连同卡顿时长一起写入 LatencyMonitor。
+ */
+class Watchdog {
+public:
+    struct Options {
+        std::chrono::milliseconds threshold;
+        std::chrono::milliseconds check_interval;
+
+        Options()
+            : threshold(100)
+            , check_interval(25) {}
+    };
+
+    explicit Watchdog(const Options& options = Options{});
+    ~Watchdog();
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    // 必须在 start() 之前注册
+    void watch(const std::string& name, LoopHeartbeat* heartbeat);
+
+    void start();
+    void stop();
+
+    uint64_t stalls_detected() const { return stalls_detected_.load(std::memory_order_relaxed); }
+
+private:
+    struct Watched {
+        std::string name;
+        LoopHeartbeat* heartbeat;
+    };
+
+    void watch_loop();
+    static std::string capture_stack(pthread_t thread);
+    static void install_signal_handler();
+
+    Options options_;
+    std::vector<Watched> watched_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    std::atomic<uint64_t> stalls_detected_{0};
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * simple_redis_core 的 C 接口，供 C 程序或其他语言通过 FFI 嵌入使用。
+ * 句柄不透明，所有函数线程安全；C++ 异常在边界处捕获并转换为返回码与错误信息。
+ * 由库分配的内存（错误信息、sr_get 返回的值）须用 sr_free 释放。
+ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct sr_store sr_store;
+
+typedef struct sr_options {
+    size_t shard_count;
+    size_t cache_size;
+    size_t cache_shards;
+    int enable_compression;
+    const char* persist_path;       /* 持久化目录，以 '/' 结尾 */
+    uint32_t sync_interval_sec;
+} sr_options;
+
+typedef struct sr_stats {
+    uint64_t cache_hits;
+    uint64_t cache_misses;
+    uint64_t cache_evictions;
+    uint64_t cache_items;
+    uint64_t persistence_saves;
+    uint64_t persistence_failures;
+} sr_stats;
+
+/* 用默认值填充选项 */
+void sr_options_init(sr_options* options);
+
+/* 打开存储；失败返回 NULL，若 error 非空则写入错误信息（需 sr_free） */
+sr_store* sr_open(const sr_options* options, char** error);
+
+/* 关闭存储并落盘 */
+void sr_close(sr_store* store);
+
+/* 成功返回 0，失败返回 -1 */
+int sr_set(sr_store* store, const char* key, size_t key_len, const char* value, size_t value_len);
+
+/* 命中返回 1 并通过 value/value_len 返回值（需 sr_free），未命中返回 0，失败返回 -1 */
+int sr_get(sr_store* store, const char* key, size_t key_len, char** value, size_t* value_len);
+
+/* 删除成功返回 1，键不存在返回 0，失败返回 -1 */
+int sr_del(sr_store* store, const char* key, size_t key_len);
+
+void sr_get_stats(sr_store* store, sr_stats* stats);
+
+void sr_free(void* ptr);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * 服务器端模块接口：以共享库形式（dlopen）加载，向命令表注册原生命令，
+ * 把多次往返的读-改-写操作下推到服务器内一次完成。
+ *
+ * 模块导出 sr_module_onload，加载时服务器传入函数表 sr_module_api；模块只通过该表调用服务器，
+ * 不直接链接服务器符号。函数表只在末尾追加新成员，模块可用 api->size 判断某个成员是否可用。
+ *
+ * 注册命令时声明键位置（first_key/last_key/key_step，与 Redis COMMAND 的约定相同）。
+ * 执行命令前服务器对全部声明的键加写锁，命令执行期间对这些键的读写是原子的；
+ * 访问未声明的键返回 SR_MODULE_ERR。命令回调在 Worker 线程中执行，不应阻塞。
+ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SR_MODULE_API_VERSION 1
+
+#define SR_MODULE_OK 0
+#define SR_MODULE_ERR (-1)
+
+/* 键类型 */
+#define SR_MODULE_KEYTYPE_EMPTY 0
+#define SR_MODULE_KEYTYPE_STRING 1
+
+/* 日志级别（与服务器日志级别对应） */
+#define SR_MODULE_LOG_DEBUG 0
+#define SR_MODULE_LOG_INFO 1
+#define SR_MODULE_LOG_WARNING 2
+#define SR_MODULE_LOG_ERROR 3
+
+typedef struct sr_module sr_module;     /* 加载中的模块 */
+typedef struct sr_call sr_call;         /* 一次命令调用：持有键锁与回复缓冲 */
+
+typedef struct sr_slice {
+    const char* ptr;
+    size_t len;
+} sr_slice;
+
+/* 命令回调：argv[0] 为命令名。返回 SR_MODULE_OK；返回 SR_MODULE_ERR 且未回复时服务器回复通用错误 */
+typedef int (*sr_command_fn)(sr_call* call, int argc, const sr_slice* argv);
+
+typedef struct sr_module_api {
+    uint32_t version;
+    uint32_t size;      /* sizeof(sr_module_api)，用于判断扩展成员是否存在 */
+
+    /* ---- 只在 sr_module_onload 中调用 ---- */
+    int (*set_name)(sr_module* module, const char* name, int version);
+    /* arity > 0 表示参数个数（含命令名）必须相等，< 0 表示至少 -arity 个；
+     * first_key 为 0 表示不访问键，last_key 为负数表示从末尾倒数 */
+    int (*register_command)(sr_module* module, const char* name, sr_command_fn fn,
+                            int arity, int first_key, int last_key, int key_step);
+    void (*log)(sr_module* module, int level, const char* message);
+
+    /* ---- 键访问（只能访问声明的键） ---- */
+    int (*key_type)(sr_call* call, sr_slice key);
+    /* 命中返回 1，value 在命令返回前有效；不存在返回 0 */
+    int (*get)(sr_call* call, sr_slice key, sr_slice* value);
+    /* 命中且为整数返回 1，不存在返回 0，值不是整数返回 SR_MODULE_ERR */
+    int (*get_integer)(sr_call* call, sr_slice key, long long* value);
+    int (*set)(sr_call* call, sr_slice key, sr_slice value);
+    int (*set_integer)(sr_call* call, sr_slice key, long long value);
+    /* 删除返回 1，键不存在返回 0 */
+    int (*del)(sr_call* call, sr_slice key);
+
+    /* ---- 回复（每条命令恰好一个顶层回复；数组的元素紧随其后依次回复） ---- */
+    void (*reply_simple)(sr_call* call, const char* status);
+    void (*reply_error)(sr_call* call, const char* message);    /* 以 '-' 开头时自带错误码，否则补上 "ERR " */
+    void (*reply_integer)(sr_call* call, long long value);
+    void (*reply_bulk)(sr_call* call, const char* data, size_t len);
+    void (*reply_null)(sr_call* call);
+    void (*reply_array)(sr_call* call, size_t count);
+} sr_module_api;
+
+/* 模块入口：argv 为配置中模块路径之后的参数。返回 SR_MODULE_ERR 时服务器卸载模块并拒绝启动 */
+typedef int (*sr_module_onload_fn)(sr_module* module, const sr_module_api* api, int argc, const char** argv);
+#define SR_MODULE_ONLOAD_SYMBOL "sr_module_onload"
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,92 @@
+// 示例模块：计数器类读-改-写命令，演示 simple_redis_module.h 接口
+//   counter.incrby key delta        -> 自增后的值
+//   counter.cas key expected value  -> 当前值等于 expected 时写入 value，返回 1，否则返回 0
+//   counter.transfer src dst amount -> src 足额时原子地从 src 转移 amount 到 dst，返回 src 余额；不足时返回错误
+// 加载：在配置的 [modules] 中加入 load = ./modules/libsr_counters.so
+#include "simple_redis_module.h"
+#include <charconv>
+#include <cstring>
+
+namespace {
+    const sr_module_api* api = nullptr;
+
+    bool parse_integer(const sr_slice& s, long long& out) {
+        auto [end, ec] = std::from_chars(s.ptr, s.ptr + s.len, out);
+        return s.len > 0 && ec == std::errc() && end == s.ptr + s.len;
+    }
+
+    bool equals(const sr_slice& a, const sr_slice& b) {
+        return a.len == b.len && std::memcmp(a.ptr, b.ptr, a.len) == 0;
+    }
+
+    int incrby(sr_call* call, int, const sr_slice* argv) {
+        long long delta, value = 0;
+        if (!parse_integer(argv[2], delta)) {
+            api->reply_error(call, "value is not an integer or out of range");
+            return SR_MODULE_OK;
+        }
+        if (api->get_integer(call, argv[1], &value) < 0) {
+            api->reply_error(call, "value is not an integer or out of range");
+            return SR_MODULE_OK;
+        }
+        if (__builtin_add_overflow(value, delta, &value)) {
+            api->reply_error(call, "increment or decrement would overflow");
+            return SR_MODULE_OK;
+        }
+        api->set_integer(call, argv[1], value);
+        api->reply_integer(call, value);
+        return SR_MODULE_OK;
+    }
+
+    int cas(sr_call* call, int, const sr_slice* argv) {
+        sr_slice current;
+        int found = api->get(call, argv[1], &current);
+        if (found < 0) return SR_MODULE_ERR;
+        if (found == 0 || !equals(current, argv[2])) {
+            api->reply_integer(call, 0);
+            return SR_MODULE_OK;
+        }
+        api->set(call, argv[1], argv[3]);
+        api->reply_integer(call, 1);
+        return SR_MODULE_OK;
+    }
+
+    int transfer(sr_call* call, int, const sr_slice* argv) {
+        long long amount, src = 0, dst = 0;
+        if (!parse_integer(argv[3], amount) || amount < 0 ||
+            api->get_integer(call, argv[1], &src) < 0 || api->get_integer(call, argv[2], &dst) < 0) {
+            api->reply_error(call, "value is not an integer or out of range");
+            return SR_MODULE_OK;
+        }
+        if (src < amount) {
+            api->reply_error(call, "-INSUFFICIENT source balance too low");
+            return SR_MODULE_OK;
+        }
+        if (__builtin_add_overflow(dst, amount, &dst)) {
+            api->reply_error(call, "increment or decrement would overflow");
+            return SR_MODULE_OK;
+        }
+        // 同一个键作为源和目标时余额不变
+        if (equals(argv[1], argv[2])) {
+            api->reply_integer(call, src);
+            return SR_MODULE_OK;
+        }
+        api->set_integer(call, argv[1], src - amount);
+        api->set_integer(call, argv[2], dst);
+        api->reply_integer(call, src - amount);
+        return SR_MODULE_OK;
+    }
+}
+
+extern "C" int sr_module_onload(sr_module* module, const sr_module_api* server_api, int, const char**) {
+    if (server_api->version < SR_MODULE_API_VERSION) return SR_MODULE_ERR;
+    api = server_api;
+    if (api->set_name(module, "counters", 1) != SR_MODULE_OK) return SR_MODULE_ERR;
+    if (api->register_command(module, "counter.incrby", incrby, 3, 1, 1, 1) != SR_MODULE_OK ||
+        api->register_command(module, "counter.cas", cas, 4, 1, 1, 1) != SR_MODULE_OK ||
+        api->register_command(module, "counter.transfer", transfer, 4, 1, 2, 1) != SR_MODULE_OK) {
+        return SR_MODULE_ERR;
+    }
+    api->log(module, SR_MODULE_LOG_INFO, "counter commands registered");
+    return SR_MODULE_OK;
+}
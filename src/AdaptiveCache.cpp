@@ -20,21 +20,18 @@ AdaptiveCache::AdaptiveCache(const Options& options)
         
     // 初始化分片
     for (size_t i = 0; i < shard_count_; ++i) {
-        shards_[i] = std::make_unique<Shard>(options.memory_pool_block_size);
+        shards_[i] = std::make_unique<Shard>();
     }
     
-    // 启动自适应调整线程
+    // 启动自适应调整任务
     if (enable_adaptive_sizing_) {
-        adjustment_thread_ = std::thread(&AdaptiveCache::adjustment_thread_func, this);
+        start_adjustment_task();
     }
 }
 
 AdaptiveCache::~AdaptiveCache() {
-    // 停止自适应调整线程
-    should_stop_ = true;
-    if (adjustment_thread_.joinable()) {
-        adjustment_thread_.join();
-    }
+    // 取消自适应调整任务（正在执行时等待其结束）
+    TaskScheduler::instance().cancel(adjustment_task_);
     
     // 清空缓存
     clear();
@@ -50,6 +47,8 @@ void AdaptiveCache::put(const std::string& key, const std::string& value) {
         auto it = shard.item_map.find(key);
         if (it != shard.item_map.end()) {
             // 更新现有项
+            update_memory_stats(static_cast<ptrdiff_t>(value.size()) -
+                                static_cast<ptrdiff_t>(it->second->value.size()));
             it->second->value = value;
             
             // 通知策略访问事件
@@ -65,34 +64,132 @@ void AdaptiveCache::put(const std::string& key, const std::string& value) {
             return;
         }
         
-        // 检查是否需要驱逐
-        if (size() >= capacity_) {
-            size_t items_to_evict = calculate_items_to_evict();
-            evict_items(shard, items_to_evict);
+        // 检查是否需要驱逐（以分片本地项数判断，避免每次写入都汇总全局计数）
+        if (shard.item_map.size() >= shard_capacity()) {
+            size_t items_to_evict = calculate_items_to_evict(shard);
+            evict_items_locked(shard, items_to_evict);
         }
         
-        // 从对象池分配新项
-        CacheItem* new_item = shard.allocate_item(key, value);
-        
-        // 插入到列表和映射
-        auto iter = shard.items.insert(shard.items.begin(), *new_item);
+        // 直接在列表节点中构造新项并插入映射
+        auto iter = shard.items.emplace(shard.items.begin(), key, value);
         shard.item_map[key] = iter;
         
         // 通知策略新项添加
         std::lock_guard<std::mutex> policy_lock(policy_mutex_);
-        policy_->on_add(key, *new_item);
+        policy_->on_add(key, *iter);
         
         // 更新缓存大小
         update_size_stats(1);
+        update_memory_stats(static_cast<ptrdiff_t>(item_footprint(key, value)));
     }
     
     // 检查并清理过期项（在锁外执行以减少锁持有时间）
-    if (static_cast<double>(size()) / capacity_ > cleanup_threshold_) {
+    size_t shard_size;
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        shard_size = shard.item_map.size();
+    }
+    if (static_cast<double>(shard_size) / shard_capacity() > cleanup_threshold_) {
         cleanup_expired(shard);
     }
 }
 
+void AdaptiveCache::put_batch(const KeyValueRefs& items) {
+    // 按分片分组：同一键总在同一分片，多次写入保持原有顺序
+    // 排序与通知的临时数组按线程复用，稳定状态下不分配
+    thread_local std::vector<std::pair<size_t, size_t>> order;  // (分片下标, 项下标)
+    thread_local PendingNotify pending;
+    order.clear();
+    for (size_t i = 0; i < items.size(); ++i) {
+        order.emplace_back(get_shard_index(*items[i].first), i);
+    }
+    // 第二关键字是项下标：普通排序即保持同一键的写入顺序，且不像 stable_sort 那样申请临时缓冲区
+    std::sort(order.begin(), order.end());
+    
+    CachePolicy::Type policy_type;
+    {
+        std::lock_guard<std::mutex> policy_lock(policy_mutex_);
+        policy_type = policy_->type();
+    }
+    
+    pending.clear();
+    for (size_t pos = 0; pos < order.size();) {
+        size_t shard_idx = order[pos].first;
+        auto& shard = *shards_[shard_idx];
+        int size_delta = 0;
+        ptrdiff_t memory_delta = 0;
+        
+        {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            for (; pos < order.size() && order[pos].first == shard_idx; ++pos) {
+                const auto& key = *items[order[pos].second].first;
+                const auto& value = *items[order[pos].second].second;
+                
+                auto it = shard.item_map.find(key);
+                if (it != shard.item_map.end()) {
+                    memory_delta += static_cast<ptrdiff_t>(value.size()) -
+                                    static_cast<ptrdiff_t>(it->second->value.size());
+                    it->second->value.assign(value);
+                    if (policy_type == CachePolicy::Type::LRU) {
+                        shard.items.splice(shard.items.begin(), shard.items, it->second);
+                    }
+                    pending.emplace_back(false, it->second);
+                    continue;
+                }
+                
+                if (shard.item_map.size() >= shard_capacity()) {
+                    // 驱逐前先补发通知，策略看到的事件顺序与逐条写入一致
+                    notify_policy_locked(pending);
+                    evict_items_locked(shard, calculate_items_to_evict(shard));
+                }
+                
+                auto iter = shard.items.emplace(shard.items.begin(), key, value);
+                shard.item_map[key] = iter;
+                pending.emplace_back(true, iter);
+                size_delta++;
+                memory_delta += static_cast<ptrdiff_t>(item_footprint(key, value));
+            }
+            notify_policy_locked(pending);
+        }
+        
+        update_size_stats(size_delta);
+        update_memory_stats(memory_delta);
+        
+        size_t shard_size;
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            shard_size = shard.item_map.size();
+        }
+        if (static_cast<double>(shard_size) / shard_capacity() > cleanup_threshold_) {
+            cleanup_expired(shard);
+        }
+    }
+}
+
+void AdaptiveCache::notify_policy_locked(PendingNotify& pending) {
+    if (pending.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> policy_lock(policy_mutex_);
+    for (const auto& [added, iter] : pending) {
+        if (added) {
+            policy_->on_add(iter->key, *iter);
+        } else {
+            policy_->on_access(iter->key, *iter);
+        }
+    }
+    pending.clear();
+}
+
 std::optional<std::string> AdaptiveCache::get(const std::string& key) {
+    std::string value;
+    if (!get_into(key, value)) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+bool AdaptiveCache::get_into(const std::string& key, std::string& out) {
     auto& shard = get_shard(key);
     
     std::shared_lock<std::shared_mutex> lock(shard.mutex);
@@ -100,8 +197,8 @@ std::optional<std::string> AdaptiveCache::get(const std::string& key) {
     auto it = shard.item_map.find(key);
     if (it == shard.item_map.end()) {
         // 缓存未命中
-        misses_.fetch_add(1, std::memory_order_relaxed);
-        return std::nullopt;
+        misses_.inc();
+        return false;
     }
     
     auto& item = *it->second;
@@ -113,9 +210,9 @@ std::optional<std::string> AdaptiveCache::get(const std::string& key) {
             // 项过期，移除并返回未命中
             lock.unlock(); // 需要先释放共享锁
             remove(key);
-            expirations_.fetch_add(1, std::memory_order_relaxed);
-            misses_.fetch_add(1, std::memory_order_relaxed);
-            return std::nullopt;
+            expirations_.inc();
+            misses_.inc();
+            return false;
         }
         
         // 通知策略访问事件
@@ -132,17 +229,19 @@ std::optional<std::string> AdaptiveCache::get(const std::string& key) {
         auto it_recheck = shard.item_map.find(key);
         if (it_recheck != shard.item_map.end()) {
             shard.items.splice(shard.items.begin(), shard.items, it_recheck->second);
-            hits_.fetch_add(1, std::memory_order_relaxed);
-            return it_recheck->second->value;
+            hits_.inc();
+            out.assign(it_recheck->second->value);
+            return true;
         } else {
-            misses_.fetch_add(1, std::memory_order_relaxed);
-            return std::nullopt;
+            misses_.inc();
+            return false;
         }
     }
     
     // 对于其他策略，不移动位置
-    hits_.fetch_add(1, std::memory_order_relaxed);
-    return item.value;
+    hits_.inc();
+    out.assign(item.value);
+    return true;
 }
 
 bool AdaptiveCache::contains(const std::string& key) {
@@ -162,7 +261,6 @@ bool AdaptiveCache::remove(const std::string& key) {
         return false;
     }
     
-    // 保存指针用于后续释放
     CacheItem* item_ptr = &(*it->second);
     
     // 通知策略项被驱逐
@@ -171,43 +269,79 @@ bool AdaptiveCache::remove(const std::string& key) {
         policy_->on_eviction(key, *item_ptr);
     }
     
+    update_memory_stats(-static_cast<ptrdiff_t>(item_footprint(item_ptr->key, item_ptr->value)));
+    
     // 从列表移除
     shard.items.erase(it->second);
     
     // 从映射移除
     shard.item_map.erase(it);
     
-    // 释放回对象池
-    shard.deallocate_item(item_ptr);
-    
     // 更新缓存大小
     update_size_stats(-1);
     
     return true;
 }
 
-void AdaptiveCache::clear() {
+std::optional<std::string> AdaptiveCache::take(const std::string& key) {
+    auto& shard = get_shard(key);
+    
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    
+    auto it = shard.item_map.find(key);
+    if (it == shard.item_map.end()) {
+        return std::nullopt;
+    }
+    
+    {
+        std::lock_guard<std::mutex> policy_lock(policy_mutex_);
+        policy_->on_eviction(key, *it->second);
+    }
+    
+    update_memory_stats(-static_cast<ptrdiff_t>(item_footprint(it->second->key, it->second->value)));
+    std::string value = std::move(it->second->value);
+    shard.items.erase(it->second);
+    shard.item_map.erase(it);
+    update_size_stats(-1);
+    
+    return value;
+}
+
+AdaptiveCache::Detached AdaptiveCache::detach_all() {
+    Detached detached;
+    detached.items.resize(shard_count_);
+    detached.maps.resize(shard_count_);
     for (size_t i = 0; i < shard_count_; ++i) {
         auto& shard = *shards_[i];
         
         std::unique_lock<std::shared_mutex> lock(shard.mutex);
         
-        // 释放所有项回对象池
-        for (auto& item : shard.items) {
-            CacheItem* item_ptr = &item;
-            shard.deallocate_item(item_ptr);
-        }
+        detached.items[i].swap(shard.items);
+        detached.maps[i].swap(shard.item_map);
+    }
+    
+    size_.reset();
+    memory_usage_.reset();
+    return detached;
+}
+
+void AdaptiveCache::clear() {
+    for (size_t i = 0; i < shard_count_; ++i) {
+        auto& shard = *shards_[i];
+        
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
         
         shard.items.clear();
         shard.item_map.clear();
     }
     
     // 重置大小统计
-    size_.store(0, std::memory_order_relaxed);
+    size_.reset();
+    memory_usage_.reset();
 }
 
 size_t AdaptiveCache::size() const {
-    return size_.load(std::memory_order_relaxed);
+    return size_.load();
 }
 
 size_t AdaptiveCache::capacity() const {
@@ -215,8 +349,8 @@ size_t AdaptiveCache::capacity() const {
 }
 
 double AdaptiveCache::hit_ratio() const {
-    size_t hits = hits_.load(std::memory_order_relaxed);
-    size_t misses = misses_.load(std::memory_order_relaxed);
+    size_t hits = hits_.load();
+    size_t misses = misses_.load();
     size_t total = hits + misses;
     
     if (total == 0) {
@@ -249,17 +383,10 @@ void AdaptiveCache::enable_adaptive_sizing(bool enable) {
     enable_adaptive_sizing_ = enable;
     
     if (enable) {
-        // 启动自适应调整线程
-        if (!adjustment_thread_.joinable()) {
-            should_stop_ = false;
-            adjustment_thread_ = std::thread(&AdaptiveCache::adjustment_thread_func, this);
-        }
+        start_adjustment_task();
     } else {
-        // 停止自适应调整线程
-        should_stop_ = true;
-        if (adjustment_thread_.joinable()) {
-            adjustment_thread_.join();
-        }
+        TaskScheduler::instance().cancel(adjustment_task_);
+        adjustment_task_ = 0;
     }
 }
 
@@ -293,23 +420,15 @@ AdaptiveCache::Stats AdaptiveCache::get_stats() const {
     
     stats.size = size();
     stats.capacity = capacity();
-    stats.hits = hits_.load(std::memory_order_relaxed);
-    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.hits = hits_.load();
+    stats.misses = misses_.load();
     stats.hit_ratio = hit_ratio();
     stats.policy_name = get_policy_name();
-    stats.evictions = evictions_.load(std::memory_order_relaxed);
-    stats.expirations = expirations_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load();
+    stats.expirations = expirations_.load();
     
-    // 估计内存使用量
-    size_t approx_mem = 0;
-    for (size_t i = 0; i < shard_count_; ++i) {
-        std::shared_lock<std::shared_mutex> lock(shards_[i]->mutex);
-        // 每个项大约需要：键大小 + 值大小 + CacheItem对象大小 + 映射开销
-        for (const auto& item : shards_[i]->items) {
-            approx_mem += item.key.size() + item.value.size() + sizeof(CacheItem) + 32; // 32为映射开销估计
-        }
-    }
-    stats.memory_usage = approx_mem;
+    // 估计内存使用量（增量维护，读取时无需遍历分片加锁）
+    stats.memory_usage = memory_usage_.load();
     
     // 计算运行时间
     auto now = std::chrono::steady_clock::now();
@@ -333,6 +452,11 @@ void AdaptiveCache::evict_items(Shard& shard, size_t count) {
     if (count == 0) return;
     
     std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    evict_items_locked(shard, count);
+}
+
+void AdaptiveCache::evict_items_locked(Shard& shard, size_t count) {
+    if (count == 0) return;
     
     // 找出要驱逐的项
     std::vector<std::pair<std::string, double>> candidates;
@@ -364,7 +488,6 @@ void AdaptiveCache::evict_items(Shard& shard, size_t count) {
         const auto& key = candidates[i].first;
         auto it = shard.item_map.find(key);
         if (it != shard.item_map.end()) {
-            // 保存指针用于释放
             CacheItem* item_ptr = &(*it->second);
             
             // 通知策略
@@ -373,16 +496,15 @@ void AdaptiveCache::evict_items(Shard& shard, size_t count) {
                 policy_->on_eviction(key, *item_ptr);
             }
             
+            update_memory_stats(-static_cast<ptrdiff_t>(item_footprint(item_ptr->key, item_ptr->value)));
+            
             // 从列表和映射中移除
             shard.items.erase(it->second);
             shard.item_map.erase(it);
             
-            // 释放回对象池
-            shard.deallocate_item(item_ptr);
-            
             // 更新统计
             update_size_stats(-1);
-            evictions_.fetch_add(1, std::memory_order_relaxed);
+            evictions_.inc();
         }
     }
 }
@@ -406,62 +528,61 @@ void AdaptiveCache::cleanup_expired(Shard& shard) {
     for (const auto& key : expired_keys) {
         auto it = shard.item_map.find(key);
         if (it != shard.item_map.end()) {
-            // 保存指针用于释放
             CacheItem* item_ptr = &(*it->second);
             
+            update_memory_stats(-static_cast<ptrdiff_t>(item_footprint(item_ptr->key, item_ptr->value)));
+            
             // 从列表和映射中移除
             shard.items.erase(it->second);
             shard.item_map.erase(it);
             
-            // 释放回对象池
-            shard.deallocate_item(item_ptr);
-            
             // 更新统计
             update_size_stats(-1);
-            expirations_.fetch_add(1, std::memory_order_relaxed);
+            expirations_.inc();
         }
     }
 }
 
-void AdaptiveCache::adjustment_thread_func() {
-    while (!should_stop_) {
-        // 休眠指定间隔
-        for (int i = 0; i < adjustment_interval_.count() && !should_stop_; ++i) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-        }
-        
-        if (should_stop_) break;
+void AdaptiveCache::start_adjustment_task() {
+    TaskScheduler::TaskOptions options;
+    options.name = "cache-resize";
+    options.priority = TaskScheduler::Priority::LOW;
+    options.delay = adjustment_interval_;
+    options.period = adjustment_interval_;
+    adjustment_task_ = TaskScheduler::instance().schedule([this] { adjust_capacity(); }, options);
+}
+
+void AdaptiveCache::adjust_capacity() {
+    // 获取策略建议
+    int adjustment = 0;
+    {
+        std::lock_guard<std::mutex> lock(policy_mutex_);
+        adjustment = policy_->get_size_adjustment();
+    }
+    
+    if (adjustment != 0) {
+        // 根据当前大小和建议计算新容量
+        size_t current = capacity();
+        double factor = 1.0 + (adjustment / 100.0);
+        size_t new_capacity = static_cast<size_t>(current * factor);
         
-        // 检查是否需要调整大小
-        if (!enable_adaptive_sizing_) continue;
+        // 限制在最小/最大范围内
+        new_capacity = std::max(min_capacity_, std::min(max_capacity_, new_capacity));
         
-        // 获取策略建议
-        int adjustment = 0;
-        {
-            std::lock_guard<std::mutex> lock(policy_mutex_);
-            adjustment = policy_->get_size_adjustment();
-        }
-        
-        if (adjustment != 0) {
-            // 根据当前大小和建议计算新容量
-            size_t current = capacity();
-            double factor = 1.0 + (adjustment / 100.0);
-            size_t new_capacity = static_cast<size_t>(current * factor);
-            
-            // 限制在最小/最大范围内
-            new_capacity = std::max(min_capacity_, std::min(max_capacity_, new_capacity));
-            
-            // 设置新容量
-            if (new_capacity != current) {
-                set_capacity(new_capacity);
-            }
+        // 设置新容量
+        if (new_capacity != current) {
+            set_capacity(new_capacity);
         }
     }
 }
 
-size_t AdaptiveCache::calculate_items_to_evict() const {
-    size_t current_size = size();
-    size_t current_capacity = capacity();
+size_t AdaptiveCache::shard_capacity() const {
+    return std::max<size_t>(1, capacity() / shard_count_);
+}
+
+size_t AdaptiveCache::calculate_items_to_evict(const Shard& shard) const {
+    size_t current_size = shard.item_map.size();
+    size_t current_capacity = shard_capacity();
     
     // 如果超出容量，计算需要驱逐的数量
     if (current_size > current_capacity) {
@@ -481,9 +602,14 @@ size_t AdaptiveCache::calculate_items_to_evict() const {
 }
 
 void AdaptiveCache::update_size_stats(int delta) {
-    if (delta > 0) {
-        size_.fetch_add(delta, std::memory_order_relaxed);
-    } else if (delta < 0) {
-        size_.fetch_sub(-delta, std::memory_order_relaxed);
-    }
-} 
\ No newline at end of file
+    size_.add(delta);
+}
+
+size_t AdaptiveCache::item_footprint(const std::string& key, const std::string& value) {
+    // 每个项大约需要：键大小 + 值大小 + CacheItem对象大小 + 映射开销（32字节估计）
+    return key.size() + value.size() + sizeof(CacheItem) + 32;
+}
+
+void AdaptiveCache::update_memory_stats(ptrdiff_t delta) {
+    memory_usage_.add(delta);
+}
@@ -0,0 +1,47 @@
+#include "AdmissionControl.h"
+#include <algorithm>
+
+AdmissionControl::AdmissionControl(const Options& options)
+    : options_(options) {}
+
+void AdmissionControl::on_event(uint64_t now_us, uint64_t sojourn_us) {
+    current_sojourn_us_ = sojourn_us;
+
+    if (interval_start_us_ == 0) {
+        interval_start_us_ = now_us;
+    }
+    if (now_us - interval_start_us_ >= static_cast<uint64_t>(options_.interval_ms) * 1000) {
+        // 区间结束：整个区间内最小排队延迟都超过目标，才判定为持续过载
+        overloaded_.store(min_sojourn_us_ != UINT64_MAX && min_sojourn_us_ > options_.target_us,
+                          std::memory_order_relaxed);
+        interval_start_us_ = now_us;
+        min_sojourn_us_ = UINT64_MAX;
+    }
+    min_sojourn_us_ = std::min(min_sojourn_us_, sojourn_us);
+
+    // 过载期间一旦出现低于目标的延迟就立即恢复，不等区间结束
+    if (sojourn_us <= options_.target_us && overloaded()) {
+        overloaded_.store(false, std::memory_order_relaxed);
+    }
+}
+
+void AdmissionControl::on_idle() {
+    overloaded_.store(false, std::memory_order_relaxed);
+    interval_start_us_ = 0;
+    min_sojourn_us_ = UINT64_MAX;
+}
+
+bool AdmissionControl::should_shed(Priority priority) const {
+    if (!options_.enabled || !overloaded()) {
+        return false;
+    }
+    switch (priority) {
+        case Priority::Low:
+            return true;
+        case Priority::Normal:
+            return current_sojourn_us_ > 2ull * options_.target_us;
+        case Priority::Critical:
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,368 @@
+#include "AutoTune.h"
+#include "DataStore.h"
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <filesystem>
+#endif
+
+namespace {
+
+bool read_line(const std::string& path, std::string& line) {
+    std::ifstream in(path);
+    return static_cast<bool>(std::getline(in, line));
+}
+
+// sysfs 缓存大小："32K" / "2048K" / "32M"
+size_t parse_cache_size(const std::string& text) {
+    char* end = nullptr;
+    unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str()) return 0;
+    if (*end == 'K' || *end == 'k') value <<= 10;
+    else if (*end == 'M' || *end == 'm') value <<= 20;
+    else if (*end == 'G' || *end == 'g') value <<= 30;
+    return static_cast<size_t>(value);
+}
+
+size_t round_up_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+size_t round_down_pow2(size_t n) {
+    size_t p = 1;
+    while (p * 2 <= n) p <<= 1;
+    return p;
+}
+
+void report(const char* name, size_t value, const std::string& reason) {
+    LOG_INFO("Auto-tune: %s = %zu (%s)", name, value, reason.c_str());
+}
+
+} // namespace
+
+HardwareInfo HardwareInfo::probe() {
+    HardwareInfo hw;
+    hw.online_cpus = std::max(1u, std::thread::hardware_concurrency());
+    hw.usable_cpus = hw.online_cpus;
+    hw.physical_cores = hw.online_cpus;
+
+#ifdef __linux__
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online > 0) hw.online_cpus = static_cast<size_t>(online);
+    long page = sysconf(_SC_PAGESIZE);
+    if (page > 0) hw.page_size = static_cast<size_t>(page);
+    long pages = sysconf(_SC_PHYS_PAGES);
+    if (pages > 0) hw.total_memory = static_cast<size_t>(pages) * hw.page_size;
+
+    // 亲和性掩码（taskset / cpuset 限制后的 CPU 集合）
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int i = 0; i < CPU_SETSIZE; ++i) {
+            if (CPU_ISSET(i, &set)) cpus.push_back(i);
+        }
+    }
+    if (cpus.empty()) {
+        for (size_t i = 0; i < hw.online_cpus; ++i) cpus.push_back(static_cast<int>(i));
+    }
+    hw.usable_cpus = cpus.size();
+
+    // 物理核心：(封装, 核心) 去重，SMT 兄弟线程算一个核心
+    std::set<std::pair<std::string, std::string>> cores;
+    for (int cpu : cpus) {
+        std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+        std::string package, core;
+        if (!read_line(base + "physical_package_id", package) || !read_line(base + "core_id", core)) {
+            cores.clear();
+            break;
+        }
+        cores.emplace(package, core);
+    }
+    hw.physical_cores = cores.empty() ? hw.usable_cpus : cores.size();
+
+    // 容器 CPU 配额（cgroup v2 cpu.max："<quota> <period>" 或 "max <period>"）：
+    // 配额小于可用 CPU 时按配额计，否则多出来的线程只会被限流
+    std::string line;
+    if (read_line("/sys/fs/cgroup/cpu.max", line) && line.compare(0, 3, "max") != 0) {
+        unsigned long long quota = 0, period = 0;
+        if (std::sscanf(line.c_str(), "%llu %llu", &quota, &period) == 2 && quota > 0 && period > 0) {
+            size_t quota_cpus = static_cast<size_t>((quota + period - 1) / period);
+            hw.usable_cpus = std::min(hw.usable_cpus, std::max<size_t>(1, quota_cpus));
+            hw.physical_cores = std::min(hw.physical_cores, hw.usable_cpus);
+        }
+    }
+    // 容器内存上限（cgroup v2 memory.max）
+    if (read_line("/sys/fs/cgroup/memory.max", line) && line != "max") {
+        unsigned long long limit = std::strtoull(line.c_str(), nullptr, 10);
+        if (limit > 0 && (hw.total_memory == 0 || limit < hw.total_memory)) {
+            hw.total_memory = static_cast<size_t>(limit);
+        }
+    }
+
+    // 末级缓存：第一个可用 CPU 上级别最高的缓存
+    std::error_code ec;
+    std::string cache_dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpus.front()) + "/cache";
+    int best_level = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(cache_dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.compare(0, 5, "index") != 0) continue;
+        std::string level, size;
+        if (!read_line(entry.path().string() + "/level", level) ||
+            !read_line(entry.path().string() + "/size", size)) {
+            continue;
+        }
+        int lv = std::atoi(level.c_str());
+        if (lv > best_level) {
+            best_level = lv;
+            hw.l3_bytes = parse_cache_size(size);
+        }
+    }
+
+    // NUMA 节点：/sys/devices/system/node/node<N>
+    size_t nodes = 0;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            std::isdigit(static_cast<unsigned char>(name[4]))) {
+            ++nodes;
+        }
+    }
+    hw.numa_nodes = std::max<size_t>(1, nodes);
+
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY) {
+        hw.fd_limit = static_cast<size_t>(rl.rlim_cur);
+    }
+#endif
+
+    return hw;
+}
+
+void AutoTune::apply(RedisServer::Config& config) {
+    if (config.auto_params == 0) return;
+    apply(config, HardwareInfo::probe());
+}
+
+void AutoTune::apply(RedisServer::Config& config, const HardwareInfo& hw) {
+    const uint32_t params = config.auto_params;
+    if (params == 0) return;
+
+    LOG_INFO("Auto-tune: %zu/%zu CPUs usable, %zu physical cores, %zu NUMA node(s), "
+             "last-level cache %zu KB, memory %zu MB, fd limit %zu",
+             hw.usable_cpus, hw.online_cpus, hw.physical_cores, hw.numa_nodes,
+             hw.l3_bytes >> 10, hw.total_memory >> 20, hw.fd_limit);
+
+    const size_t cpus = std::max<size_t>(1, hw.usable_cpus);
+    const size_t cores = std::max<size_t>(1, std::min(hw.physical_cores, cpus));
+
+    // 工作线程：每个物理核心一个事件循环。SMT 兄弟线程共享执行单元，繁忙的事件循环放在
+    // 同一核心的两个硬件线程上只会互相抢占；核心较多时留一个给 accept、落盘与后台线程
+    std::vector<size_t> worker_candidates;
+    if (params & WORKER_THREADS) {
+        size_t workers = cores;
+        std::string reason = cores < cpus ? "one event loop per physical core, SMT siblings left idle"
+                                          : "one event loop per usable CPU";
+        if (cores >= 8) {
+            workers = cores - 1;
+            reason += ", one core reserved for accept/persistence/background threads";
+        }
+        config.worker_threads = workers;
+        report("worker_threads", workers, reason);
+        worker_candidates.push_back(workers);
+        if (cpus > cores) worker_candidates.push_back(cpus - (cores >= 8 ? 1 : 0));
+    }
+
+    if (params & SLOW_THREADS) {
+        config.slow_threads = std::min<size_t>(4, std::max<size_t>(1, cpus / 8));
+        report("slow_threads", config.slow_threads, "one per 8 usable CPUs, between 1 and 4");
+    }
+
+    // 每个分片的桶数：全部桶（各含子map头与独立的锁）的元数据不超过末级缓存的 1/4，
+    // 热路径上的锁与哈希表头才能常驻缓存
+    const size_t llc = hw.l3_bytes ? hw.l3_bytes : (8u << 20);
+    auto buckets_for = [&](size_t shards) {
+        size_t budget = llc / 4 / (shards * DataStore::bucket_bytes());
+        return std::min<size_t>(64, std::max<size_t>(4, round_down_pow2(std::max<size_t>(1, budget))));
+    };
+
+    // 分片数：每个工作线程 4 个分片，两个线程同时落在同一把分片锁上的概率保持在低位；
+    // 不少于 NUMA 节点数，最后取 2 的幂。分片按取模定位，并不要求 2 的幂：取 2 的幂是为了让
+    // 校准候选（减半/加倍）落在同一序列上，节点数为 2 的幂时分片也自然均分到各节点
+    std::vector<size_t> shard_candidates;
+    if (params & SHARD_COUNT) {
+        size_t wanted = std::max<size_t>(config.worker_threads * 4, hw.numa_nodes);
+        size_t shards = std::min<size_t>(4096, std::max<size_t>(16, round_up_pow2(wanted)));
+        config.shard_count = shards;
+        report("shard_count", shards, "4 per worker thread x " + std::to_string(config.worker_threads) +
+               " workers, power of two, at least 16");
+        if (shards / 2 >= 16) shard_candidates.push_back(shards / 2);
+        shard_candidates.push_back(shards);
+        if (shards * 2 <= 4096) shard_candidates.push_back(shards * 2);
+    }
+
+    // 自校准：在候选值之间做短暂压测，除非明显更快（>5%）否则保留推导值
+    if (config.auto_calibrate && (worker_candidates.size() > 1 || shard_candidates.size() > 1)) {
+        if (worker_candidates.size() > 1) {
+            size_t chosen = config.worker_threads;
+            double chosen_ops = measure(chosen, config.shard_count, buckets_for(config.shard_count));
+            for (size_t candidate : worker_candidates) {
+                if (candidate == chosen) continue;
+                double ops = measure(candidate, config.shard_count, buckets_for(config.shard_count));
+                LOG_INFO("Auto-tune: calibration worker_threads %zu: %.0f ops/s vs %zu: %.0f ops/s",
+                         candidate, ops, chosen, chosen_ops);
+                if (ops > chosen_ops * 1.05) {
+                    chosen = candidate;
+                    chosen_ops = ops;
+                }
+            }
+            if (chosen != config.worker_threads) {
+                config.worker_threads = chosen;
+                report("worker_threads", chosen, "calibration: SMT siblings added throughput");
+            }
+        }
+        if (shard_candidates.size() > 1) {
+            size_t chosen = config.shard_count;
+            double chosen_ops = measure(config.worker_threads, chosen, buckets_for(chosen));
+            for (size_t candidate : shard_candidates) {
+                if (candidate == chosen) continue;
+                double ops = measure(config.worker_threads, candidate, buckets_for(candidate));
+                LOG_INFO("Auto-tune: calibration shard_count %zu: %.0f ops/s vs %zu: %.0f ops/s",
+                         candidate, ops, chosen, chosen_ops);
+                if (ops > chosen_ops * 1.05) {
+                    chosen = candidate;
+                    chosen_ops = ops;
+                }
+            }
+            if (chosen != config.shard_count) {
+                config.shard_count = chosen;
+                report("shard_count", chosen, "calibration: highest measured throughput");
+            }
+        }
+    }
+
+    if (params & BUCKET_PER_SHARD) {
+        config.bucket_per_shard = buckets_for(config.shard_count);
+        size_t footprint = config.shard_count * config.bucket_per_shard * DataStore::bucket_bytes();
+        report("bucket_per_shard", config.bucket_per_shard,
+               "lock metadata " + std::to_string(footprint >> 10) + " KB within 1/4 of " +
+               std::to_string(llc >> 10) + " KB last-level cache" + (hw.l3_bytes ? "" : " (assumed)"));
+    }
+
+    // 最大连接数：受文件描述符上限约束，预留监听、epoll、落盘与日志等描述符。
+    // 软限制低于硬限制时先提高软限制
+    if (params & MAX_CONNECTIONS) {
+        const size_t reserve = 128 + config.worker_threads * 4;
+        size_t fd_limit = hw.fd_limit;
+        std::string reason;
+#ifdef __linux__
+        struct rlimit rl;
+        if (fd_limit != 0 && getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+            rlim_t old_limit = rl.rlim_cur;
+            rl.rlim_cur = rl.rlim_max;
+            if (setrlimit(RLIMIT_NOFILE, &rl) == 0) {
+                fd_limit = rl.rlim_cur == RLIM_INFINITY ? 0 : static_cast<size_t>(rl.rlim_cur);
+                reason = "raised RLIMIT_NOFILE from " + std::to_string(old_limit) + ", ";
+            }
+        }
+#endif
+        if (fd_limit == 0) {
+            config.max_connections = 100000;
+            reason += "no fd limit, capped at 100000";
+        } else if (fd_limit > reserve + 1) {
+            config.max_connections = std::min<size_t>(100000, fd_limit - reserve);
+            reason += "fd limit " + std::to_string(fd_limit) + " minus " + std::to_string(reserve) + " reserved";
+        } else {
+            config.max_connections = 1;
+            reason += "fd limit " + std::to_string(fd_limit) + " leaves no room for clients";
+        }
+        report("max_connections", config.max_connections, reason);
+    }
+
+    // Socket 缓冲区：每个连接收发各 buffer_size * 2（见 optimize_socket），满连接时总量
+    // 不超过内存的 1/8；取 2 的幂，介于 16KB 与 256KB 之间
+    if (params & BUFFER_SIZE) {
+        size_t memory = hw.total_memory ? hw.total_memory : (4ull << 30);
+        size_t per_connection = memory / 8 / (std::max<size_t>(1, config.max_connections) * 4);
+        config.buffer_size = std::min<size_t>(256 << 10, std::max<size_t>(16 << 10, round_down_pow2(per_connection)));
+        report("buffer_size", config.buffer_size,
+               std::to_string(memory >> 20) + " MB memory / 8 across " + std::to_string(config.max_connections) +
+               " connections" + (hw.total_memory ? "" : " (memory assumed)"));
+    }
+}
+
+double AutoTune::measure(size_t threads, size_t shards, size_t buckets) {
+    // 与 DataStore 相同的布局：每个条带一把读写锁和一个哈希表，按缓存行对齐
+    struct alignas(64) Stripe {
+        std::shared_mutex mutex;
+        std::unordered_map<uint64_t, uint64_t> map;
+    };
+    constexpr uint64_t KEYSPACE = 1 << 16;
+    const size_t stripe_count = shards * buckets;
+    std::vector<Stripe> stripes(stripe_count);
+    // 预填充与压测必须用同一个映射，否则查找全部落空，测到的只是空表的开销
+    auto stripe_of = [&](uint64_t key) -> Stripe& {
+        return stripes[(key * 0x9E3779B97F4A7C15ull >> 32) % stripe_count];
+    };
+    for (uint64_t key = 0; key < KEYSPACE; ++key) {
+        stripe_of(key).map[key] = key;
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> checksum{0};   // 保留读取结果，避免查找被优化掉
+    std::vector<std::thread> runners;
+    for (size_t t = 0; t < threads; ++t) {
+        runners.emplace_back([&, seed = t * 0x9E3779B97F4A7C15ull + 1] {
+            uint64_t x = seed;
+            uint64_t ops = 0;
+            uint64_t sink = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 256; ++i) {
+                    x ^= x << 13;
+                    x ^= x >> 7;
+                    x ^= x << 17;
+                    uint64_t key = x % KEYSPACE;
+                    Stripe& stripe = stripe_of(key);
+                    if ((x >> 40) % 10 == 0) {
+                        std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+                        stripe.map[key] = x;
+                    } else {
+                        std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+                        auto it = stripe.map.find(key);
+                        if (it != stripe.map.end()) sink += it->second;
+                    }
+                }
+                ops += 256;
+            }
+            total.fetch_add(ops, std::memory_order_relaxed);
+            checksum.fetch_xor(sink, std::memory_order_relaxed);
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& runner : runners) runner.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total.load(std::memory_order_relaxed) / seconds;
+}
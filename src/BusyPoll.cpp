@@ -0,0 +1,86 @@
+#include "BusyPoll.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+
+BusyPoll::BusyPoll(const Options& options)
+    : options_(options)
+    , min_window_us_(std::max<uint32_t>(1, options.window_us / 16))
+    , window_us_(std::max<uint32_t>(1, options.window_us)) {}
+
+int BusyPoll::timeout_ms(uint64_t now_us, int blocking_ms) {
+    if (!spinning_) {
+        return blocking_ms;
+    }
+    if (now_us < spin_deadline_us_) {
+        return 0;
+    }
+    // 窗口空转到期：负载不足以让自旋划算，缩小窗口后回到阻塞等待
+    spinning_ = false;
+    spin_end_us_ = now_us;
+    single_writer_add(spin_timeouts_);
+    single_writer_add(spin_us_, now_us - spin_start_us_);
+    window_us_.store(std::max(min_window_us_, window_us_.load(std::memory_order_relaxed) / 2),
+                     std::memory_order_relaxed);
+    return blocking_ms;
+}
+
+void BusyPoll::on_wait(uint64_t now_us, int events, int timeout_ms) {
+    if (events <= 0) {
+        return;
+    }
+    uint32_t window = window_us_.load(std::memory_order_relaxed);
+    if (timeout_ms == 0 && spinning_) {
+        single_writer_add(spin_wakeups_);
+        single_writer_add(spin_us_, now_us - spin_start_us_);
+        spinning_ = false;
+        window = std::max(window, std::min(options_.window_us, window * 2));
+    } else {
+        single_writer_add(blocking_wakeups_);
+        // 刚放弃自旋不久事件就到了：窗口再长一点就能省下这次唤醒
+        if (spin_end_us_ > 0 && now_us - spin_end_us_ <= window) {
+            window = std::min(options_.window_us, window * 2);
+        }
+    }
+    window_us_.store(window, std::memory_order_relaxed);
+}
+
+void BusyPoll::on_processed(uint64_t now_us) {
+    spinning_ = true;
+    spin_start_us_ = now_us;
+    spin_deadline_us_ = now_us + window_us_.load(std::memory_order_relaxed);
+}
+
+void BusyPoll::configure_socket(int fd) const {
+    if (!options_.enabled || options_.socket_busy_poll_us == 0) {
+        return;
+    }
+#ifdef SO_BUSY_POLL
+    int busy_poll = static_cast<int>(options_.socket_busy_poll_us);
+    if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll, sizeof(busy_poll)) < 0) {
+        // 超过 net.core.busy_read 的取值需要 CAP_NET_ADMIN；只提示一次
+        static std::atomic<bool> warned{false};
+        if (!warned.exchange(true)) {
+            LOG_WARN("SO_BUSY_POLL not applied: %s", strerror(errno));
+        }
+        return;
+    }
+#endif
+#ifdef SO_PREFER_BUSY_POLL
+    int prefer = 1;
+    setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer));
+#endif
+    (void)fd;
+}
+
+BusyPoll::Stats BusyPoll::stats() const {
+    Stats stats;
+    stats.spin_wakeups = spin_wakeups_.load(std::memory_order_relaxed);
+    stats.blocking_wakeups = blocking_wakeups_.load(std::memory_order_relaxed);
+    stats.spin_timeouts = spin_timeouts_.load(std::memory_order_relaxed);
+    stats.spin_us = spin_us_.load(std::memory_order_relaxed);
+    stats.window_us = window_us_.load(std::memory_order_relaxed);
+    return stats;
+}
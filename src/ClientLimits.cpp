@@ -0,0 +1,62 @@
+#include "ClientLimits.h"
+#include "ConfigRegistry.h"
+#include <fnmatch.h>
+#include <sstream>
+
+bool ClientLimits::parse_rule(const std::string& spec, RateRule& rule, std::string& error) {
+    std::istringstream iss(spec);
+    std::string target;
+    iss >> target;
+    if (target.compare(0, 5, "name:") == 0) {
+        rule.match_name = true;
+        rule.pattern = target.substr(5);
+    } else if (target.compare(0, 5, "addr:") == 0) {
+        rule.match_name = false;
+        rule.pattern = target.substr(5);
+    } else {
+        error = "rate limit rule must start with name:<pattern> or addr:<pattern>: " + spec;
+        return false;
+    }
+    if (rule.pattern.empty()) {
+        error = "empty pattern in rate limit rule: " + spec;
+        return false;
+    }
+
+    for (std::string item; iss >> item;) {
+        auto eq = item.find('=');
+        std::string key = item.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : item.substr(eq + 1);
+        // 与配置项同一套数字解析（带溢出检查）；命令数不接受单位
+        unsigned long long amount = 0;
+        if (key == "commands" && ConfigRegistry::parse_number(value, false, amount)) {
+            rule.commands_per_sec = static_cast<double>(amount);
+        } else if (key == "bytes" && ConfigRegistry::parse_number(value, true, amount)) {
+            rule.bytes_per_sec = static_cast<double>(amount);
+        } else {
+            error = "invalid item '" + item + "' in rate limit rule: " + spec;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string ClientLimits::format_rule(const RateRule& rule) {
+    std::string spec = (rule.match_name ? "name:" : "addr:") + rule.pattern;
+    if (rule.commands_per_sec > 0) {
+        spec += " commands=" + std::to_string(static_cast<uint64_t>(rule.commands_per_sec));
+    }
+    if (rule.bytes_per_sec > 0) {
+        spec += " bytes=" + std::to_string(static_cast<uint64_t>(rule.bytes_per_sec));
+    }
+    return spec;
+}
+
+const ClientLimits::RateRule* ClientLimits::match(const std::string& name, const std::string& addr) const {
+    for (const auto& rule : rate_rules) {
+        const std::string& subject = rule.match_name ? name : addr;
+        if (!subject.empty() && fnmatch(rule.pattern.c_str(), subject.c_str(), 0) == 0) {
+            return &rule;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,107 @@
+#include "Clock.h"
+#include "Logger.h"
+#include <fstream>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CLOCK_HAS_TSC 1
+#else
+#define CLOCK_HAS_TSC 0
+#endif
+
+namespace {
+    // 进程时间起点
+    const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+    uint64_t steady_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - g_epoch).count();
+    }
+
+    // 只有 CPU 声明了不变 TSC（不随频率/C-state 变化）时才使用 rdtsc
+    bool tsc_is_invariant() {
+#if CLOCK_HAS_TSC
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.compare(0, 5, "flags") == 0) {
+                return line.find(" constant_tsc") != std::string::npos &&
+                       line.find(" nonstop_tsc") != std::string::npos;
+            }
+        }
+#endif
+        return false;
+    }
+}
+
+Clock& Clock::instance() {
+    static Clock clock;
+    return clock;
+}
+
+Clock::Clock() = default;
+
+Clock::~Clock() {
+    stop();
+}
+
+void Clock::start(const Options& options) {
+    if (running_.exchange(true)) return;
+
+    calibrate(options.calibration_time);
+
+    coarse_ms_.store(precise_ms(), std::memory_order_relaxed);
+    ticking_.store(true, std::memory_order_release);
+    tick_thread_ = std::thread(&Clock::tick_loop, this, options.tick_interval);
+}
+
+void Clock::stop() {
+    if (!running_.exchange(false)) return;
+    ticking_.store(false, std::memory_order_release);
+    if (tick_thread_.joinable()) {
+        tick_thread_.join();
+    }
+}
+
+uint64_t Clock::precise_ms() {
+    return steady_ns() / 1000000;
+}
+
+uint64_t Clock::ticks() {
+#if CLOCK_HAS_TSC
+    if (use_tsc_) {
+        return __rdtsc();
+    }
+#endif
+    return steady_ns();
+}
+
+void Clock::tick_loop(std::chrono::milliseconds interval) {
+    while (running_.load(std::memory_order_relaxed)) {
+        coarse_ms_.store(precise_ms(), std::memory_order_relaxed);
+        std::this_thread::sleep_for(interval);
+    }
+}
+
+void Clock::calibrate(std::chrono::milliseconds duration) {
+#if CLOCK_HAS_TSC
+    if (!tsc_is_invariant()) {
+        LOG_INFO("Clock: invariant TSC not available, using steady_clock for latency measurement");
+        return;
+    }
+
+    uint64_t ns_begin = steady_ns();
+    uint64_t tsc_begin = __rdtsc();
+    std::this_thread::sleep_for(duration);
+    uint64_t ns_end = steady_ns();
+    uint64_t tsc_end = __rdtsc();
+
+    if (ns_end <= ns_begin || tsc_end <= tsc_begin) return;
+
+    us_per_tick_ = (ns_end - ns_begin) / 1000.0 / (tsc_end - tsc_begin);
+    use_tsc_ = true;
+    LOG_INFO("Clock: using TSC at %.1f MHz for latency measurement", 1.0 / us_per_tick_);
+#else
+    (void)duration;
+#endif
+}
@@ -0,0 +1,250 @@
+#include "CommandCapture.h"
+#include "TraceFormat.h"
+#include "Clock.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+    constexpr size_t FRAME_HEADER_SIZE = 8;  // len u32 + session u32
+
+    size_t round_up_pow2(size_t v) {
+        size_t p = 1;
+        while (p < v) p <<= 1;
+        return p;
+    }
+
+    // 连接ID打散后再取模，避免连续ID集中在同一个采样余数上
+    uint64_t mix(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+}
+
+// ByteRing实现
+CommandCapture::ByteRing::ByteRing(size_t capacity)
+    : mask(round_up_pow2(std::max<size_t>(capacity, 4096)) - 1)
+    , data(std::make_unique<char[]>(mask + 1)) {
+}
+
+void CommandCapture::ByteRing::copy_in(size_t pos, const void* src, size_t len) {
+    size_t offset = pos & mask;
+    size_t first = std::min(len, mask + 1 - offset);
+    std::memcpy(data.get() + offset, src, first);
+    std::memcpy(data.get(), static_cast<const char*>(src) + first, len - first);
+}
+
+void CommandCapture::ByteRing::copy_out(size_t pos, char* dst, size_t len) const {
+    size_t offset = pos & mask;
+    size_t first = std::min(len, mask + 1 - offset);
+    std::memcpy(dst, data.get() + offset, first);
+    std::memcpy(dst + first, data.get(), len - first);
+}
+
+bool CommandCapture::ByteRing::push(uint32_t session, const std::string& payload) {
+    size_t need = FRAME_HEADER_SIZE + payload.size();
+    size_t h = head.load(std::memory_order_relaxed);
+    if (need > mask + 1 - (h - tail.load(std::memory_order_acquire))) {
+        return false;  // 空间不足
+    }
+    uint32_t header[2] = {static_cast<uint32_t>(payload.size()), session};
+    copy_in(h, header, FRAME_HEADER_SIZE);
+    copy_in(h + FRAME_HEADER_SIZE, payload.data(), payload.size());
+    head.store(h + need, std::memory_order_release);
+    return true;
+}
+
+void CommandCapture::ByteRing::drain(std::string& out) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t h = head.load(std::memory_order_acquire);
+    if (t == h) return;
+    size_t old_size = out.size();
+    out.resize(old_size + (h - t));
+    copy_out(t, &out[old_size], h - t);
+    tail.store(h, std::memory_order_release);
+}
+
+// CommandCapture实现
+CommandCapture& CommandCapture::instance() {
+    static CommandCapture capture;
+    return capture;
+}
+
+CommandCapture::~CommandCapture() {
+    stop();
+}
+
+void CommandCapture::set_directory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    directory_ = directory;
+}
+
+bool CommandCapture::start(const Options& options, std::string& error) {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    if (active_.load()) {
+        error = "capture already running";
+        return false;
+    }
+    // 上一次会话可能因达到大小上限自行结束
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+    close_file();
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    std::string path = (std::filesystem::path(directory_) / options.file_name).string();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    uint64_t start_unix_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string header = trace::encode_header(start_unix_us);
+    std::fwrite(header.data(), 1, header.size(), file_);
+
+    options_ = options;
+    path_ = path;
+    records_.store(0);
+    dropped_.store(0);
+    bytes_written_.store(header.size());
+    sample_rate_.store(std::max<uint32_t>(1, options.sample_rate));
+    ring_capacity_.store(options.ring_capacity);
+    start_ticks_.store(Clock::ticks());
+    session_.fetch_add(1);
+
+    writer_running_ = true;
+    writer_thread_ = std::thread(&CommandCapture::writer_loop, this);
+    active_.store(true);
+
+    LOG_INFO("Command capture started: %s (sample 1/%u connections)", path_.c_str(), sample_rate_.load());
+    return true;
+}
+
+void CommandCapture::stop() {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    active_.store(false);
+    writer_running_ = false;
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+    if (file_) {
+        LOG_INFO("Command capture stopped: %lu records, %lu dropped, %lu bytes written to %s",
+                 static_cast<unsigned long>(records_.load()), static_cast<unsigned long>(dropped_.load()),
+                 static_cast<unsigned long>(bytes_written_.load()), path_.c_str());
+    }
+    close_file();
+}
+
+void CommandCapture::close_file() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+CommandCapture::Status CommandCapture::status() const {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    Status status;
+    status.active = active_.load();
+    status.path = path_;
+    status.sample_rate = sample_rate_.load();
+    status.records = records_.load();
+    status.dropped = dropped_.load();
+    status.bytes_written = bytes_written_.load();
+    return status;
+}
+
+void CommandCapture::record(uint64_t connection_id, const std::vector<std::string>& args) {
+    if (!active_.load(std::memory_order_relaxed)) return;
+
+    uint32_t rate = sample_rate_.load(std::memory_order_relaxed);
+    if (rate > 1 && mix(connection_id) % rate != 0) return;
+
+    thread_local std::string payload;
+    payload.clear();
+    uint64_t elapsed = Clock::ticks() - start_ticks_.load(std::memory_order_relaxed);
+    trace::encode_record(payload, static_cast<uint64_t>(Clock::ticks_to_us(elapsed)), connection_id, args);
+
+    if (!local_ring()->push(session_.load(std::memory_order_relaxed), payload)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+CommandCapture::ByteRing* CommandCapture::local_ring() {
+    // 线程退出时标记缓冲区为已退役，由写出线程在排空后回收
+    struct Holder {
+        std::shared_ptr<ByteRing> ring;
+        ~Holder() {
+            if (ring) ring->retired.store(true, std::memory_order_release);
+        }
+    };
+    thread_local Holder holder;
+
+    if (!holder.ring) {
+        holder.ring = std::make_shared<ByteRing>(ring_capacity_.load(std::memory_order_relaxed));
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.push_back(holder.ring);
+    }
+    return holder.ring.get();
+}
+
+void CommandCapture::writer_loop() {
+    std::string scratch;
+    scratch.reserve(1024 * 1024);
+    while (writer_running_.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(options_.flush_interval);
+        flush_rings(scratch);
+
+        if (options_.max_bytes > 0 && bytes_written_.load(std::memory_order_relaxed) >= options_.max_bytes) {
+            active_.store(false);
+            LOG_WARN("Command capture reached size limit (%lu bytes), stopping",
+                     static_cast<unsigned long>(options_.max_bytes));
+            break;
+        }
+    }
+    // 排空剩余记录
+    flush_rings(scratch);
+    std::fflush(file_);
+}
+
+void CommandCapture::flush_rings(std::string& scratch) {
+    std::vector<std::shared_ptr<ByteRing>> rings;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<ByteRing>& ring) {
+            return ring->retired.load(std::memory_order_acquire) &&
+                   ring->tail.load(std::memory_order_relaxed) == ring->head.load(std::memory_order_acquire);
+        }), rings_.end());
+        rings = rings_;
+    }
+
+    uint32_t session = session_.load(std::memory_order_relaxed);
+    for (auto& ring : rings) {
+        scratch.clear();
+        ring->drain(scratch);
+
+        size_t pos = 0;
+        while (pos + FRAME_HEADER_SIZE <= scratch.size()) {
+            uint32_t header[2];
+            std::memcpy(header, scratch.data() + pos, FRAME_HEADER_SIZE);
+            pos += FRAME_HEADER_SIZE;
+
+            // 丢弃上一次会话残留的帧；达到大小上限后不再写入
+            bool within_limit = options_.max_bytes == 0 ||
+                                bytes_written_.load(std::memory_order_relaxed) < options_.max_bytes;
+            if (header[1] == session && within_limit) {
+                std::fwrite(scratch.data() + pos, 1, header[0], file_);
+                records_.fetch_add(1, std::memory_order_relaxed);
+                bytes_written_.fetch_add(header[0], std::memory_order_relaxed);
+            }
+            pos += header[0];
+        }
+    }
+}
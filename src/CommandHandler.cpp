@@ -1,26 +1,102 @@
 #include "CommandHandler.h"
+#include "LatencyMonitor.h"
+#include "Clock.h"
+#include "CommandCapture.h"
 #include <chrono>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <ctime>
+#include <strings.h>
 
-CommandHandler::CommandHandler(std::shared_ptr<DataStore> store) 
-    : store_(store ? store : std::make_shared<DataStore>()) {
+CommandHandler::CommandHandler(std::shared_ptr<DataStore> store,
+                               const HotKeyTracker::Options& hotkey_options)
+    : store_(store ? store : std::make_shared<DataStore>())
+    , hotkeys_(hotkey_options)
+    , id_([] {
+        static std::atomic<uint64_t> next_id{1};
+        return next_id.fetch_add(1, std::memory_order_relaxed);
+      }())
+    , modules_(store_) {
     init_handlers();
 }
 
 void CommandHandler::init_handlers() {
     // 初始化命令处理函数映射
-    cmd_handlers_["set"] = [this](const auto& args) { return handle_set(args); };
-    cmd_handlers_["get"] = [this](const auto& args) { return handle_get(args); };
-    cmd_handlers_["del"] = [this](const auto& args) { return handle_del(args); };
-    cmd_handlers_["mset"] = [this](const auto& args) { return handle_mset(args); };
-    cmd_handlers_["mget"] = [this](const auto& args) { return handle_mget(args); };
-    cmd_handlers_["info"] = [this](const auto& args) { return handle_info(args); };
+    register_command("set", [this](const auto& args, ReplyBuilder& reply) { handle_set(args, reply); });
+    register_command("get", [this](const auto& args, ReplyBuilder& reply) { handle_get(args, reply); });
+    register_command("del", [this](const auto& args, ReplyBuilder& reply) { handle_del(args, reply); });
+    register_command("unlink", [this](const auto& args, ReplyBuilder& reply) { handle_unlink(args, reply); });
+    register_command("flushall", [this](const auto& args, ReplyBuilder& reply) { handle_flushall(args, reply); }, CMD_SLOW);
+    register_command("flushdb", [this](const auto& args, ReplyBuilder& reply) { handle_flushall(args, reply); }, CMD_SLOW);
+    register_command("mset", [this](const auto& args, ReplyBuilder& reply) { handle_mset(args, reply); });
+    register_command("mget", [this](const auto& args, ReplyBuilder& reply) { handle_mget(args, reply); }, CMD_SLOW, 65);
+    register_command("keys", [this](const auto& args, ReplyBuilder& reply) { handle_keys(args, reply); }, CMD_SLOW);
+    register_command("info", [this](const auto& args, ReplyBuilder& reply) { handle_info(args, reply); }, CMD_ADMIN);
+    register_command("hotkeys", [this](const auto& args, ReplyBuilder& reply) { handle_hotkeys(args, reply); }, CMD_ADMIN);
+    register_command("latency", [this](const auto& args, ReplyBuilder& reply) { handle_latency(args, reply); }, CMD_ADMIN);
+    register_command("capture", [this](const auto& args, ReplyBuilder& reply) { handle_capture(args, reply); }, CMD_ADMIN);
+    register_command("module", [this](const auto& args, ReplyBuilder& reply) { handle_module(args, reply); }, CMD_ADMIN);
+    register_command("config", [this](const auto& args, ReplyBuilder& reply) { handle_config(args, reply); }, CMD_ADMIN);
+    set_stats_index_ = cmd_handlers_["set"].stats_index;
+}
+
+void CommandHandler::load_module(const std::string& spec) {
+    auto commands = modules_.load(spec, [this](const std::string& name) {
+        return cmd_handlers_.count(name) > 0;
+    });
+    for (auto& command : commands) {
+        // 模块回调构造的是完整的 RESP 字符串，整段追加
+        register_command(command.name, [func = std::move(command.func)](const auto& args, ReplyBuilder& reply) {
+            reply.raw(func(args));
+        });
+    }
+}
+
+void CommandHandler::register_command(const std::string& name, CommandFunc func,
+                                      uint32_t flags, size_t slow_min_args) {
+    size_t index = cmd_metrics_.register_command(name);
+    cmd_handlers_[name] = CommandEntry{std::move(func), index, flags, slow_min_args};
+    if (flags & CMD_SLOW) {
+        slow_commands_.emplace_back(name, slow_min_args);
+    }
+}
+
+uint32_t CommandHandler::command_flags(const std::vector<std::string>& cmd) const {
+    if (cmd.empty()) {
+        return 0;
+    }
+    std::string name = cmd[0];
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    auto it = cmd_handlers_.find(name);
+    return it == cmd_handlers_.end() ? 0 : it->second.flags;
+}
+
+bool CommandHandler::is_slow(const std::vector<std::string>& cmd) const {
+    if (cmd.empty()) {
+        return false;
+    }
+    const std::string& name = cmd[0];
+    for (const auto& [slow_name, min_args] : slow_commands_) {
+        if (cmd.size() >= min_args && name.size() == slow_name.size() &&
+            strncasecmp(name.data(), slow_name.data(), name.size()) == 0) {
+            return true;
+        }
+    }
+    return false;
 }
 
 std::string CommandHandler::handle(const std::vector<std::string>& cmd) {
+    std::string response;
+    ReplyBuilder reply(response);
+    handle(cmd, reply);
+    return response;
+}
+
+void CommandHandler::handle(const std::vector<std::string>& cmd, ReplyBuilder& reply) {
     if (cmd.empty()) {
-        return "-ERR empty command\r\n";
+        reply.error("ERR empty command");
+        return;
     }
 
     // 获取命令名称并转换为小写（优化：避免字符串拷贝）
@@ -35,140 +111,537 @@ std::string CommandHandler::handle(const std::vector<std::string>& cmd) {
     // 查找命令处理函数
     auto it = cmd_handlers_.find(cmd_name);
     if (it == cmd_handlers_.end()) {
-        // 优化错误消息构造
-        std::string error_msg;
-        error_msg.reserve(30 + cmd_name.size());
-        error_msg = "-ERR unknown command '";
-        error_msg += cmd_name;
-        error_msg += "'\r\n";
-        return error_msg;
+        reply.raw("-ERR unknown command '");
+        reply.raw(cmd_name);
+        reply.raw("'\r\n");
+        return;
     }
 
-    // 记录开始时间
-    auto start = std::chrono::high_resolution_clock::now();
+    // 记录开始时间（校准后的TSC，比 clock::now() 开销小）
+    uint64_t start = Clock::ticks();
 
-    // 执行命令
-    std::string result = it->second(cmd);
+    // 执行命令：回复直接写入调用方的输出缓冲区
+    it->second.func(cmd, reply);
 
     // 计算执行时间并更新统计
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-    update_command_stats(cmd_name, duration);
+    auto duration = static_cast<uint64_t>(Clock::ticks_to_us(Clock::ticks() - start));
+    cmd_metrics_.record(it->second.stats_index, duration);
 
-    return result;
+    // 慢命令计入延迟监控（阈值为毫秒级，绝大多数命令在此处直接返回）
+    auto& latency_monitor = LatencyMonitor::instance();
+    if (latency_monitor.enabled() && duration >= latency_monitor.threshold_ms() * 1000) {
+        latency_monitor.add_sample_if_needed("command", duration / 1000, "last slow command: " + cmd_name);
+    }
 }
 
-// 移除未使用的 handle_pipeline / handle_transaction
-
-void CommandHandler::update_command_stats(const std::string& cmd_name, uint64_t execution_time) {
-    auto& stats = cmd_stats_[cmd_name];
-    stats.calls++;
-    stats.total_time += execution_time;
-    stats.max_time = std::max(stats.max_time, execution_time);
-    stats.min_time = std::min(stats.min_time, execution_time);
+size_t CommandHandler::handle_set_run(const std::vector<std::vector<std::string>>& commands, size_t begin,
+                                      ReplyBuilder& reply) {
+    auto is_plain_set = [](const std::vector<std::string>& cmd) {
+        return cmd.size() == 3 && cmd[0].size() == 3 && strncasecmp(cmd[0].data(), "set", 3) == 0;
+    };
+    size_t end = begin;
+    size_t limit = begin + max_set_run_.load(std::memory_order_relaxed);
+    while (end < commands.size() && end < limit && is_plain_set(commands[end])) {
+        ++end;
+    }
+    size_t count = end - begin;
+    if (count < 2) {
+        return 0;
+    }
+    
+    uint64_t start = Clock::ticks();
+    
+    // 每个线程复用同一个数组，稳定后不再分配
+    thread_local AdaptiveCache::KeyValueRefs items;
+    items.clear();
+    for (size_t i = begin; i < end; ++i) {
+        hotkeys_.record(commands[i][1]);
+        items.emplace_back(&commands[i][1], &commands[i][2]);
+    }
+    store_->set_batch(items);
+    for (size_t i = 0; i < count; ++i) {
+        reply.ok();
+    }
+    
+    // 总耗时平摊到每条命令
+    auto duration = static_cast<uint64_t>(Clock::ticks_to_us(Clock::ticks() - start));
+    for (size_t i = 0; i < count; ++i) {
+        cmd_metrics_.record(set_stats_index_, duration / count);
+    }
+    auto& latency_monitor = LatencyMonitor::instance();
+    if (latency_monitor.enabled() && duration >= latency_monitor.threshold_ms() * 1000) {
+        latency_monitor.add_sample_if_needed("command", duration / 1000,
+                                             "last slow command: set (" + std::to_string(count) + " pipelined)");
+    }
+    return count;
 }
 
+// 移除未使用的 handle_pipeline / handle_transaction
+
 // 命令处理函数实现
-std::string CommandHandler::handle_set(const std::vector<std::string>& args) {
+void CommandHandler::handle_set(const std::vector<std::string>& args, ReplyBuilder& reply) {
     if (args.size() != 3) {
-        return "-ERR wrong number of arguments for 'set' command\r\n";
+        reply.error("ERR wrong number of arguments for 'set' command");
+        return;
     }
+    hotkeys_.record(args[1]);
     store_->set(args[1], args[2]);
-    return "+OK\r\n";
+    reply.ok();
 }
 
-std::string CommandHandler::handle_get(const std::vector<std::string>& args) {
+void CommandHandler::handle_get(const std::vector<std::string>& args, ReplyBuilder& reply) {
     if (args.size() != 2) {
-        return "-ERR wrong number of arguments for 'get' command\r\n";
+        reply.error("ERR wrong number of arguments for 'get' command");
+        return;
     }
-    auto value = store_->get(args[1]);
-    if (!value) {
-        return "$-1\r\n";
+    reply_value(args[1], reply);
+}
+
+void CommandHandler::reply_value(const std::string& key, ReplyBuilder& reply) {
+    bool hot = hotkeys_.record(key);
+    // 值读入按线程复用的缓冲区，命中路径不分配内存
+    thread_local std::string value;
+    
+    size_t near_capacity = near_cache_capacity_.load(std::memory_order_relaxed);
+    if (near_capacity > 0) {
+        NearCache& near = local_near_cache(near_capacity);
+        if (const std::string* cached = near.find(key)) {
+            reply.bulk(*cached);
+            return;
+        }
+        if (hot) {
+            if (near.admit(key, *store_, value)) {
+                reply.bulk(value);
+            } else {
+                reply.nil();
+            }
+            return;
+        }
     }
     
-    // 优化响应构造，减少字符串拼接
-    std::string response;
-    response.reserve(value->size() + 20); // 预分配足够空间
-    response = "$";
-    response += std::to_string(value->size());
-    response += "\r\n";
-    response += *value;
-    response += "\r\n";
-    return response;
+    if (!store_->get_into(key, value)) {
+        reply.nil();
+        return;
+    }
+    reply.bulk(value);
+}
+
+NearCache& CommandHandler::local_near_cache(size_t capacity) {
+    // 每个线程按处理器实例ID保存注册（同 HotKeyTracker），
+    // 多个处理器在同一线程交替使用时各自复用已注册的缓存
+    thread_local std::vector<std::pair<uint64_t, NearCache*>> caches;
+    NearCache* cache = nullptr;
+    for (const auto& entry : caches) {
+        if (entry.first == id_) {
+            cache = entry.second;
+            break;
+        }
+    }
+    if (!cache) {
+        // 首次在本线程使用：注册一个新的线程本地近端缓存
+        auto owned = std::make_unique<NearCache>(capacity);
+        cache = owned.get();
+        caches.emplace_back(id_, cache);
+        std::lock_guard<std::mutex> lock(near_caches_mutex_);
+        near_caches_.push_back(std::move(owned));
+    } else if (cache->capacity() != capacity) {
+        cache->set_capacity(capacity);
+    }
+    return *cache;
 }
 
-std::string CommandHandler::handle_del(const std::vector<std::string>& args) {
+NearCache::Stats CommandHandler::get_near_cache_stats() {
+    NearCache::Stats total;
+    std::lock_guard<std::mutex> lock(near_caches_mutex_);
+    for (const auto& cache : near_caches_) {
+        auto stats = cache->stats();
+        total.hits += stats.hits;
+        total.invalidations += stats.invalidations;
+        total.admissions += stats.admissions;
+        total.entries += stats.entries;
+    }
+    return total;
+}
+
+void CommandHandler::handle_del(const std::vector<std::string>& args, ReplyBuilder& reply) {
     if (args.size() != 2) {
-        return "-ERR wrong number of arguments for 'del' command\r\n";
+        reply.error("ERR wrong number of arguments for 'del' command");
+        return;
+    }
+    hotkeys_.record(args[1]);
+    reply.boolean(store_->del(args[1]));
+}
+
+void CommandHandler::handle_unlink(const std::vector<std::string>& args, ReplyBuilder& reply) {
+    if (args.size() < 2) {
+        reply.error("ERR wrong number of arguments for 'unlink' command");
+        return;
+    }
+    size_t removed = 0;
+    for (size_t i = 1; i < args.size(); ++i) {
+        hotkeys_.record(args[i]);
+        if (store_->unlink(args[i])) {
+            removed++;
+        }
     }
-    bool success = store_->del(args[1]);
-    return ":" + std::to_string(success ? 1 : 0) + "\r\n";
+    reply.integer(static_cast<int64_t>(removed));
 }
 
-std::string CommandHandler::handle_mset(const std::vector<std::string>& args) {
+// FLUSHALL / FLUSHDB [ASYNC|SYNC]：只有一个库，两者等价；默认同步
+void CommandHandler::handle_flushall(const std::vector<std::string>& args, ReplyBuilder& reply) {
+    bool async = false;
+    if (args.size() == 2) {
+        std::string mode = args[1];
+        std::transform(mode.begin(), mode.end(), mode.begin(), ::tolower);
+        if (mode == "async") {
+            async = true;
+        } else if (mode != "sync") {
+            reply.error("ERR syntax error");
+            return;
+        }
+    } else if (args.size() > 2) {
+        reply.error("ERR syntax error");
+        return;
+    }
+    store_->flush_all(async);
+    reply.ok();
+}
+
+void CommandHandler::handle_mset(const std::vector<std::string>& args, ReplyBuilder& reply) {
     if (args.size() < 3 || args.size() % 2 != 1) {
-        return "-ERR wrong number of arguments for 'mset' command\r\n";
+        reply.error("ERR wrong number of arguments for 'mset' command");
+        return;
     }
     
-    std::vector<std::pair<std::string, std::string>> kvs;
+    AdaptiveCache::KeyValueRefs kvs;
+    kvs.reserve(args.size() / 2);
     for (size_t i = 1; i < args.size(); i += 2) {
-        kvs.emplace_back(args[i], args[i + 1]);
+        hotkeys_.record(args[i]);
+        kvs.emplace_back(&args[i], &args[i + 1]);
     }
+    store_->set_batch(kvs);
     
-    for (const auto& [key, value] : kvs) {
-        store_->set(key, value);
-    }
-    
-    return "+OK\r\n";
+    reply.ok();
 }
 
-std::string CommandHandler::handle_mget(const std::vector<std::string>& args) {
+void CommandHandler::handle_mget(const std::vector<std::string>& args, ReplyBuilder& reply) {
     if (args.size() < 2) {
-        return "-ERR wrong number of arguments for 'mget' command\r\n";
+        reply.error("ERR wrong number of arguments for 'mget' command");
+        return;
     }
     
-    std::vector<std::string> keys(args.begin() + 1, args.end());
-    
-    // 优化响应构造，预分配空间
-    std::string response;
-    response.reserve(keys.size() * 50); // 预估每个键50字节响应
-    
-    response = "*";
-    response += std::to_string(keys.size());
-    response += "\r\n";
-    
+    reply.array(args.size() - 1);
+    for (size_t i = 1; i < args.size(); ++i) {
+        reply_value(args[i], reply);
+    }
+}
+
+void CommandHandler::handle_keys(const std::vector<std::string>& args, ReplyBuilder& reply) {
+    if (args.size() != 2) {
+        reply.error("ERR wrong number of arguments for 'keys' command");
+        return;
+    }
+    auto keys = store_->keys(args[1]);
+    reply.array(keys.size());
     for (const auto& key : keys) {
-        auto value = store_->get(key);
-        if (!value) {
-            response += "$-1\r\n";
-        } else {
-            response += "$";
-            response += std::to_string(value->size());
-            response += "\r\n";
-            response += *value;
-            response += "\r\n";
-        }
+        reply.bulk(key);
     }
-    
-    return response;
 }
 
-std::string CommandHandler::handle_info(const std::vector<std::string>& args) {
+void CommandHandler::handle_info(const std::vector<std::string>& args, ReplyBuilder& reply) {
+    (void)args;  // 不区分 section，总是返回全部信息
     std::stringstream ss;
-    ss << "$" << 1024 << "\r\n";  // 预估响应大小
     
     // 命令统计信息
     ss << "# Commands\r\n";
-    for (const auto& [cmd, stats] : cmd_stats_) {
+    for (const auto& stats : cmd_metrics_.snapshot()) {
+        const auto& cmd = stats.name;
         ss << cmd << "_calls:" << stats.calls << "\r\n";
         if (stats.calls > 0) {
-            double avg_time = static_cast<double>(stats.total_time) / stats.calls;
+            double avg_time = static_cast<double>(stats.total_time_us) / stats.calls;
             ss << cmd << "_avg_time:" << std::fixed << std::setprecision(3) << avg_time << "us\r\n";
-            ss << cmd << "_min_time:" << stats.min_time << "us\r\n";
-            ss << cmd << "_max_time:" << stats.max_time << "us\r\n";
+            ss << cmd << "_min_time:" << stats.min_time_us << "us\r\n";
+            ss << cmd << "_max_time:" << stats.max_time_us << "us\r\n";
         }
     }
     
-    ss << "\r\n";
-    return ss.str();
+    auto lazyfree = store_->get_lazyfree_stats();
+    ss << "# Lazyfree\r\n";
+    ss << "lazyfree_pending_objects:" << lazyfree.pending << "\r\n";
+    ss << "lazyfreed_objects:" << lazyfree.freed << "\r\n";
+    
+    auto near = get_near_cache_stats();
+    ss << "# Nearcache\r\n";
+    ss << "near_cache_entries_per_thread:" << near_cache_capacity_.load(std::memory_order_relaxed) << "\r\n";
+    ss << "near_cache_keys:" << near.entries << "\r\n";
+    ss << "near_cache_hits:" << near.hits << "\r\n";
+    ss << "near_cache_admissions:" << near.admissions << "\r\n";
+    ss << "near_cache_invalidations:" << near.invalidations << "\r\n";
+    
+    reply.bulk(ss.str());
+}
+
+// HOTKEYS [COUNT n]
+// 返回最近一个采样窗口内访问最频繁的键：每项为 [key, 估计ops/sec, 估计访问次数, 误差上界]
+void CommandHandler::handle_hotkeys(const std::vector<std::string>& args, ReplyBuilder& reply) {
+    if (!hotkeys_.enabled()) {
+        reply.error("ERR hotkeys tracking is disabled");
+        return;
+    }
+
+    size_t count = 10;
+    if (args.size() == 3) {
+        std::string opt = args[1];
+        std::transform(opt.begin(), opt.end(), opt.begin(), ::tolower);
+        if (opt != "count") {
+            reply.error("ERR syntax error");
+            return;
+        }
+        try {
+            count = std::stoul(args[2]);
+        } catch (...) {
+            reply.error("ERR value is not an integer or out of range");
+            return;
+        }
+    } else if (args.size() != 1) {
+        reply.error("ERR wrong number of arguments for 'hotkeys' command");
+        return;
+    }
+
+    auto hot = hotkeys_.top(count);
+
+    reply.array(hot.size());
+    for (const auto& item : hot) {
+        std::ostringstream rate;
+        rate << std::fixed << std::setprecision(2) << item.ops_per_sec;
+
+        reply.array(4);
+        reply.bulk(item.key);
+        reply.bulk(rate.str());
+        reply.integer(static_cast<int64_t>(item.estimated_accesses));
+        reply.integer(static_cast<int64_t>(item.error));
+    }
+}
+
+// LATENCY LATEST | HISTORY event | RESET [event ...] | DOCTOR
+void CommandHandler::handle_latency(const std::vector<std::string>& args, ReplyBuilder& reply) {
+    if (args.size() < 2) {
+        reply.error("ERR wrong number of arguments for 'latency' command");
+        return;
+    }
+
+    std::string sub = args[1];
+    std::transform(sub.begin(), sub.end(), sub.begin(), ::tolower);
+    auto& monitor = LatencyMonitor::instance();
+
+    if (sub == "latest" && args.size() == 2) {
+        // 每项为 [事件名, 最近发生时间, 最近延迟ms, 最大延迟ms]
+        auto events = monitor.latest();
+        reply.array(events.size());
+        for (const auto& event : events) {
+            reply.array(4);
+            reply.bulk(event.name);
+            reply.integer(static_cast<int64_t>(event.latest.time));
+            reply.integer(static_cast<int64_t>(event.latest.latency_ms));
+            reply.integer(static_cast<int64_t>(event.max_latency_ms));
+        }
+        return;
+    }
+
+    if (sub == "history" && args.size() == 3) {
+        // 每项为 [时间, 延迟ms]
+        auto samples = monitor.history(args[2]);
+        reply.array(samples.size());
+        for (const auto& sample : samples) {
+            reply.array(2);
+            reply.integer(static_cast<int64_t>(sample.time));
+            reply.integer(static_cast<int64_t>(sample.latency_ms));
+        }
+        return;
+    }
+
+    if (sub == "reset") {
+        std::vector<std::string> events(args.begin() + 2, args.end());
+        reply.integer(static_cast<int64_t>(monitor.reset(events)));
+        return;
+    }
+
+    if (sub == "doctor" && args.size() == 2) {
+        reply.bulk(monitor.doctor());
+        return;
+    }
+
+    reply.error("ERR unknown subcommand or wrong number of arguments for 'latency' command");
+}
+
+// CAPTURE START [FILE name] [SAMPLE n] [MAXBYTES n] | STOP | STATUS
+// 追踪文件写入抓取目录（[capture] dir），文件名不能包含路径
+void CommandHandler::handle_capture(const std::vector<std::string>& args, ReplyBuilder& reply) {
+    if (args.size() < 2) {
+        reply.error("ERR wrong number of arguments for 'capture' command");
+        return;
+    }
+
+    std::string sub = args[1];
+    std::transform(sub.begin(), sub.end(), sub.begin(), ::tolower);
+    auto& capture = CommandCapture::instance();
+
+    if (sub == "start") {
+        CommandCapture::Options options;
+        options.file_name = "capture-" + std::to_string(std::time(nullptr)) + ".trace";
+
+        for (size_t i = 2; i < args.size(); i += 2) {
+            if (i + 1 >= args.size()) {
+                reply.error("ERR syntax error");
+                return;
+            }
+            std::string opt = args[i];
+            std::transform(opt.begin(), opt.end(), opt.begin(), ::tolower);
+            try {
+                if (opt == "file") {
+                    options.file_name = args[i + 1];
+                    if (options.file_name.empty() || options.file_name.find('/') != std::string::npos ||
+                        options.file_name == "." || options.file_name == "..") {
+                        reply.error("ERR invalid capture file name");
+                        return;
+                    }
+                } else if (opt == "sample") {
+                    options.sample_rate = static_cast<uint32_t>(std::stoul(args[i + 1]));
+                } else if (opt == "maxbytes") {
+                    options.max_bytes = std::stoull(args[i + 1]);
+                } else {
+                    reply.error("ERR syntax error");
+                    return;
+                }
+            } catch (...) {
+                reply.error("ERR value is not an integer or out of range");
+                return;
+            }
+        }
+
+        std::string error;
+        if (!capture.start(options, error)) {
+            reply.error("ERR " + error);
+            return;
+        }
+        reply.ok();
+        return;
+    }
+
+    if (sub == "stop" && args.size() == 2) {
+        capture.stop();
+        reply.ok();
+        return;
+    }
+
+    if (sub == "status" && args.size() == 2) {
+        auto status = capture.status();
+        std::ostringstream ss;
+        ss << "active:" << (status.active ? 1 : 0) << "\r\n"
+           << "path:" << status.path << "\r\n"
+           << "sample_rate:" << status.sample_rate << "\r\n"
+           << "records:" << status.records << "\r\n"
+           << "dropped:" << status.dropped << "\r\n"
+           << "bytes_written:" << status.bytes_written << "\r\n";
+        reply.bulk(ss.str());
+        return;
+    }
+
+    reply.error("ERR unknown subcommand or wrong number of arguments for 'capture' command");
+}
+
+void CommandHandler::handle_module(const std::vector<std::string>& args, ReplyBuilder& reply) {
+    if (args.size() < 2) {
+        reply.error("ERR wrong number of arguments for 'module' command");
+        return;
+    }
+
+    std::string sub = args[1];
+    std::transform(sub.begin(), sub.end(), sub.begin(), ::tolower);
+
+    if (sub == "list" && args.size() == 2) {
+        auto modules = modules_.list();
+        reply.array(modules.size());
+        for (const auto& module : modules) {
+            reply.array(8);
+            reply.bulk("name");
+            reply.bulk(module.name);
+            reply.bulk("ver");
+            reply.integer(module.version);
+            reply.bulk("path");
+            reply.bulk(module.path);
+            reply.bulk("commands");
+            reply.array(module.commands.size());
+            for (const auto& command : module.commands) {
+                reply.bulk(command);
+            }
+        }
+        return;
+    }
+
+    if (sub == "load" || sub == "unload") {
+        // 命令表运行期间只读，Worker 无锁查表；模块只能通过配置在启动时加载
+        reply.error("ERR modules can only be loaded at startup ([modules] load in config)");
+        return;
+    }
+
+    reply.error("ERR unknown subcommand or wrong number of arguments for 'module' command");
+}
+
+void CommandHandler::handle_config(const std::vector<std::string>& args, ReplyBuilder& reply) {
+    if (args.size() < 2) {
+        reply.error("ERR wrong number of arguments for 'config' command");
+        return;
+    }
+    if (!config_registry_) {
+        reply.error("ERR CONFIG is not available");
+        return;
+    }
+
+    std::string sub = args[1];
+    std::transform(sub.begin(), sub.end(), sub.begin(), ::tolower);
+
+    if (sub == "get" && args.size() >= 3) {
+        // 可同时给出多个模式，结果按参数去重
+        std::vector<std::pair<std::string, std::string>> matched;
+        for (size_t i = 2; i < args.size(); ++i) {
+            for (auto& item : config_registry_->get(args[i])) {
+                bool seen = std::any_of(matched.begin(), matched.end(),
+                                        [&item](const auto& m) { return m.first == item.first; });
+                if (!seen) matched.push_back(std::move(item));
+            }
+        }
+        reply.array(matched.size() * 2);
+        for (const auto& [name, value] : matched) {
+            reply.bulk(name);
+            reply.bulk(value);
+        }
+        return;
+    }
+
+    if (sub == "set" && args.size() >= 4 && args.size() % 2 == 0) {
+        std::vector<std::pair<std::string, std::string>> items;
+        for (size_t i = 2; i + 1 < args.size(); i += 2) {
+            items.emplace_back(args[i], args[i + 1]);
+        }
+        std::string error;
+        if (!config_registry_->set(items, error)) {
+            reply.error("ERR " + error);
+            return;
+        }
+        reply.ok();
+        return;
+    }
+
+    if (sub == "rewrite" && args.size() == 2) {
+        std::string error;
+        if (!config_registry_->rewrite(error)) {
+            reply.error("ERR " + error);
+            return;
+        }
+        reply.ok();
+        return;
+    }
+
+    reply.error("ERR unknown subcommand or wrong number of arguments for 'config' command");
 }
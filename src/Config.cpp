@@ -1,116 +1,258 @@
 #include "Config.h"
-#include <fstream>
+#include "AutoTune.h"
+#include "Logger.h"
 #include <sstream>
-#include <iostream>
 #include <thread>
 #include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <strings.h>
 
 RedisServer::Config Config::load_from_file(const std::string& filename) {
     auto config = get_default_config();
-    
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cout << "Warning: Could not open config file " << filename 
-                  << ", using default configuration" << std::endl;
-        return config;
-    }
-    
-    std::string line, section;
-    while (std::getline(file, line)) {
-        // 去掉注释和空白
-        auto comment_pos = line.find('#');
-        if (comment_pos != std::string::npos) {
-            line = line.substr(0, comment_pos);
-        }
-        
-        // 去掉首尾空白
-        line.erase(0, line.find_first_not_of(" \t\r\n"));
-        line.erase(line.find_last_not_of(" \t\r\n") + 1);
-        
-        if (line.empty()) continue;
-        
-        // 解析section
-        if (line.front() == '[' && line.back() == ']') {
-            section = line.substr(1, line.size() - 2);
-            continue;
-        }
-        
-        // 解析key=value
-        auto eq_pos = line.find('=');
-        if (eq_pos == std::string::npos) continue;
-        
-        std::string key = line.substr(0, eq_pos);
-        std::string value = line.substr(eq_pos + 1);
-        
-        // 去掉key和value的空白
-        key.erase(0, key.find_first_not_of(" \t"));
-        key.erase(key.find_last_not_of(" \t") + 1);
-        value.erase(0, value.find_first_not_of(" \t"));
-        value.erase(value.find_last_not_of(" \t") + 1);
-        
-        // 解析配置
-        if (section == "server") {
-            if (key == "port") config.port = parse_int(value, config.port);
-            else if (key == "host") config.host = value;
-        }
-        else if (section == "threading") {
-            if (key == "worker_threads") config.worker_threads = parse_size_t(value, config.worker_threads);
-            else if (key == "io_threads") config.io_threads = parse_size_t(value, config.io_threads);
-            else if (key == "shard_count") config.shard_count = parse_size_t(value, config.shard_count);
-        }
-        else if (section == "performance") {
-            if (key == "max_connections") config.max_connections = parse_size_t(value, config.max_connections);
-            else if (key == "buffer_size") config.buffer_size = parse_size_t(value, config.buffer_size);
-        }
-        else if (section == "storage") {
-            if (key == "cache_size_mb") config.cache_size_mb = parse_size_t(value, config.cache_size_mb);
-            else if (key == "enable_compression") config.enable_compression = parse_bool(value, config.enable_compression);
-            else if (key == "enable_persistence") config.enable_persistence = parse_bool(value, config.enable_persistence);
-            else if (key == "sync_interval_sec") config.sync_interval_sec = parse_int(value, config.sync_interval_sec);
-        }
-    }
-    
+
+    ConfigRegistry registry;
+    register_parameters(config, registry);
+    registry.load_file(filename);
+    config.config_file = filename;
+
     return config;
 }
 
 RedisServer::Config Config::get_default_config() {
     RedisServer::Config config;
-    
-    // 智能默认值
+
+    // 智能默认值：工作线程数与分片数未配置时按硬件推导（见 AutoTune）
     size_t hw_threads = std::thread::hardware_concurrency();
     if (hw_threads == 0) hw_threads = 4;
-    
-    config.worker_threads = std::min<size_t>(32, hw_threads * 2);  // 限制最大线程数
+
     config.io_threads = std::min<size_t>(8, hw_threads / 2);
-    config.shard_count = 16;  // 固定为16，经验最优值
-    
+    config.auto_params = AutoTune::WORKER_THREADS | AutoTune::SHARD_COUNT;
+
     return config;
 }
 
-int Config::parse_int(const std::string& str, int default_val) {
-    try {
-        return std::stoi(str);
-    } catch (...) {
-        return default_val;
-    }
+namespace {
+
+// 数值参数，另可取 auto：启动时由 AutoTune 推导，CONFIG GET 返回推导后的值
+template <typename T>
+void add_auto(ConfigRegistry& registry, RedisServer::Config& config, const std::string& section,
+              const std::string& key, T& field, AutoTune::Param param,
+              unsigned long long min, unsigned long long max, bool bytes = false) {
+    registry.add(section, key,
+        [&config, &field, param, min, max, bytes](const std::string& value, std::string& error) {
+            if (strcasecmp(value.c_str(), "auto") == 0) {
+                config.auto_params |= param;
+                return true;
+            }
+            unsigned long long number = 0;
+            if (!ConfigRegistry::parse_number(value, bytes, number)) {
+                error = "invalid number '" + value + "' (or auto)";
+                return false;
+            }
+            if (number < min || number > max) {
+                error = "value " + std::to_string(number) + " out of range [" + std::to_string(min) +
+                        ", " + std::to_string(max) + "]";
+                return false;
+            }
+            field = static_cast<T>(number);
+            config.auto_params &= ~static_cast<uint32_t>(param);
+            return true;
+        },
+        [&field] { return std::to_string(field); });
 }
 
-size_t Config::parse_size_t(const std::string& str, size_t default_val) {
-    try {
-        return static_cast<size_t>(std::stoull(str));
-    } catch (...) {
-        return default_val;
-    }
+// 八进制文件权限（如 700）
+void add_permission(ConfigRegistry& registry, const std::string& section, const std::string& key,
+                    uint32_t& field) {
+    registry.add(section, key,
+        [&field](const std::string& value, std::string& error) {
+            char* end = nullptr;
+            unsigned long perm = std::strtoul(value.c_str(), &end, 8);
+            if (value.empty() || *end != '\0' || perm > 0777) {
+                error = "argument must be an octal permission such as 700";
+                return false;
+            }
+            field = static_cast<uint32_t>(perm);
+            return true;
+        },
+        [&field] {
+            std::ostringstream oss;
+            oss << std::oct << field;
+            return oss.str();
+        });
 }
 
-bool Config::parse_bool(const std::string& str, bool default_val) {
-    std::string lower = str;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-    
-    if (lower == "true" || lower == "1" || lower == "yes" || lower == "on") {
-        return true;
-    } else if (lower == "false" || lower == "0" || lower == "no" || lower == "off") {
-        return false;
-    }
-    return default_val;
+} // namespace
+
+void Config::register_parameters(RedisServer::Config& config, ConfigRegistry& registry) {
+    constexpr unsigned long long MAX_SECONDS = 365ULL * 24 * 3600;
+
+    // [server]
+    registry.add_integer("server", "port", config.port, 1, 65535);
+    registry.add_string("server", "host", config.host);
+    registry.add_string("server", "unixsocket", config.unixsocket);
+    add_permission(registry, "server", "unixsocketperm", config.unixsocket_perm);
+
+    // [threading]
+    add_auto(registry, config, "threading", "worker_threads", config.worker_threads,
+             AutoTune::WORKER_THREADS, 1, 1024);
+    registry.add_integer("threading", "io_threads", config.io_threads, 0, 1024);
+    add_auto(registry, config, "threading", "slow_threads", config.slow_threads,
+             AutoTune::SLOW_THREADS, 0, 256);
+    registry.add_integer("threading", "slow_queue_limit", config.slow_queue_limit);
+    registry.add_integer("threading", "background_threads", config.background_threads, 1, 64);
+    add_auto(registry, config, "threading", "shard_count", config.shard_count,
+             AutoTune::SHARD_COUNT, 1, 65536);
+
+    // [performance]
+    add_auto(registry, config, "performance", "max_connections", config.max_connections,
+             AutoTune::MAX_CONNECTIONS, 1, std::numeric_limits<size_t>::max());
+    add_auto(registry, config, "performance", "buffer_size", config.buffer_size,
+             AutoTune::BUFFER_SIZE, 0, 1ULL << 30, true);
+    registry.add_integer("performance", "batch_size", config.batch_size, 2, 1ULL << 20);
+    registry.add_enum("performance", "connection_steering", config.connection_steering,
+                      {"least_loaded", "incoming_cpu"});
+
+    // [tuning]
+    registry.add_bool("tuning", "calibrate", config.auto_calibrate);
+
+    // [storage]
+    registry.add_integer("storage", "cache_size_mb", config.cache_size_mb, 1, 1ULL << 20);
+    registry.add_enum("storage", "cache_policy", config.cache_policy, {"lru"});
+    registry.add_bool("storage", "enable_cache", config.enable_cache);
+    add_auto(registry, config, "storage", "bucket_per_shard", config.bucket_per_shard,
+             AutoTune::BUCKET_PER_SHARD, 1, 4096);
+    registry.add_bool("storage", "enable_compression", config.enable_compression);
+    registry.add_bool("storage", "enable_persistence", config.enable_persistence);
+    registry.add_integer("storage", "sync_interval_sec", config.sync_interval_sec, 1, MAX_SECONDS);
+    registry.add_integer("storage", "lazyfree_threshold_kb", config.lazyfree_threshold_kb);
+
+    // [hotkeys]
+    registry.add_bool("hotkeys", "enable", config.enable_hotkeys);
+    registry.add_integer("hotkeys", "sample_rate", config.hotkey_sample_rate, 1);
+    registry.add_integer("hotkeys", "capacity", config.hotkey_capacity, 1, 1ULL << 20);
+    registry.add_integer("hotkeys", "near_cache_entries", config.near_cache_entries, 0, 4096);
+
+    // [metrics]
+    registry.add_bool("metrics", "enable", config.enable_metrics);
+    registry.add_integer("metrics", "port", config.metrics_port, 1, 65535);
+
+    // [latency]
+    registry.add_integer("latency", "monitor_threshold_ms", config.latency_monitor_threshold_ms);
+    registry.add_bool("latency", "watchdog", config.enable_watchdog);
+    registry.add_integer("latency", "watchdog_threshold_ms", config.watchdog_threshold_ms, 1);
+
+    // [capture]
+    registry.add_string("capture", "dir", config.capture_dir);
+    registry.add_bool("capture", "enable", config.enable_capture);
+    registry.add_integer("capture", "sample_rate", config.capture_sample_rate, 1);
+    registry.add_integer("capture", "max_mb", config.capture_max_mb);
+
+    // [shm]
+    registry.add_bool("shm", "enable", config.enable_shm);
+    registry.add_string("shm", "path", config.shm_path);
+    add_permission(registry, "shm", "perm", config.shm_perm);
+    registry.add_integer("shm", "ring_kb", config.shm_ring_kb, 1, 1ULL << 20);
+    registry.add_integer("shm", "arena_mb", config.shm_arena_mb, 1, 1ULL << 14);
+
+    // [admission]
+    registry.add_bool("admission", "enable", config.enable_admission);
+    registry.add_integer("admission", "target_ms", config.admission_target_ms);
+    registry.add_integer("admission", "interval_ms", config.admission_interval_ms, 1);
+
+    // [busypoll]
+    registry.add_bool("busypoll", "enable", config.enable_busy_poll);
+    registry.add_integer("busypoll", "window_us", config.busy_poll_window_us, 1, 1000000);
+    registry.add_integer("busypoll", "socket_us", config.busy_poll_socket_us, 0, 1000000);
+
+    // [clients]
+    auto& limits = config.client_limits;
+    registry.add("clients", "ratelimit",
+        [&limits](const std::string& value, std::string& error) {
+            // 每行一条规则（CONFIG 中以 ';' 分隔），按顺序匹配；整体替换原有规则
+            std::vector<ClientLimits::RateRule> rules;
+            std::istringstream iss(value);
+            for (std::string spec; std::getline(iss, spec, ';');) {
+                spec.erase(0, spec.find_first_not_of(" \t"));
+                spec.erase(spec.find_last_not_of(" \t") + 1);
+                if (spec.empty()) continue;
+                ClientLimits::RateRule rule;
+                if (!ClientLimits::parse_rule(spec, rule, error)) {
+                    return false;
+                }
+                rules.push_back(rule);
+            }
+            limits.rate_rules = std::move(rules);
+            return true;
+        },
+        [&limits] {
+            std::string out;
+            for (const auto& rule : limits.rate_rules) {
+                if (!out.empty()) out += "; ";
+                out += ClientLimits::format_rule(rule);
+            }
+            return out;
+        },
+        ConfigRegistry::REPEATABLE);
+    registry.add("clients", "output_buffer_limit",
+        [&limits](const std::string& value, std::string& error) {
+            // "<硬限制> <软限制> <软限制秒数>"，与 Redis client-output-buffer-limit 相同
+            std::istringstream iss(value);
+            std::string hard, soft, seconds, extra;
+            unsigned long long hard_bytes = 0, soft_bytes = 0, soft_seconds = 0;
+            if (!(iss >> hard >> soft >> seconds) || (iss >> extra) ||
+                !ConfigRegistry::parse_number(hard, true, hard_bytes) ||
+                !ConfigRegistry::parse_number(soft, true, soft_bytes) ||
+                !ConfigRegistry::parse_number(seconds, false, soft_seconds) || soft_seconds > MAX_SECONDS) {
+                error = "argument must be '<hard> <soft> <soft seconds>'";
+                return false;
+            }
+            limits.output_hard_bytes = hard_bytes;
+            limits.output_soft_bytes = soft_bytes;
+            limits.output_soft_seconds = static_cast<uint32_t>(soft_seconds);
+            return true;
+        },
+        [&limits] {
+            return std::to_string(limits.output_hard_bytes) + " " + std::to_string(limits.output_soft_bytes) +
+                   " " + std::to_string(limits.output_soft_seconds);
+        });
+    registry.add_bytes("clients", "maxmemory_clients", limits.max_client_memory);
+
+    // [modules]：每行一个模块 "路径 [参数...]"
+    registry.add("modules", "load",
+        [&config](const std::string& value, std::string&) {
+            config.modules.clear();
+            std::istringstream iss(value);
+            for (std::string spec; std::getline(iss, spec, ';');) {
+                spec.erase(0, spec.find_first_not_of(" \t"));
+                spec.erase(spec.find_last_not_of(" \t") + 1);
+                if (!spec.empty()) config.modules.push_back(spec);
+            }
+            return true;
+        },
+        [&config] {
+            std::string out;
+            for (const auto& module : config.modules) {
+                if (!out.empty()) out += "; ";
+                out += module;
+            }
+            return out;
+        },
+        ConfigRegistry::REPEATABLE);
+
+    // [logging]
+    registry.add("logging", "level",
+        [&config](const std::string& value, std::string& error) {
+            Logger::Level level;
+            if (!Logger::parse_level(value, level)) {
+                error = "argument must be one of: debug info warning error off";
+                return false;
+            }
+            config.log_level = value;
+            std::transform(config.log_level.begin(), config.log_level.end(), config.log_level.begin(), ::tolower);
+            return true;
+        },
+        [&config] { return config.log_level; });
+    registry.add_integer("logging", "rate_limit", config.log_rate_limit);
 }
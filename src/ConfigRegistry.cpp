@@ -0,0 +1,384 @@
+#include "ConfigRegistry.h"
+#include "Logger.h"
+#include <fnmatch.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+namespace {
+    std::string trim(const std::string& s) {
+        size_t begin = s.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos) return "";
+        size_t end = s.find_last_not_of(" \t\r\n");
+        return s.substr(begin, end - begin + 1);
+    }
+
+    std::string to_lower(std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+        return s;
+    }
+
+    // 按 ';' 拆分可重复参数的各项（去掉空项）
+    std::vector<std::string> split_items(const std::string& value) {
+        std::vector<std::string> items;
+        size_t start = 0;
+        while (start <= value.size()) {
+            size_t end = value.find(';', start);
+            if (end == std::string::npos) end = value.size();
+            std::string item = trim(value.substr(start, end - start));
+            if (!item.empty()) items.push_back(item);
+            start = end + 1;
+        }
+        return items;
+    }
+
+    // 配置文件中的一行：所属 section 与 key（非 key=value 行 key 为空）
+    struct FileLine {
+        std::string text;
+        std::string section;
+        std::string key;
+    };
+
+    std::vector<FileLine> read_lines(std::istream& in) {
+        std::vector<FileLine> lines;
+        std::string text, section;
+        while (std::getline(in, text)) {
+            FileLine line{text, section, ""};
+            std::string content = trim(text.substr(0, text.find('#')));
+            if (!content.empty() && content.front() == '[' && content.back() == ']') {
+                section = content.substr(1, content.size() - 2);
+                line.section = section;
+            } else {
+                auto eq = content.find('=');
+                if (eq != std::string::npos) {
+                    line.key = trim(content.substr(0, eq));
+                }
+            }
+            lines.push_back(std::move(line));
+        }
+        return lines;
+    }
+
+    // 生成 "key = value" 行，保留原行的行尾注释及其列位置
+    std::string format_line(const std::string& key, const std::string& value, const std::string& original) {
+        std::string line = key + " = " + value;
+        size_t comment = original.find('#');
+        if (comment != std::string::npos) {
+            line.append(line.size() < comment ? comment - line.size() : 1, ' ');
+            line += original.substr(comment);
+        }
+        return line;
+    }
+}
+
+void ConfigRegistry::add(const std::string& section, const std::string& key, Setter set, Getter get,
+                         uint32_t flags) {
+    std::string name = section + "." + key;
+    index_[name] = params_.size();
+    params_.push_back(Parameter{name, section, key, flags, std::move(set), std::move(get), nullptr});
+}
+
+void ConfigRegistry::add_bool(const std::string& section, const std::string& key, bool& field) {
+    add(section, key,
+        [&field](const std::string& value, std::string& error) {
+            if (!parse_bool(value, field)) {
+                error = "argument must be 'true' or 'false'";
+                return false;
+            }
+            return true;
+        },
+        [&field] { return std::string(field ? "true" : "false"); });
+}
+
+void ConfigRegistry::add_string(const std::string& section, const std::string& key, std::string& field) {
+    add(section, key,
+        [&field](const std::string& value, std::string&) {
+            field = value;
+            return true;
+        },
+        [&field] { return field; });
+}
+
+void ConfigRegistry::add_enum(const std::string& section, const std::string& key, std::string& field,
+                              std::vector<std::string> choices) {
+    add(section, key,
+        [&field, choices](const std::string& value, std::string& error) {
+            std::string lower = to_lower(value);
+            if (std::find(choices.begin(), choices.end(), lower) == choices.end()) {
+                error = "argument must be one of:";
+                for (const auto& choice : choices) error += " " + choice;
+                return false;
+            }
+            field = lower;
+            return true;
+        },
+        [&field] { return field; });
+}
+
+void ConfigRegistry::on_change(const std::string& name, std::function<void()> hook) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto* param = find(name)) {
+        param->on_change = std::move(hook);
+    }
+}
+
+ConfigRegistry::Parameter* ConfigRegistry::find(const std::string& name) {
+    auto it = index_.find(name);
+    return it == index_.end() ? nullptr : &params_[it->second];
+}
+
+void ConfigRegistry::load_file(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = path;
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOG_WARN("Could not open config file %s, using default configuration", path.c_str());
+        return;
+    }
+
+    // 可重复参数先收集所有行，最后整体设置一次
+    std::map<std::string, std::pair<std::string, int>> repeated;
+    auto apply = [&](Parameter& param, const std::string& value, int line_no) {
+        std::string error;
+        if (!param.set(value, error)) {
+            throw std::runtime_error(path + ":" + std::to_string(line_no) + ": " + param.name + ": " + error);
+        }
+    };
+
+    int line_no = 0;
+    for (const auto& line : read_lines(file)) {
+        ++line_no;
+        if (line.key.empty()) continue;
+
+        std::string value = trim(line.text.substr(0, line.text.find('#')));
+        value = trim(value.substr(value.find('=') + 1));
+
+        auto* param = find(line.section + "." + line.key);
+        if (!param) {
+            LOG_WARN("Unknown config parameter '%s' in [%s] at %s:%d", line.key.c_str(),
+                     line.section.c_str(), path.c_str(), line_no);
+            continue;
+        }
+        if (param->flags & REPEATABLE) {
+            auto& entry = repeated[param->name];
+            if (!value.empty()) {
+                entry.first += entry.first.empty() ? value : ";" + value;
+            }
+            entry.second = line_no;
+            continue;
+        }
+        apply(*param, value, line_no);
+    }
+
+    for (const auto& [name, entry] : repeated) {
+        apply(*find(name), entry.first, entry.second);
+    }
+}
+
+void ConfigRegistry::set_path(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = path;
+}
+
+std::vector<std::pair<std::string, std::string>> ConfigRegistry::get(const std::string& pattern) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::pair<std::string, std::string>> result;
+    for (const auto& param : params_) {
+        if (fnmatch(pattern.c_str(), param.name.c_str(), FNM_CASEFOLD) == 0) {
+            result.emplace_back(param.name, param.get());
+        }
+    }
+    return result;
+}
+
+bool ConfigRegistry::set(const std::vector<std::pair<std::string, std::string>>& items, std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // 先检查全部参数名，避免写入一半才发现未知参数
+    std::vector<Parameter*> targets;
+    for (const auto& [name, value] : items) {
+        auto* param = find(to_lower(name));
+        if (!param) {
+            error = "Unknown option or number of arguments for CONFIG SET - '" + name + "'";
+            return false;
+        }
+        if (!param->on_change) {
+            error = "CONFIG SET failed (possibly related to argument '" + name +
+                    "') - can't set immutable config";
+            return false;
+        }
+        targets.push_back(param);
+    }
+
+    // 逐个写入，失败时按相反顺序恢复已写入的参数
+    std::vector<std::pair<Parameter*, std::string>> previous;
+    for (size_t i = 0; i < items.size(); ++i) {
+        std::string old_value = targets[i]->get();
+        std::string reason;
+        if (!targets[i]->set(items[i].second, reason)) {
+            for (auto it = previous.rbegin(); it != previous.rend(); ++it) {
+                std::string ignored;
+                it->first->set(it->second, ignored);
+            }
+            error = "CONFIG SET failed (possibly related to argument '" + items[i].first + "') - " + reason;
+            return false;
+        }
+        previous.emplace_back(targets[i], std::move(old_value));
+    }
+
+    // 全部写入后再生效，同一参数只回调一次
+    std::set<Parameter*> applied;
+    for (auto* param : targets) {
+        if (applied.insert(param).second) {
+            param->on_change();
+            dirty_.insert(static_cast<size_t>(param - params_.data()));
+        }
+    }
+    return true;
+}
+
+bool ConfigRegistry::rewrite(std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (path_.empty()) {
+        error = "The server is running without a config file";
+        return false;
+    }
+
+    std::vector<FileLine> lines;
+    {
+        std::ifstream file(path_);
+        if (file.is_open()) {
+            lines = read_lines(file);
+        }
+    }
+
+    for (size_t index : dirty_) {
+        const auto& param = params_[index];
+        std::vector<std::string> values;
+        if (param.flags & REPEATABLE) {
+            values = split_items(param.get());
+        } else {
+            values.push_back(param.get());
+        }
+
+        // 找到已有的行：第一行原地改写（可重复参数在该处插入全部项），其余同名行删除
+        size_t insert_at = std::string::npos;
+        std::string original;
+        for (size_t i = 0; i < lines.size();) {
+            if (lines[i].section == param.section && lines[i].key == param.key) {
+                if (insert_at == std::string::npos) {
+                    insert_at = i;
+                    original = lines[i].text;
+                }
+                lines.erase(lines.begin() + i);
+            } else {
+                ++i;
+            }
+        }
+
+        if (insert_at == std::string::npos) {
+            // 没有该参数：追加到所属 section 的最后一个非空行之后，没有该 section 时新建
+            size_t section_end = std::string::npos;
+            for (size_t i = 0; i < lines.size(); ++i) {
+                if (lines[i].section == param.section && !trim(lines[i].text).empty()) {
+                    section_end = i + 1;
+                }
+            }
+            if (section_end == std::string::npos) {
+                if (!lines.empty() && !trim(lines.back().text).empty()) {
+                    lines.push_back(FileLine{"", lines.back().section, ""});
+                }
+                lines.push_back(FileLine{"[" + param.section + "]", param.section, ""});
+                section_end = lines.size();
+            }
+            insert_at = section_end;
+        }
+
+        std::vector<FileLine> replacement;
+        for (size_t i = 0; i < values.size(); ++i) {
+            replacement.push_back(FileLine{format_line(param.key, values[i], i == 0 ? original : ""),
+                                           param.section, param.key});
+        }
+        lines.insert(lines.begin() + insert_at, replacement.begin(), replacement.end());
+    }
+
+    std::string tmp_path = path_ + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        for (const auto& line : lines) {
+            out << line.text << '\n';
+        }
+        out.flush();
+        if (!out) {
+            error = "Rewriting config file: failed to write " + tmp_path;
+            return false;
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path_.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        error = "Rewriting config file: failed to replace " + path_;
+        return false;
+    }
+    dirty_.clear();
+    return true;
+}
+
+bool ConfigRegistry::parse_number(const std::string& text, bool bytes, unsigned long long& value) {
+    unsigned long long result = 1;
+    size_t pos = 0;
+    while (true) {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+        if (pos >= text.size() || !std::isdigit(static_cast<unsigned char>(text[pos]))) {
+            return false;
+        }
+
+        unsigned long long factor = 0;
+        while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+            if (__builtin_mul_overflow(factor, 10ULL, &factor) ||
+                __builtin_add_overflow(factor, static_cast<unsigned long long>(text[pos] - '0'), &factor)) {
+                return false;
+            }
+            ++pos;
+        }
+
+        size_t unit_start = pos;
+        while (pos < text.size() && std::isalpha(static_cast<unsigned char>(text[pos]))) ++pos;
+        std::string unit = to_lower(text.substr(unit_start, pos - unit_start));
+        unsigned long long multiplier = 1;
+        if (!unit.empty()) {
+            if (!bytes) return false;
+            if (unit == "b") multiplier = 1;
+            else if (unit == "k" || unit == "kb") multiplier = 1024ULL;
+            else if (unit == "m" || unit == "mb") multiplier = 1024ULL * 1024;
+            else if (unit == "g" || unit == "gb") multiplier = 1024ULL * 1024 * 1024;
+            else return false;
+        }
+        if (__builtin_mul_overflow(factor, multiplier, &factor) ||
+            __builtin_mul_overflow(result, factor, &result)) {
+            return false;
+        }
+
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+        if (pos == text.size()) break;
+        if (text[pos] != '*') return false;
+        ++pos;
+    }
+    value = result;
+    return true;
+}
+
+bool ConfigRegistry::parse_bool(const std::string& text, bool& value) {
+    std::string lower = to_lower(text);
+    if (lower == "true" || lower == "1" || lower == "yes" || lower == "on") {
+        value = true;
+    } else if (lower == "false" || lower == "0" || lower == "no" || lower == "off") {
+        value = false;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -5,14 +5,196 @@
 #include <xxhash.h>
 #include <cstring>
 #include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+#include <fnmatch.h>
+#include <zlib.h>
+
+namespace {
+
+// 值编码策略：存储中保存的形式（共享缓存中总是原值）
+struct PlainCodec {
+    static constexpr bool ENCODES = false;
+    static void decode(const std::string& stored, std::string& out) { out.assign(stored); }
+};
+
+struct ZlibCodec {
+    static constexpr bool ENCODES = true;
+    static std::string encode(const std::string& data);
+    static std::string decode(const std::string& data);
+    static void decode(const std::string& stored, std::string& out) { out = decode(stored); }
+};
+
+// 缓存层策略：读写是否经过共享缓存
+struct SharedCache {
+    static constexpr bool ENABLED = true;
+};
+
+struct NoCache {
+    static constexpr bool ENABLED = false;
+};
+
+} // namespace
+
+template <class Codec, class CacheLayer>
+struct DataStore::Engine {
+    static const Ops OPS;
+
+    static void set(DataStore& store, const std::string& key, const std::string& value) {
+        auto& submap = store.submap_for(key);
+        if constexpr (CacheLayer::ENABLED) {
+            // 共享缓存先于存储更新：先推进纪元使近端缓存中的旧值失效，提交时在写锁内再推进一次，
+            // 其间重新填充的近端缓存条目（读到的仍是旧值）随之失效
+            submap.bump();
+            store.cache_.put(key, value);
+        }
+        
+        // 编码在加锁前完成
+        std::string encoded;
+        if constexpr (Codec::ENCODES) {
+            encoded = Codec::encode(value);
+        }
+        
+        std::unique_lock<std::shared_mutex> lock(submap.mutex);
+        submap.bump();
+        auto it = submap.store.find(key);
+        if constexpr (Codec::ENCODES) {
+            if (it == submap.store.end()) {
+                submap.store.emplace(key, std::move(encoded));
+            } else {
+                it->second = std::move(encoded);
+            }
+        } else {
+            if (it == submap.store.end()) {
+                submap.store.emplace(key, value);
+            } else {
+                // 覆盖写复用已有值的容量
+                it->second.assign(value);
+            }
+        }
+    }
+
+    static void set_batch(DataStore& store, const AdaptiveCache::KeyValueRefs& items) {
+        if (items.empty()) {
+            return;
+        }
+        if constexpr (CacheLayer::ENABLED) {
+            // 与 set 相同：共享缓存更新前先使近端缓存失效，提交时再推进一次纪元
+            for (const auto& item : items) {
+                store.submap_for(*item.first).bump();
+            }
+            store.cache_.put_batch(items);
+        }
+        
+        // 编码在加锁前完成
+        std::vector<std::string> encoded;
+        if constexpr (Codec::ENCODES) {
+            encoded.reserve(items.size());
+            for (const auto& item : items) {
+                encoded.push_back(Codec::encode(*item.second));
+            }
+        }
+        
+        // 按子map分组：同一键总在同一子map，多次写入保持原有顺序
+        thread_local std::vector<std::pair<Bucket::SubMap*, size_t>> order;
+        order.clear();
+        for (size_t i = 0; i < items.size(); ++i) {
+            order.emplace_back(&store.submap_for(*items[i].first), i);
+        }
+        // 第二关键字是项下标：普通排序即保持同一键的写入顺序，且不像 stable_sort 那样申请临时缓冲区
+        std::sort(order.begin(), order.end());
+        
+        for (size_t pos = 0; pos < order.size();) {
+            auto* submap = order[pos].first;
+            std::unique_lock<std::shared_mutex> lock(submap->mutex);
+            submap->bump();
+            for (; pos < order.size() && order[pos].first == submap; ++pos) {
+                size_t i = order[pos].second;
+                auto& slot = submap->store[*items[i].first];
+                if constexpr (Codec::ENCODES) {
+                    slot = std::move(encoded[i]);
+                } else {
+                    slot.assign(*items[i].second);
+                }
+            }
+        }
+    }
+
+    static bool get_into(DataStore& store, const std::string& key, std::string& out) {
+        // 先查询缓存
+        if constexpr (CacheLayer::ENABLED) {
+            if (store.cache_.get_into(key, out)) {
+                return true;
+            }
+        }
+        
+        // 缓存未命中，查询存储（只锁定单个子map）
+        auto& submap = store.submap_for(key);
+        std::shared_lock<std::shared_mutex> lock(submap.mutex);
+        auto it = submap.store.find(key);
+        if (it == submap.store.end()) {
+            return false;
+        }
+        Codec::decode(it->second, out);
+        if constexpr (CacheLayer::ENABLED) {
+            // 更新缓存
+            store.cache_.put(key, out);
+        }
+        return true;
+    }
+
+    static bool get_versioned(DataStore& store, const std::string& key, std::string& out, Version& version) {
+        auto& submap = store.submap_for(key);
+        std::shared_lock<std::shared_mutex> lock(submap.mutex);
+        // 写入推进两次纪元：更新共享缓存之前在锁外一次，提交时在写锁内一次。
+        // 锁外的推进可能与这里的读取并发，读到的纪元可能已含这一次而值仍是旧的；
+        // 提交时写锁内的推进必然在读锁释放之后，按这里的纪元登记的条目随之失效
+        version.epoch = &submap.epoch;
+        version.value = submap.epoch.load(std::memory_order_relaxed);
+        auto it = submap.store.find(key);
+        if (it == submap.store.end()) {
+            return false;
+        }
+        Codec::decode(it->second, out);
+        return true;
+    }
+
+    static bool del(DataStore& store, const std::string& key) {
+        // 从缓存中删除
+        if constexpr (CacheLayer::ENABLED) {
+            store.cache_.remove(key);
+        }
+        
+        // 从存储中删除（只锁定单个子map）
+        auto& submap = store.submap_for(key);
+        std::unique_lock<std::shared_mutex> lock(submap.mutex);
+        submap.bump();
+        return submap.store.erase(key) > 0;
+    }
+};
+
+template <class Codec, class CacheLayer>
+const DataStore::Ops DataStore::Engine<Codec, CacheLayer>::OPS = {
+    &Engine::set,
+    &Engine::set_batch,
+    &Engine::get_into,
+    &Engine::get_versioned,
+    &Engine::del,
+};
+
+const DataStore::Ops& DataStore::select_ops(const Options& options) {
+    if (options.enable_compression) {
+        return options.enable_cache ? Engine<ZlibCodec, SharedCache>::OPS
+                                    : Engine<ZlibCodec, NoCache>::OPS;
+    }
+    return options.enable_cache ? Engine<PlainCodec, SharedCache>::OPS
+                                : Engine<PlainCodec, NoCache>::OPS;
+}
 
 DataStore::DataStore(const Options& options)
     : shards_(options.shard_count)
     , shard_count_(options.shard_count)
     , bucket_per_shard_(options.bucket_per_shard)
-    , enable_compression_(options.enable_compression)
-    , persist_path_(options.persist_path)
-    , sync_interval_(options.sync_interval)
     , cache_([&options]() {
         AdaptiveCache::Options cache_options;
         cache_options.shard_count = options.cache_shards;
@@ -20,152 +202,250 @@ DataStore::DataStore(const Options& options)
         cache_options.policy_type = options.cache_policy;
         cache_options.memory_pool_block_size = options.memory_pool_block_size;
         cache_options.enable_adaptive_sizing = options.adaptive_cache_sizing;
+        if (!options.enable_cache) {
+            // 不经过缓存层：保留一个空缓存供统计接口使用，不做容量调整
+            cache_options.shard_count = 1;
+            cache_options.enable_adaptive_sizing = false;
+        }
         return AdaptiveCache(cache_options);
       }())
+    , ops_(select_ops(options))
+    , enable_compression_(options.enable_compression)
+    , enable_cache_(options.enable_cache)
+    , enable_persistence_(options.enable_persistence)
+    , persist_path_(options.persist_path)
+    , lazyfree_threshold_(options.lazyfree_threshold)
 {
-    // 创建持久化目录
-    std::filesystem::create_directories(persist_path_);
-    
     // 初始化分片
     for (size_t i = 0; i < shard_count_; ++i) {
         shards_[i] = std::make_unique<Shard>(bucket_per_shard_);
         shards_[i]->persist_file = persist_path_ + "shard_" + std::to_string(i) + ".dat";
+    }
+    if (!enable_persistence_) {
+        return;
+    }
+    
+    // 创建持久化目录并加载已有数据
+    std::filesystem::create_directories(persist_path_);
+    for (size_t i = 0; i < shard_count_; ++i) {
         load_shard(i);
     }
     
-    // 启动同步线程
-    start_sync_thread();
+    // 周期落盘：交给后台任务调度器，最多占用半个核心（某轮落盘过久时推迟下一轮）
+    TaskScheduler::TaskOptions sync_options;
+    sync_options.name = "persist";
+    sync_options.priority = TaskScheduler::Priority::HIGH;
+    sync_options.delay = options.sync_interval;
+    sync_options.period = options.sync_interval;
+    sync_options.cpu_budget = 0.5;
+    sync_task_ = TaskScheduler::instance().schedule([this] { persist_all(); }, sync_options);
 }
 
 DataStore::~DataStore() {
-    // 停止同步线程
-    should_stop_ = true;
-    if (sync_thread_.joinable()) {
-        sync_thread_.join();
+    if (!enable_persistence_) {
+        return;
     }
+    // 取消落盘任务（正在落盘时等待其完成）
+    TaskScheduler::instance().cancel(sync_task_);
     
     // 保存所有分片
     flush();
 }
 
-void DataStore::set(const std::string& key, const std::string& value) {
-    set(std::string_view(key), std::string_view(value));
+void DataStore::set(std::string_view key, std::string_view value) {
+    set(std::string(key), std::string(value));
+}
+
+std::optional<std::string> DataStore::get(std::string_view key) {
+    return get(std::string(key));
+}
+
+bool DataStore::del(std::string_view key) {
+    return del(std::string(key));
 }
 
 std::optional<std::string> DataStore::get(const std::string& key) {
-    return get(std::string_view(key));
+    std::string value;
+    if (!get_into(key, value)) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+DataStore::KeyGuard DataStore::lock_keys(const std::vector<std::string>& keys) {
+    KeyGuard guard(this);
+    guard.keys_.reserve(keys.size());
+    std::vector<Bucket::SubMap*> submaps;
+    submaps.reserve(keys.size());
+    for (const auto& key : keys) {
+        auto* submap = &submap_for(key);
+        guard.keys_.emplace_back(key, submap);
+        submaps.push_back(submap);
+    }
+
+    // 固定加锁顺序（按地址），与其他多键操作之间不会形成环路等待
+    std::sort(submaps.begin(), submaps.end());
+    submaps.erase(std::unique(submaps.begin(), submaps.end()), submaps.end());
+    guard.locks_.reserve(submaps.size());
+    for (auto* submap : submaps) {
+        guard.locks_.emplace_back(submap->mutex);
+        // 持锁期间可能写入：按写入处理，使近端缓存中这些子map的条目失效
+        submap->bump();
+    }
+    return guard;
 }
 
-bool DataStore::del(const std::string& key) {
-    return del(std::string_view(key));
+DataStore::Bucket::SubMap* DataStore::KeyGuard::find(const std::string& key) const {
+    for (const auto& [name, submap] : keys_) {
+        if (name == key) return submap;
+    }
+    return nullptr;
 }
 
-void DataStore::set(std::string_view key, std::string_view value) {
-    // 优化：仅在必要时进行string转换
-    std::string key_str;
-    std::string value_str;
-    std::string stored_value;
-    
-    // 只有在需要压缩时才转换value
-    if (enable_compression_) {
-        value_str = std::string(value);
-        stored_value = compress(value_str);
-        // 更新缓存使用未压缩的值
-        key_str = std::string(key);
-        cache_.put(key_str, value_str);
-    } else {
-        // 不压缩时直接使用string_view的数据
-        key_str = std::string(key);
-        value_str = std::string(value);
-        stored_value = value_str;
-        cache_.put(key_str, value_str);
+bool DataStore::KeyGuard::holds(const std::string& key) const {
+    return find(key) != nullptr;
+}
+
+std::optional<std::string> DataStore::KeyGuard::get(const std::string& key) const {
+    auto* submap = find(key);
+    if (!submap) {
+        throw std::logic_error("key not locked by this guard: " + key);
     }
-    
-    // 更新存储
-    size_t shard_idx = get_shard_index(key_str);
-    auto& shard = shards_[shard_idx];
-    
-    // 计算桶索引并获取对应的桶
-    size_t bucket_idx = get_bucket_index(key_str, bucket_per_shard_);
-    auto& bucket = shard->buckets[bucket_idx];
-    
-    // 获取子map索引
-    size_t submap_idx = bucket->get_submap_index(key_str);
-    auto& submap = bucket->sub_maps[submap_idx];
-    
-    // 锁定单个子map
-    {
-        std::unique_lock<std::shared_mutex> lock(submap.mutex);
-        submap.store[key_str] = std::move(stored_value);
+    // 直接读存储而不是缓存：缓存与存储的更新不在同一把锁下，读-改-写必须以存储为准
+    auto it = submap->store.find(key);
+    if (it == submap->store.end()) {
+        return std::nullopt;
     }
+    return store_->enable_compression_ ? ZlibCodec::decode(it->second) : it->second;
 }
 
-std::optional<std::string> DataStore::get(std::string_view key) {
-    // 转换为std::string
+void DataStore::KeyGuard::set(const std::string& key, std::string_view value) {
+    auto* submap = find(key);
+    if (!submap) {
+        throw std::logic_error("key not locked by this guard: " + key);
+    }
+    std::string value_str(value);
+    submap->store[key] = store_->enable_compression_ ? ZlibCodec::encode(value_str) : value_str;
+    if (store_->enable_cache_) {
+        store_->cache_.put(key, value_str);
+    }
+}
+
+bool DataStore::KeyGuard::del(const std::string& key) {
+    auto* submap = find(key);
+    if (!submap) {
+        throw std::logic_error("key not locked by this guard: " + key);
+    }
+    if (store_->enable_cache_) {
+        store_->cache_.remove(key);
+    }
+    return submap->store.erase(key) > 0;
+}
+
+bool DataStore::unlink(std::string_view key) {
     std::string key_str(key);
     
-    // 先查询缓存
-    if (auto cached = cache_.get(key_str)) {
-        return cached;
+    // 缓存与存储中的值都先移出，锁外再决定同步还是后台释放
+    std::optional<std::string> cached;
+    if (enable_cache_) {
+        cached = cache_.take(key_str);
     }
+    std::string detached;
+    bool found = false;
     
-    // 缓存未命中，查询存储
-    size_t shard_idx = get_shard_index(key_str);
-    auto& shard = shards_[shard_idx];
-    
-    // 计算桶索引并获取对应的桶
-    size_t bucket_idx = get_bucket_index(key_str, bucket_per_shard_);
-    auto& bucket = shard->buckets[bucket_idx];
-    
-    // 获取子map索引
-    size_t submap_idx = bucket->get_submap_index(key_str);
-    auto& submap = bucket->sub_maps[submap_idx];
-    
-    // 只锁定单个子map
+    auto& submap = submap_for(key_str);
     {
-        std::shared_lock<std::shared_mutex> lock(submap.mutex);
+        std::unique_lock<std::shared_mutex> lock(submap.mutex);
+        submap.bump();
         auto it = submap.store.find(key_str);
-        if (it == submap.store.end()) {
-            return std::nullopt;
+        if (it != submap.store.end()) {
+            detached = std::move(it->second);
+            submap.store.erase(it);
+            found = true;
         }
-        
-        std::string value = enable_compression_ ? decompress(it->second) : it->second;
-        // 更新缓存
-        cache_.put(key_str, value);
-        return value;
     }
+    
+    if (detached.capacity() >= lazyfree_threshold_) {
+        lazyfree_.free(std::move(detached));
+    }
+    if (cached && cached->capacity() >= lazyfree_threshold_) {
+        lazyfree_.free(std::move(*cached));
+    }
+    return found;
 }
 
-bool DataStore::del(std::string_view key) {
-    // 转换为std::string
-    std::string key_str(key);
-    
-    // 从缓存中删除
-    cache_.remove(key_str);
-    
-    // 从存储中删除
-    size_t shard_idx = get_shard_index(key_str);
-    auto& shard = shards_[shard_idx];
-    
-    // 计算桶索引并获取对应的桶
-    size_t bucket_idx = get_bucket_index(key_str, bucket_per_shard_);
-    auto& bucket = shard->buckets[bucket_idx];
-    
-    // 获取子map索引
-    size_t submap_idx = bucket->get_submap_index(key_str);
-    auto& submap = bucket->sub_maps[submap_idx];
+void DataStore::flush_all(bool async) {
+    for (auto& shard : shards_) {
+        for (auto& bucket : shard->buckets) {
+            for (auto& submap : bucket->sub_maps) {
+                std::unordered_map<std::string, std::string> detached;
+                {
+                    std::unique_lock<std::shared_mutex> lock(submap.mutex);
+                    submap.bump();
+                    detached.swap(submap.store);
+                }
+                // 同步模式下 detached 在此析构，同样不持有子map锁
+                if (async && !detached.empty()) {
+                    lazyfree_.free(std::move(detached));
+                }
+            }
+        }
+    }
     
-    // 只锁定单个子map
-    {
-        std::unique_lock<std::shared_mutex> lock(submap.mutex);
-        return submap.store.erase(key_str) > 0;
+    auto cached = cache_.detach_all();
+    if (async) {
+        lazyfree_.free(std::move(cached));
+    }
+}
+
+std::vector<std::string> DataStore::keys(const std::string& pattern) {
+    std::vector<std::string> result;
+    bool match_all = pattern == "*";
+    for (auto& shard : shards_) {
+        for (auto& bucket : shard->buckets) {
+            for (auto& submap : bucket->sub_maps) {
+                std::shared_lock<std::shared_mutex> lock(submap.mutex);
+                for (const auto& entry : submap.store) {
+                    if (match_all || fnmatch(pattern.c_str(), entry.first.c_str(), 0) == 0) {
+                        result.push_back(entry.first);
+                    }
+                }
+            }
+        }
     }
+    return result;
 }
 
 void DataStore::flush() {
+    persist_all();
+}
+
+void DataStore::persist_all() {
+    auto start = std::chrono::steady_clock::now();
+    
     for (size_t i = 0; i < shard_count_; ++i) {
-        persist_shard(i);
+        if (!persist_shard(i)) {
+            persist_failures_.fetch_add(1, std::memory_order_relaxed);
+        }
     }
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    persist_last_duration_us_.store(elapsed, std::memory_order_relaxed);
+    persist_total_duration_us_.fetch_add(elapsed, std::memory_order_relaxed);
+    persist_last_save_time_.store(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+    persist_saves_.fetch_add(1, std::memory_order_relaxed);
+}
+
+DataStore::PersistenceStats DataStore::get_persistence_stats() const {
+    PersistenceStats stats;
+    stats.saves = persist_saves_.load(std::memory_order_relaxed);
+    stats.failures = persist_failures_.load(std::memory_order_relaxed);
+    stats.last_duration_sec = persist_last_duration_us_.load(std::memory_order_relaxed) / 1e6;
+    stats.total_duration_sec = persist_total_duration_us_.load(std::memory_order_relaxed) / 1e6;
+    stats.last_save_time = persist_last_save_time_.load(std::memory_order_relaxed);
+    return stats;
 }
 
 // 一致性哈希实现
@@ -177,13 +457,22 @@ size_t DataStore::get_shard_index(const std::string& key) const {
     return hash(key) % shard_count_;
 }
 
+DataStore::Bucket::SubMap& DataStore::submap_for(const std::string& key) {
+    auto& bucket = shards_[get_shard_index(key)]->buckets[get_bucket_index(key, bucket_per_shard_)];
+    return bucket->sub_maps[bucket->get_submap_index(key)];
+}
+
+size_t DataStore::bucket_bytes() {
+    return sizeof(Bucket);
+}
+
 size_t DataStore::get_bucket_index(const std::string& key, size_t bucket_count) const {
     // 使用二次哈希来确定桶索引，避免分片和桶使用相同的哈希值
     return XXH32(key.data(), key.size(), 0x42) % bucket_count;
 }
 
 // 压缩功能实现
-std::string DataStore::compress(const std::string& data) {
+std::string ZlibCodec::encode(const std::string& data) {
     std::vector<unsigned char> compressed(data.size() + 128);
 
     z_stream zs{};
@@ -210,7 +499,7 @@ std::string DataStore::compress(const std::string& data) {
     return std::string(reinterpret_cast<char*>(compressed.data()), compressed.size());
 }
 
-std::string DataStore::decompress(const std::string& data) {
+std::string ZlibCodec::decode(const std::string& data) {
     std::vector<unsigned char> decompressed;
     decompressed.resize(data.size() * 2); // 初始缓冲区大小
 
@@ -247,9 +536,10 @@ std::string DataStore::decompress(const std::string& data) {
 }
 
 // 持久化功能实现
-void DataStore::persist_shard(size_t shard_index) {
+bool DataStore::persist_shard(size_t shard_index) {
     auto& shard = shards_[shard_index];
     std::ofstream file(shard->persist_file, std::ios::binary);
+    if (!file) return false;
     
     // 遍历所有桶
     for (size_t bucket_idx = 0; bucket_idx < bucket_per_shard_; ++bucket_idx) {
@@ -273,6 +563,8 @@ void DataStore::persist_shard(size_t shard_index) {
             }
         }
     }
+    
+    return static_cast<bool>(file);
 }
 
 void DataStore::load_shard(size_t shard_index) {
@@ -309,22 +601,8 @@ void DataStore::load_shard(size_t shard_index) {
     }
 }
 
-void DataStore::start_sync_thread() {
-    sync_thread_ = std::thread([this] { sync_routine(); });
-}
-
-void DataStore::sync_routine() {
-    while (!should_stop_) {
-        // 每隔sync_interval_秒进行一次同步
-        std::this_thread::sleep_for(sync_interval_);
-        
-        if (should_stop_) break;
-        
-        // 同步所有分片
-        for (size_t i = 0; i < shard_count_; ++i) {
-            persist_shard(i);
-        }
-    }
+void DataStore::set_sync_interval(std::chrono::seconds interval) {
+    TaskScheduler::instance().set_period(sync_task_, interval);
 }
 
 // （已移除未使用的批量与预取相关接口实现）
@@ -0,0 +1,59 @@
+#include "EmbeddedStore.h"
+#include "DataStore.h"
+
+struct EmbeddedStore::Impl {
+    DataStore store;
+
+    explicit Impl(const DataStore::Options& options) : store(options) {}
+};
+
+namespace {
+    DataStore::Options to_datastore_options(const EmbeddedStore::Options& options) {
+        DataStore::Options ds_options;
+        ds_options.shard_count = options.shard_count;
+        ds_options.cache_size = options.cache_size;
+        ds_options.cache_shards = options.cache_shards;
+        ds_options.enable_compression = options.enable_compression;
+        ds_options.persist_path = options.persist_path;
+        ds_options.sync_interval = options.sync_interval;
+        return ds_options;
+    }
+}
+
+EmbeddedStore::EmbeddedStore(const Options& options)
+    : impl_(std::make_unique<Impl>(to_datastore_options(options))) {
+}
+
+EmbeddedStore::~EmbeddedStore() = default;
+
+EmbeddedStore::EmbeddedStore(EmbeddedStore&&) noexcept = default;
+EmbeddedStore& EmbeddedStore::operator=(EmbeddedStore&&) noexcept = default;
+
+void EmbeddedStore::set(std::string_view key, std::string_view value) {
+    impl_->store.set(key, value);
+}
+
+std::optional<std::string> EmbeddedStore::get(std::string_view key) {
+    return impl_->store.get(key);
+}
+
+bool EmbeddedStore::get(std::string_view key, std::string& value) {
+    return impl_->store.get_into(std::string(key), value);
+}
+
+bool EmbeddedStore::del(std::string_view key) {
+    return impl_->store.del(key);
+}
+
+EmbeddedStore::Stats EmbeddedStore::stats() const {
+    auto cache = impl_->store.get_cache_stats();
+    auto persist = impl_->store.get_persistence_stats();
+    Stats stats;
+    stats.cache_hits = cache.hits;
+    stats.cache_misses = cache.misses;
+    stats.cache_evictions = cache.evictions;
+    stats.cache_items = cache.size;
+    stats.persistence_saves = persist.saves;
+    stats.persistence_failures = persist.failures;
+    return stats;
+}
@@ -0,0 +1,213 @@
+#include "HotKeys.h"
+#include <algorithm>
+#include <atomic>
+
+// SpaceSavingSketch实现
+SpaceSavingSketch::SpaceSavingSketch(size_t capacity)
+    : capacity_(std::max<size_t>(1, capacity)) {
+    counters_.reserve(capacity_);
+    index_.reserve(capacity_ * 2);
+}
+
+uint64_t SpaceSavingSketch::offer(std::string_view key, uint64_t weight) {
+    total_ += weight;
+
+    // 查找键复用成员缓冲区，已在表中的键不分配内存
+    lookup_key_.assign(key.data(), key.size());
+    auto it = index_.find(lookup_key_);
+    if (it != index_.end()) {
+        auto& counter = counters_[it->second];
+        counter.count += weight;
+        return counter.count - counter.error;
+    }
+
+    // 表未满：直接新增计数器
+    if (counters_.size() < capacity_) {
+        index_.emplace(lookup_key_, counters_.size());
+        counters_.push_back(Counter{lookup_key_, weight, 0});
+        return weight;
+    }
+
+    // 表已满：替换计数最小的项，新项继承其计数作为误差上界；
+    // 复用被替换项的索引节点和键字符串，键长不超过原容量时不分配
+    size_t min_idx = find_min();
+    auto& victim = counters_[min_idx];
+    auto node = index_.extract(victim.key);
+    node.key().assign(lookup_key_);
+    index_.insert(std::move(node));
+    victim.error = victim.count;
+    victim.count += weight;
+    victim.key.assign(lookup_key_);
+    return weight;
+}
+
+void SpaceSavingSketch::merge(const SpaceSavingSketch& other) {
+    // 对方表满时，未出现在对方表中的键在对方的真实计数最多为其最小计数
+    uint64_t other_min = 0;
+    if (other.counters_.size() >= other.capacity_ && !other.counters_.empty()) {
+        other_min = other.counters_[other.find_min()].count;
+    }
+
+    for (const auto& counter : other.counters_) {
+        auto it = index_.find(counter.key);
+        if (it != index_.end()) {
+            counters_[it->second].count += counter.count;
+            counters_[it->second].error += counter.error;
+        } else {
+            offer(counter.key, counter.count);
+            auto& merged = counters_[index_[counter.key]];
+            merged.error += counter.error;
+            total_ -= counter.count;  // offer已计入total_，下面统一累加
+        }
+    }
+
+    // 本表中未出现在对方表里的键，误差上界需要加上对方的最小计数
+    if (other_min > 0) {
+        for (auto& counter : counters_) {
+            if (other.index_.find(counter.key) == other.index_.end()) {
+                counter.count += other_min;
+                counter.error += other_min;
+            }
+        }
+    }
+
+    total_ += other.total_;
+}
+
+std::vector<SpaceSavingSketch::Counter> SpaceSavingSketch::top(size_t n) const {
+    std::vector<Counter> result(counters_);
+    std::sort(result.begin(), result.end(),
+        [](const Counter& a, const Counter& b) {
+            return a.count > b.count;
+        });
+    if (result.size() > n) {
+        result.resize(n);
+    }
+    return result;
+}
+
+void SpaceSavingSketch::clear() {
+    counters_.clear();
+    index_.clear();
+    total_ = 0;
+}
+
+size_t SpaceSavingSketch::find_min() const {
+    // 容量通常只有几十项，线性扫描比维护有序结构更省
+    size_t min_idx = 0;
+    for (size_t i = 1; i < counters_.size(); ++i) {
+        if (counters_[i].count < counters_[min_idx].count) {
+            min_idx = i;
+        }
+    }
+    return min_idx;
+}
+
+// HotKeyTracker实现
+namespace {
+    std::atomic<uint64_t> g_next_tracker_id{1};
+
+    uint32_t round_up_pow2(uint32_t v) {
+        if (v <= 1) return 1;
+        uint32_t p = 1;
+        while (p < v && p < (1u << 30)) p <<= 1;
+        return p;
+    }
+}
+
+HotKeyTracker::HotKeyTracker(const Options& options)
+    : id_(g_next_tracker_id.fetch_add(1, std::memory_order_relaxed))
+    , enabled_(options.enabled)
+    , sample_mask_(round_up_pow2(options.sample_rate) - 1)
+    , sketch_capacity_(options.sketch_capacity)
+    , merge_interval_(options.merge_interval)
+    , window_start_(std::chrono::steady_clock::now()) {
+    if (enabled_) {
+        TaskScheduler::TaskOptions merge_options;
+        merge_options.name = "hotkeys-merge";
+        merge_options.priority = TaskScheduler::Priority::LOW;
+        merge_options.delay = merge_interval_;
+        merge_options.period = merge_interval_;
+        merge_task_ = TaskScheduler::instance().schedule([this] { merge(); }, merge_options);
+    }
+}
+
+HotKeyTracker::~HotKeyTracker() {
+    // 等待正在执行的合并结束，之后不会再访问本对象
+    if (merge_task_ != 0) {
+        TaskScheduler::instance().cancel(merge_task_);
+    }
+}
+
+HotKeyTracker::ThreadState& HotKeyTracker::local_state() {
+    // 每个线程按实例ID保存注册（进程内只有少数几个追踪器，线性查找即可），
+    // 多个实例在同一线程交替使用时各自复用已注册的草图
+    thread_local std::vector<std::pair<uint64_t, std::unique_ptr<ThreadState>>> states;
+    for (auto& entry : states) {
+        if (entry.first == id_) return *entry.second;
+    }
+    states.emplace_back(id_, std::make_unique<ThreadState>(register_thread()));
+    return *states.back().second;
+}
+
+HotKeyTracker::ThreadState HotKeyTracker::register_thread() {
+    // 首次在本线程使用：注册一个新的线程本地草图
+    auto sketch = std::make_unique<LocalSketch>(sketch_capacity_);
+    ThreadState state;
+    state.sketch = sketch.get();
+    state.rng ^= reinterpret_cast<uintptr_t>(sketch.get()) ^ (id_ << 32);
+    if (state.rng == 0) state.rng = 0x9E3779B97F4A7C15ull;
+
+    std::lock_guard<std::mutex> lock(sketches_mutex_);
+    sketches_.push_back(std::move(sketch));
+    return state;
+}
+
+bool HotKeyTracker::record_sampled(ThreadState& state, std::string_view key) {
+    std::lock_guard<std::mutex> lock(state.sketch->mutex);
+    auto& sketch = state.sketch->sketch;
+    uint64_t guaranteed = sketch.offer(key);
+    // 热点：确定计数已有若干次采样，且占本线程采样总数的份额不低于 1/容量
+    return guaranteed >= HOT_MIN_SAMPLES && guaranteed * sketch.capacity() >= sketch.total();
+}
+
+void HotKeyTracker::merge() {
+    std::lock_guard<std::mutex> merge_lock(merge_mutex_);
+
+    SpaceSavingSketch window(sketch_capacity_);
+    {
+        std::lock_guard<std::mutex> lock(sketches_mutex_);
+        for (auto& local : sketches_) {
+            // 取出线程本地草图，缩短持锁时间
+            SpaceSavingSketch drained(sketch_capacity_);
+            {
+                std::lock_guard<std::mutex> local_lock(local->mutex);
+                std::swap(drained, local->sketch);
+            }
+            window.merge(drained);
+        }
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - window_start_).count();
+    window_start_ = now;
+    if (elapsed <= 0.0) elapsed = 1e-3;
+
+    uint64_t scale = sample_rate();
+    last_window_.clear();
+    for (const auto& counter : window.top(sketch_capacity_)) {
+        HotKey hot;
+        hot.key = counter.key;
+        hot.estimated_accesses = counter.count * scale;
+        hot.error = counter.error * scale;
+        hot.ops_per_sec = static_cast<double>(hot.estimated_accesses) / elapsed;
+        last_window_.push_back(std::move(hot));
+    }
+}
+
+std::vector<HotKeyTracker::HotKey> HotKeyTracker::top(size_t n) {
+    std::lock_guard<std::mutex> lock(merge_mutex_);
+    std::vector<HotKey> result(last_window_.begin(),
+                               last_window_.begin() + std::min(n, last_window_.size()));
+    return result;
+}
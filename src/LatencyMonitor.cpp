@@ -0,0 +1,124 @@
+#include "LatencyMonitor.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+LatencyMonitor& LatencyMonitor::instance() {
+    static LatencyMonitor monitor;
+    return monitor;
+}
+
+void LatencyMonitor::add_sample_if_needed(const std::string& event, uint64_t latency_ms,
+                                          const std::string& detail) {
+    uint64_t threshold = threshold_ms();
+    if (threshold == 0 || latency_ms < threshold) return;
+
+    int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& series = events_[event];
+    series.info.name = event;
+
+    // 同一秒内只保留最大值
+    size_t prev = (series.next + HISTORY_SIZE - 1) % HISTORY_SIZE;
+    if (series.info.count > 0 && series.samples[prev].time == now) {
+        series.samples[prev].latency_ms = std::max(series.samples[prev].latency_ms, latency_ms);
+    } else {
+        series.samples[series.next] = Sample{now, latency_ms};
+        series.next = (series.next + 1) % HISTORY_SIZE;
+    }
+
+    series.info.latest = Sample{now, latency_ms};
+    series.info.max_latency_ms = std::max(series.info.max_latency_ms, latency_ms);
+    series.info.count++;
+    series.info.total_latency_ms += latency_ms;
+    if (!detail.empty()) {
+        series.info.last_detail = detail;
+    }
+}
+
+std::vector<LatencyMonitor::EventInfo> LatencyMonitor::latest() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<EventInfo> result;
+    result.reserve(events_.size());
+    for (const auto& [name, series] : events_) {
+        result.push_back(series.info);
+    }
+    return result;
+}
+
+std::vector<LatencyMonitor::Sample> LatencyMonitor::history(const std::string& event) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Sample> result;
+    auto it = events_.find(event);
+    if (it == events_.end()) return result;
+
+    const auto& series = it->second;
+    for (size_t i = 0; i < HISTORY_SIZE; ++i) {
+        const auto& sample = series.samples[(series.next + i) % HISTORY_SIZE];
+        if (sample.time != 0) {
+            result.push_back(sample);
+        }
+    }
+    return result;
+}
+
+size_t LatencyMonitor::reset(const std::vector<std::string>& events) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (events.empty()) {
+        size_t count = events_.size();
+        events_.clear();
+        return count;
+    }
+    size_t count = 0;
+    for (const auto& event : events) {
+        count += events_.erase(event);
+    }
+    return count;
+}
+
+std::string LatencyMonitor::doctor() const {
+    auto events = latest();
+    std::ostringstream ss;
+
+    if (threshold_ms() == 0) {
+        ss << "Latency monitoring is disabled (monitor threshold is 0).\n";
+        return ss.str();
+    }
+    if (events.empty()) {
+        ss << "No latency spikes above " << threshold_ms() << " ms were observed. Nothing to report.\n";
+        return ss.str();
+    }
+
+    ss << "Latency spikes above " << threshold_ms() << " ms were observed:\n\n";
+    int index = 1;
+    for (const auto& event : events) {
+        uint64_t avg = event.count > 0 ? event.total_latency_ms / event.count : 0;
+        ss << index++ << ". " << event.name << ": " << event.count << " latency spikes (average "
+           << avg << "ms, max " << event.max_latency_ms << "ms, latest " << event.latest.latency_ms
+           << "ms).\n";
+    }
+
+    ss << "\nAdvice:\n";
+    for (const auto& event : events) {
+        if (event.name == "event-loop-stall") {
+            ss << "- A worker event loop was blocked; every client on that worker waited for it. "
+                  "Check the captured stack below for large evictions, rehashes or blocking sends, "
+                  "and consider splitting hot or very large keys.\n";
+        } else if (event.name == "command") {
+            ss << "- Slow commands were executed. Use INFO to find commands with high max_time "
+                  "and avoid large multi-key requests on latency-sensitive connections.\n";
+        } else {
+            ss << "- " << event.name << ": check the server logs around the reported times.\n";
+        }
+    }
+
+    for (const auto& event : events) {
+        if (!event.last_detail.empty()) {
+            ss << "\nLast " << event.name << " sample:\n" << event.last_detail;
+            if (event.last_detail.back() != '\n') ss << "\n";
+        }
+    }
+    return ss.str();
+}
@@ -0,0 +1,58 @@
+#include "LazyFree.h"
+
+LazyFree::LazyFree() = default;
+
+LazyFree::~LazyFree() {
+    TaskScheduler::TaskId task;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task = task_;
+    }
+    // 取消尚未开始的释放任务，正在执行的等待其结束，剩余对象就地释放
+    if (task != 0) {
+        TaskScheduler::instance().cancel(task);
+    }
+    drain();
+}
+
+void LazyFree::enqueue(std::shared_ptr<void> object) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(object));
+    if (task_ != 0) return;
+
+    // 持锁提交：释放任务开始执行前需要拿到同一把锁，task_ 不会被提前清零。
+    // 调度器已停止（返回 0）时对象留在队列中，析构时释放
+    TaskScheduler::TaskOptions options;
+    options.name = "lazyfree";
+    options.priority = TaskScheduler::Priority::LOW;
+    task_ = TaskScheduler::instance().schedule([this] { drain(); }, options);
+}
+
+void LazyFree::drain() {
+    std::deque<std::shared_ptr<void>> batch;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.empty()) {
+                task_ = 0;  // 之后入队的对象会提交新的任务
+                return;
+            }
+            batch.swap(queue_);
+        }
+
+        // 逐个析构，不持有队列锁
+        while (!batch.empty()) {
+            batch.pop_front();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            freed_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+LazyFree::Stats LazyFree::stats() const {
+    Stats stats;
+    stats.pending = pending_.load(std::memory_order_relaxed);
+    stats.freed = freed_.load(std::memory_order_relaxed);
+    return stats;
+}
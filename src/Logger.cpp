@@ -0,0 +1,241 @@
+#include "Logger.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstring>
+#include <ctime>
+
+namespace {
+    int64_t now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    size_t round_up_pow2(size_t v) {
+        size_t p = 1;
+        while (p < v) p <<= 1;
+        return p;
+    }
+
+    std::mutex g_write_mutex;  // 同步写出模式下避免多行交错
+}
+
+// Ring实现
+Logger::Ring::Ring(size_t capacity)
+    : mask(round_up_pow2(std::max<size_t>(capacity, 16)) - 1)
+    , records(std::make_unique<Record[]>(mask + 1)) {
+}
+
+bool Logger::Ring::push(const Record& record) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) > mask) {
+        return false;  // 已满
+    }
+    auto& slot = records[h & mask];
+    slot.timestamp_us = record.timestamp_us;
+    slot.level = record.level;
+    slot.length = record.length;
+    std::memcpy(slot.message, record.message, record.length);
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+bool Logger::Ring::pop(Record& record) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) {
+        return false;  // 为空
+    }
+    const auto& slot = records[t & mask];
+    record.timestamp_us = slot.timestamp_us;
+    record.level = slot.level;
+    record.length = slot.length;
+    std::memcpy(record.message, slot.message, slot.length);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+// Logger实现
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::~Logger() {
+    stop();
+}
+
+void Logger::start(const Options& options) {
+    if (running_.load()) return;
+
+    level_.store(options.level, std::memory_order_relaxed);
+    rate_limit_.store(options.rate_limit_per_sec, std::memory_order_relaxed);
+    ring_capacity_ = options.ring_capacity;
+    flush_interval_ = options.flush_interval;
+
+    running_ = true;
+    drain_thread_ = std::thread(&Logger::drain_loop, this);
+}
+
+void Logger::stop() {
+    if (!running_.exchange(false)) return;
+    if (drain_thread_.joinable()) {
+        drain_thread_.join();
+    }
+
+    // 输出剩余日志
+    std::string out;
+    drain_once(out);
+}
+
+void Logger::log(Level level, CallSite& site, const char* fmt, ...) {
+    Record record;
+    record.timestamp_us = now_us();
+    record.level = level;
+
+    // 每个调用点按秒窗口限速
+    uint32_t carried = 0;
+    uint32_t limit = rate_limit_.load(std::memory_order_relaxed);
+    if (limit > 0) {
+        int64_t second = record.timestamp_us / 1000000;
+        int64_t window = site.window.load(std::memory_order_relaxed);
+        if (window != second && site.window.compare_exchange_strong(window, second)) {
+            site.count.store(0, std::memory_order_relaxed);
+            carried = site.suppressed.exchange(0, std::memory_order_relaxed);
+        }
+        if (site.count.fetch_add(1, std::memory_order_relaxed) >= limit) {
+            site.suppressed.fetch_add(1, std::memory_order_relaxed);
+            suppressed_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    int n = std::vsnprintf(record.message, MESSAGE_SIZE, fmt, args);
+    va_end(args);
+    size_t length = n < 0 ? 0 : std::min<size_t>(n, MESSAGE_SIZE - 1);
+
+    if (carried > 0 && length < MESSAGE_SIZE - 1) {
+        int m = std::snprintf(record.message + length, MESSAGE_SIZE - length,
+                              " (%u similar messages suppressed)", carried);
+        if (m > 0) length = std::min<size_t>(length + m, MESSAGE_SIZE - 1);
+    }
+    record.length = static_cast<uint16_t>(length);
+
+    if (!running_.load(std::memory_order_relaxed)) {
+        // 后台线程未运行：同步写出
+        std::string out;
+        format_record(out, record);
+        write_out(out);
+        return;
+    }
+
+    if (!local_ring()->push(record)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+Logger::Ring* Logger::local_ring() {
+    // 线程退出时标记缓冲区为已退役，由后台线程在排空后回收
+    struct Holder {
+        std::shared_ptr<Ring> ring;
+        ~Holder() {
+            if (ring) ring->retired.store(true, std::memory_order_release);
+        }
+    };
+    thread_local Holder holder;
+
+    if (!holder.ring) {
+        holder.ring = std::make_shared<Ring>(ring_capacity_);
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.push_back(holder.ring);
+    }
+    return holder.ring.get();
+}
+
+void Logger::drain_loop() {
+    std::string out;
+    out.reserve(64 * 1024);
+    while (running_.load(std::memory_order_relaxed)) {
+        out.clear();
+        if (drain_once(out) == 0) {
+            std::this_thread::sleep_for(flush_interval_);
+        }
+    }
+}
+
+size_t Logger::drain_once(std::string& out) {
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        // 回收已退役且排空的缓冲区
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<Ring>& ring) {
+            return ring->retired.load(std::memory_order_acquire) &&
+                   ring->tail.load(std::memory_order_relaxed) == ring->head.load(std::memory_order_acquire);
+        }), rings_.end());
+        rings = rings_;
+    }
+
+    // 汇集所有线程的日志后按时间排序，保持跨线程的大致先后顺序
+    std::vector<Record> batch;
+    Record record;
+    for (auto& ring : rings) {
+        while (ring->pop(record)) {
+            batch.push_back(record);
+        }
+    }
+    if (batch.empty()) return 0;
+
+    std::stable_sort(batch.begin(), batch.end(), [](const Record& a, const Record& b) {
+        return a.timestamp_us < b.timestamp_us;
+    });
+
+    out.clear();
+    for (const auto& r : batch) {
+        format_record(out, r);
+    }
+    write_out(out);
+    return batch.size();
+}
+
+void Logger::format_record(std::string& out, const Record& record) {
+    time_t seconds = static_cast<time_t>(record.timestamp_us / 1000000);
+    int millis = static_cast<int>((record.timestamp_us / 1000) % 1000);
+    tm local{};
+    localtime_r(&seconds, &local);
+
+    char prefix[64];
+    int n = std::snprintf(prefix, sizeof(prefix), "[%04d-%02d-%02d %02d:%02d:%02d.%03d] [%s] ",
+                          local.tm_year + 1900, local.tm_mon + 1, local.tm_mday,
+                          local.tm_hour, local.tm_min, local.tm_sec, millis, level_name(record.level));
+    out.append(prefix, n > 0 ? n : 0);
+    out.append(record.message, record.length);
+    out.push_back('\n');
+}
+
+void Logger::write_out(const std::string& out) {
+    std::lock_guard<std::mutex> lock(g_write_mutex);
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    std::fflush(stdout);
+}
+
+bool Logger::parse_level(const std::string& name, Level& level) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    if (lower == "debug") level = Level::Debug;
+    else if (lower == "info" || lower == "notice" || lower == "verbose") level = Level::Info;
+    else if (lower == "warning" || lower == "warn") level = Level::Warning;
+    else if (lower == "error") level = Level::Error;
+    else if (lower == "off" || lower == "none") level = Level::Off;
+    else return false;
+    return true;
+}
+
+const char* Logger::level_name(Level level) {
+    switch (level) {
+        case Level::Debug: return "DEBUG";
+        case Level::Info: return "INFO";
+        case Level::Warning: return "WARN";
+        case Level::Error: return "ERROR";
+        default: return "OFF";
+    }
+}
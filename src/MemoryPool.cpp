@@ -1,6 +1,10 @@
 #include "MemoryPool.h"
 #include <cstdlib>
 
+std::atomic<size_t> MemoryBlockPool::global_reserved_bytes_{0};
+ShardedCounter MemoryBlockPool::global_used_bytes_;
+std::atomic<size_t> MemoryBlockPool::global_chunks_{0};
+
 MemoryBlockPool::MemoryBlockPool(size_t block_size, size_t initial_blocks)
     : block_size_(block_size)
     , blocks_per_chunk_(calculate_blocks_per_chunk(block_size))
@@ -23,6 +27,7 @@ void* MemoryBlockPool::allocate() {
     void* block = next_free_;
     next_free_ = *reinterpret_cast<void**>(next_free_);
     ++allocated_blocks_;
+    global_used_bytes_.add(static_cast<int64_t>(block_size_));
     return block;
 }
 
@@ -33,6 +38,7 @@ void MemoryBlockPool::deallocate(void* block) {
     next_free_ = block;
     if (allocated_blocks_ > 0) {
         --allocated_blocks_;
+        global_used_bytes_.sub(static_cast<int64_t>(block_size_));
     }
 }
 
@@ -41,6 +47,10 @@ void MemoryBlockPool::clear() {
     for (void* chunk : allocated_chunks_) {
         ::free(chunk);
     }
+    global_reserved_bytes_.fetch_sub(allocated_chunks_.size() * blocks_per_chunk_ * block_size_,
+                                     std::memory_order_relaxed);
+    global_chunks_.fetch_sub(allocated_chunks_.size(), std::memory_order_relaxed);
+    global_used_bytes_.sub(static_cast<int64_t>(allocated_blocks_ * block_size_));
     allocated_chunks_.clear();
     next_free_ = nullptr;
     allocated_blocks_ = 0;
@@ -60,6 +70,14 @@ size_t MemoryBlockPool::allocated_chunks() const {
     return allocated_chunks_.size();
 }
 
+MemoryBlockPool::GlobalStats MemoryBlockPool::global_stats() {
+    GlobalStats stats;
+    stats.reserved_bytes = global_reserved_bytes_.load(std::memory_order_relaxed);
+    stats.used_bytes = global_used_bytes_.load();
+    stats.chunks = global_chunks_.load(std::memory_order_relaxed);
+    return stats;
+}
+
 size_t MemoryBlockPool::calculate_blocks_per_chunk(size_t block_size) {
     if (block_size <= 32) return 512;
     if (block_size <= 64) return 256;
@@ -80,6 +98,8 @@ void MemoryBlockPool::allocate_chunk() {
         throw std::bad_alloc();
     }
     allocated_chunks_.push_back(chunk);
+    global_reserved_bytes_.fetch_add(chunk_size, std::memory_order_relaxed);
+    global_chunks_.fetch_add(1, std::memory_order_relaxed);
     char* chunk_ptr = static_cast<char*>(chunk);
     for (size_t i = 0; i < blocks_per_chunk_ - 1; ++i) {
         void* current_block = chunk_ptr + i * block_size_;
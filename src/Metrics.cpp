@@ -0,0 +1,71 @@
+#include "Metrics.h"
+#include <algorithm>
+
+namespace {
+    std::atomic<uint64_t> g_next_metrics_id{1};
+}
+
+CommandMetrics::CommandMetrics()
+    : id_(g_next_metrics_id.fetch_add(1, std::memory_order_relaxed)) {
+}
+
+size_t CommandMetrics::register_command(const std::string& name) {
+    for (size_t i = 0; i < names_.size(); ++i) {
+        if (names_[i] == name) return i;
+    }
+    names_.push_back(name);
+    return names_.size() - 1;
+}
+
+CommandMetrics::Slot* CommandMetrics::local_slots() {
+    // 每个线程按实例ID保存注册（同 HotKeyTracker / 近端缓存），
+    // 多个实例在同一线程交替记录时各自复用已注册的计数槽
+    thread_local std::vector<std::pair<uint64_t, Slot*>> refs;
+    for (const auto& ref : refs) {
+        if (ref.first == id_) return ref.second;
+    }
+
+    // 首次在本线程记录：分配一组独立的计数槽并注册
+    auto thread_slots = std::make_unique<ThreadSlots>();
+    thread_slots->count = names_.size();
+    thread_slots->slots = std::make_unique<Slot[]>(thread_slots->count);
+    Slot* slots = thread_slots->slots.get();
+    refs.emplace_back(id_, slots);
+
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    threads_.push_back(std::move(thread_slots));
+    return slots;
+}
+
+std::vector<CommandMetrics::Snapshot> CommandMetrics::snapshot() const {
+    std::vector<Snapshot> result(names_.size());
+    for (size_t i = 0; i < names_.size(); ++i) {
+        result[i].name = names_[i];
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(threads_mutex_);
+        for (const auto& thread_slots : threads_) {
+            for (size_t i = 0; i < thread_slots->count && i < result.size(); ++i) {
+                const auto& slot = thread_slots->slots[i];
+                auto& snap = result[i];
+                snap.calls += slot.calls.load(std::memory_order_relaxed);
+                snap.total_time_us += slot.total_time_us.load(std::memory_order_relaxed);
+                snap.max_time_us = std::max(snap.max_time_us, slot.max_time_us.load(std::memory_order_relaxed));
+                snap.min_time_us = std::min(snap.min_time_us, slot.min_time_us.load(std::memory_order_relaxed));
+                for (size_t b = 0; b < BUCKET_COUNT; ++b) {
+                    snap.buckets[b] += slot.buckets[b].load(std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    // 只保留被调用过的命令
+    std::vector<Snapshot> called;
+    for (auto& snap : result) {
+        if (snap.calls > 0) {
+            called.push_back(std::move(snap));
+        }
+    }
+    return called;
+}
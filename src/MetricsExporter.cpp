@@ -0,0 +1,141 @@
+#include "MetricsExporter.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+MetricsExporter::MetricsExporter(std::string host, int port, RenderFunc render)
+    : host_(std::move(host)), port_(port), render_(std::move(render)) {
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+void MetricsExporter::start() {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        throw std::runtime_error("Failed to create metrics socket");
+    }
+
+    int opt = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(host_.c_str());
+    addr.sin_port = htons(port_);
+
+    if (bind(listen_fd_, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd_, 16) < 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+        throw std::runtime_error("Failed to bind metrics socket on port " + std::to_string(port_));
+    }
+
+    running_ = true;
+    thread_ = std::thread(&MetricsExporter::serve_loop, this);
+}
+
+void MetricsExporter::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+    }
+}
+
+void MetricsExporter::serve_loop() {
+    while (running_) {
+        // 使用超时poll，保证stop()能及时退出
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        int n = poll(&pfd, 1, 200);
+        if (n <= 0) continue;
+
+        int client_fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client_fd < 0) continue;
+
+        handle_connection(client_fd);
+        close(client_fd);
+    }
+}
+
+void MetricsExporter::handle_connection(int client_fd) {
+    // 慢客户端不能卡住导出线程
+    timeval tv{1, 0};
+    setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    std::string request;
+    char buf[2048];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        ssize_t n = recv(client_fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        request.append(buf, n);
+    }
+
+    std::string status = "200 OK";
+    std::string content_type = "text/plain; version=0.0.4; charset=utf-8";
+    std::string body;
+
+    if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 13, "GET /metrics?") == 0) {
+        body = render_();
+    } else if (request.compare(0, 4, "GET ") == 0) {
+        status = "404 Not Found";
+        body = "Not Found. Metrics are served at /metrics\n";
+    } else {
+        status = "405 Method Not Allowed";
+        body = "Method Not Allowed\n";
+    }
+
+    std::string response;
+    response.reserve(body.size() + 160);
+    response = "HTTP/1.1 " + status + "\r\n";
+    response += "Content-Type: " + content_type + "\r\n";
+    response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += body;
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t n = send(client_fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        sent += n;
+    }
+}
+
+namespace prometheus {
+
+void header(std::string& out, const std::string& name, const std::string& type, const std::string& help) {
+    out += "# HELP " + name + " " + help + "\n";
+    out += "# TYPE " + name + " " + type + "\n";
+}
+
+void sample(std::string& out, const std::string& name, const std::string& labels, double value) {
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.9g", value);
+    out += name;
+    if (!labels.empty()) {
+        out += "{" + labels + "}";
+    }
+    out += " ";
+    out += buf;
+    out += "\n";
+}
+
+void sample(std::string& out, const std::string& name, const std::string& labels, uint64_t value) {
+    out += name;
+    if (!labels.empty()) {
+        out += "{" + labels + "}";
+    }
+    out += " " + std::to_string(value) + "\n";
+}
+
+} // namespace prometheus
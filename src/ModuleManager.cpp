@@ -0,0 +1,317 @@
+#include "ModuleManager.h"
+#include "Logger.h"
+#include "simple_redis_module.h"
+#include <dlfcn.h>
+#include <charconv>
+#include <deque>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    struct CommandSpec {
+        std::string name;
+        sr_command_fn fn = nullptr;
+        int arity = 0;
+        int first_key = 0;
+        int last_key = 0;
+        int key_step = 0;
+    };
+
+    std::string lowercase(const char* s) {
+        std::string out(s);
+        for (auto& c : out) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return out;
+    }
+
+    // 简单字符串/错误回复中不能出现换行，否则会破坏协议
+    void append_line(std::string& out, const char* text) {
+        for (const char* p = text; *p; ++p) {
+            out.push_back(*p == '\r' || *p == '\n' ? ' ' : *p);
+        }
+        out += "\r\n";
+    }
+}
+
+struct ModuleManager::Module {
+    void* handle = nullptr;
+    std::string path;
+    std::string name;
+    int version = 0;
+    std::vector<CommandSpec> commands;
+
+    ~Module() {
+        if (handle) dlclose(handle);
+    }
+};
+
+// 加载上下文：只在 sr_module_onload 执行期间有效
+struct sr_module {
+    ModuleManager::Module* module;
+    const std::function<bool(const std::string&)>* command_exists;
+    std::string error;
+};
+
+// 一次命令调用：键锁由调用方持有，get 返回的值保存在 values 中直到命令返回
+struct sr_call {
+    DataStore::KeyGuard& guard;
+    std::string reply;
+    std::deque<std::string> values;
+
+    explicit sr_call(DataStore::KeyGuard& g) : guard(g) {}
+};
+
+namespace {
+    int api_set_name(sr_module* ctx, const char* name, int version) {
+        if (!name || !*name) return SR_MODULE_ERR;
+        ctx->module->name = name;
+        ctx->module->version = version;
+        return SR_MODULE_OK;
+    }
+
+    int api_register_command(sr_module* ctx, const char* name, sr_command_fn fn,
+                             int arity, int first_key, int last_key, int key_step) {
+        if (!name || !*name || !fn || first_key < 0) {
+            ctx->error = "invalid command registration";
+            return SR_MODULE_ERR;
+        }
+        if (first_key > 0 && (key_step < 1 || (last_key >= 0 && last_key < first_key))) {
+            ctx->error = std::string("invalid key specification for command '") + name + "'";
+            return SR_MODULE_ERR;
+        }
+        CommandSpec spec;
+        spec.name = lowercase(name);
+        for (const auto& existing : ctx->module->commands) {
+            if (existing.name == spec.name) {
+                ctx->error = "command '" + spec.name + "' registered twice";
+                return SR_MODULE_ERR;
+            }
+        }
+        if ((*ctx->command_exists)(spec.name)) {
+            ctx->error = "command '" + spec.name + "' already exists";
+            return SR_MODULE_ERR;
+        }
+        spec.fn = fn;
+        spec.arity = arity;
+        spec.first_key = first_key;
+        spec.last_key = last_key;
+        spec.key_step = key_step;
+        ctx->module->commands.push_back(std::move(spec));
+        return SR_MODULE_OK;
+    }
+
+    void api_log(sr_module* ctx, int level, const char* message) {
+        const char* name = ctx->module->name.empty() ? ctx->module->path.c_str() : ctx->module->name.c_str();
+        switch (level) {
+            case SR_MODULE_LOG_DEBUG: LOG_DEBUG("[module %s] %s", name, message); break;
+            case SR_MODULE_LOG_INFO: LOG_INFO("[module %s] %s", name, message); break;
+            case SR_MODULE_LOG_WARNING: LOG_WARN("[module %s] %s", name, message); break;
+            default: LOG_ERROR("[module %s] %s", name, message); break;
+        }
+    }
+
+    int api_get(sr_call* call, sr_slice key, sr_slice* value) {
+        std::string k(key.ptr, key.len);
+        if (!call->guard.holds(k)) return SR_MODULE_ERR;
+        auto found = call->guard.get(k);
+        if (!found) return 0;
+        const auto& stored = call->values.emplace_back(std::move(*found));
+        value->ptr = stored.data();
+        value->len = stored.size();
+        return 1;
+    }
+
+    int api_key_type(sr_call* call, sr_slice key) {
+        sr_slice value;
+        int found = api_get(call, key, &value);
+        if (found < 0) return SR_MODULE_ERR;
+        return found ? SR_MODULE_KEYTYPE_STRING : SR_MODULE_KEYTYPE_EMPTY;
+    }
+
+    int api_get_integer(sr_call* call, sr_slice key, long long* value) {
+        sr_slice raw;
+        int found = api_get(call, key, &raw);
+        if (found <= 0) return found;
+        auto [end, ec] = std::from_chars(raw.ptr, raw.ptr + raw.len, *value);
+        if (ec != std::errc() || end != raw.ptr + raw.len || raw.len == 0) return SR_MODULE_ERR;
+        return 1;
+    }
+
+    int api_set(sr_call* call, sr_slice key, sr_slice value) {
+        std::string k(key.ptr, key.len);
+        if (!call->guard.holds(k)) return SR_MODULE_ERR;
+        call->guard.set(k, std::string_view(value.ptr, value.len));
+        return SR_MODULE_OK;
+    }
+
+    int api_set_integer(sr_call* call, sr_slice key, long long value) {
+        std::string text = std::to_string(value);
+        return api_set(call, key, sr_slice{text.data(), text.size()});
+    }
+
+    int api_del(sr_call* call, sr_slice key) {
+        std::string k(key.ptr, key.len);
+        if (!call->guard.holds(k)) return SR_MODULE_ERR;
+        return call->guard.del(k) ? 1 : 0;
+    }
+
+    void api_reply_simple(sr_call* call, const char* status) {
+        call->reply.push_back('+');
+        append_line(call->reply, status);
+    }
+
+    void api_reply_error(sr_call* call, const char* message) {
+        // 以 '-' 开头时视为自带错误码（如 "-WRONGTYPE ..."），否则补上通用的 ERR
+        if (message[0] == '-') {
+            append_line(call->reply, message);
+        } else {
+            call->reply += "-ERR ";
+            append_line(call->reply, message);
+        }
+    }
+
+    void api_reply_integer(sr_call* call, long long value) {
+        call->reply.push_back(':');
+        call->reply += std::to_string(value);
+        call->reply += "\r\n";
+    }
+
+    void api_reply_bulk(sr_call* call, const char* data, size_t len) {
+        call->reply.push_back('$');
+        call->reply += std::to_string(len);
+        call->reply += "\r\n";
+        call->reply.append(data, len);
+        call->reply += "\r\n";
+    }
+
+    void api_reply_null(sr_call* call) {
+        call->reply += "$-1\r\n";
+    }
+
+    void api_reply_array(sr_call* call, size_t count) {
+        call->reply.push_back('*');
+        call->reply += std::to_string(count);
+        call->reply += "\r\n";
+    }
+
+    const sr_module_api module_api = {
+        SR_MODULE_API_VERSION,
+        sizeof(sr_module_api),
+        api_set_name,
+        api_register_command,
+        api_log,
+        api_key_type,
+        api_get,
+        api_get_integer,
+        api_set,
+        api_set_integer,
+        api_del,
+        api_reply_simple,
+        api_reply_error,
+        api_reply_integer,
+        api_reply_bulk,
+        api_reply_null,
+        api_reply_array,
+    };
+
+    std::string execute(DataStore& store, const CommandSpec& spec, const std::vector<std::string>& args) {
+        int argc = static_cast<int>(args.size());
+        if ((spec.arity > 0 && argc != spec.arity) || (spec.arity < 0 && argc < -spec.arity)) {
+            return "-ERR wrong number of arguments for '" + spec.name + "' command\r\n";
+        }
+
+        // 按声明的键位置收集键，执行期间全部持有写锁
+        std::vector<std::string> keys;
+        if (spec.first_key > 0) {
+            int last = spec.last_key < 0 ? argc + spec.last_key : spec.last_key;
+            for (int i = spec.first_key; i <= last && i < argc; i += spec.key_step) {
+                keys.push_back(args[i]);
+            }
+        }
+        auto guard = store.lock_keys(keys);
+
+        std::vector<sr_slice> argv;
+        argv.reserve(args.size());
+        for (const auto& arg : args) {
+            argv.push_back(sr_slice{arg.data(), arg.size()});
+        }
+
+        sr_call call(guard);
+        int rc = spec.fn(&call, argc, argv.data());
+        if (call.reply.empty()) {
+            return rc == SR_MODULE_OK
+                ? "-ERR module command '" + spec.name + "' did not reply\r\n"
+                : "-ERR module command '" + spec.name + "' failed\r\n";
+        }
+        return std::move(call.reply);
+    }
+}
+
+ModuleManager::ModuleManager(std::shared_ptr<DataStore> store)
+    : store_(std::move(store)) {}
+
+ModuleManager::~ModuleManager() = default;
+
+std::vector<ModuleManager::Command> ModuleManager::load(
+        const std::string& spec, const std::function<bool(const std::string&)>& command_exists) {
+    std::istringstream iss(spec);
+    std::string path;
+    std::vector<std::string> args;
+    iss >> path;
+    for (std::string arg; iss >> arg;) {
+        args.push_back(arg);
+    }
+    if (path.empty()) {
+        throw std::runtime_error("empty module specification");
+    }
+
+    auto module = std::make_unique<Module>();
+    module->path = path;
+    module->handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!module->handle) {
+        throw std::runtime_error("cannot load module " + path + ": " + dlerror());
+    }
+    auto onload = reinterpret_cast<sr_module_onload_fn>(dlsym(module->handle, SR_MODULE_ONLOAD_SYMBOL));
+    if (!onload) {
+        throw std::runtime_error("module " + path + " does not export " SR_MODULE_ONLOAD_SYMBOL);
+    }
+
+    std::vector<const char*> argv;
+    for (const auto& arg : args) {
+        argv.push_back(arg.c_str());
+    }
+    sr_module ctx{module.get(), &command_exists, {}};
+    if (onload(&ctx, &module_api, static_cast<int>(argv.size()), argv.data()) != SR_MODULE_OK) {
+        throw std::runtime_error("module " + path + " failed to load" +
+                                 (ctx.error.empty() ? std::string() : ": " + ctx.error));
+    }
+    if (module->name.empty()) {
+        throw std::runtime_error("module " + path + " did not call set_name");
+    }
+
+    std::vector<Command> commands;
+    DataStore* store = store_.get();
+    for (const auto& command : module->commands) {
+        commands.push_back(Command{command.name, [store, command](const std::vector<std::string>& cmd_args) {
+            return execute(*store, command, cmd_args);
+        }});
+    }
+    LOG_INFO("Module %s v%d loaded from %s (%zu commands)",
+             module->name.c_str(), module->version, path.c_str(), commands.size());
+    modules_.push_back(std::move(module));
+    return commands;
+}
+
+std::vector<ModuleManager::ModuleInfo> ModuleManager::list() const {
+    std::vector<ModuleInfo> infos;
+    for (const auto& module : modules_) {
+        ModuleInfo info;
+        info.name = module->name;
+        info.version = module->version;
+        info.path = module->path;
+        for (const auto& command : module->commands) {
+            info.commands.push_back(command.name);
+        }
+        infos.push_back(std::move(info));
+    }
+    return infos;
+}
@@ -0,0 +1,65 @@
+#include "NearCache.h"
+
+void NearCache::set_capacity(size_t capacity) {
+    if (capacity < entries_.size()) {
+        entries_.clear();
+        entry_count_.store(0, std::memory_order_relaxed);
+    }
+    capacity_ = capacity;
+}
+
+const std::string* NearCache::find(const std::string& key) {
+    if (entries_.empty()) return nullptr;
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return nullptr;
+    if (!it->second.version.current()) {
+        // 子map在填充之后有写入提交：条目作废，由下一次热点准入重新填充
+        entries_.erase(it);
+        single_writer_add(invalidations_);
+        entry_count_.store(entries_.size(), std::memory_order_relaxed);
+        return nullptr;
+    }
+    it->second.last_hit = ++tick_;
+    single_writer_add(hits_);
+    return &it->second.value;
+}
+
+bool NearCache::admit(const std::string& key, DataStore& store, std::string& value) {
+    DataStore::Version version;
+    if (!store.get_versioned(key, value, version)) {
+        entries_.erase(key);
+        entry_count_.store(entries_.size(), std::memory_order_relaxed);
+        return false;
+    }
+    if (capacity_ == 0 || value.size() > MAX_VALUE_SIZE) {
+        return true;
+    }
+
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        if (entries_.size() >= capacity_) {
+            // 替换最久未命中的条目（只在准入时发生，容量很小，线性扫描即可）
+            auto victim = entries_.begin();
+            for (auto e = entries_.begin(); e != entries_.end(); ++e) {
+                if (e->second.last_hit < victim->second.last_hit) victim = e;
+            }
+            entries_.erase(victim);
+        }
+        it = entries_.emplace(key, Entry{}).first;
+    }
+    it->second.value.assign(value);
+    it->second.version = version;
+    it->second.last_hit = ++tick_;
+    single_writer_add(admissions_);
+    entry_count_.store(entries_.size(), std::memory_order_relaxed);
+    return true;
+}
+
+NearCache::Stats NearCache::stats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.invalidations = invalidations_.load(std::memory_order_relaxed);
+    stats.admissions = admissions_.load(std::memory_order_relaxed);
+    stats.entries = entry_count_.load(std::memory_order_relaxed);
+    return stats;
+}
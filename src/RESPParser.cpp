@@ -1,289 +1,233 @@
 #include "RESPParser.h"
-#include <sstream>
-#include <cassert>
+#include <charconv>
 #include <cstring>
 
-// RESPValue方法实现
-std::vector<std::string> RESPParser::RESPValue::to_command() const {
-    if (type != Type::Array) {
-        return {}; // 命令必须是数组
+namespace {
+    // 一行（类型标记到 CRLF）的最大长度，超过仍找不到 CRLF 视为协议错误，避免缓冲区无限增长
+    constexpr size_t MAX_LINE_LENGTH = 64 * 1024;
+    // 嵌套数组的最大深度（命令中不应出现嵌套，只为安全跳过）
+    constexpr int MAX_NESTING_DEPTH = 8;
+    // 回收池上限：超出的命令数组直接释放
+    constexpr size_t MAX_SPARE_COMMANDS = 4096;
+}
+
+RESPParser::CommandList RESPParser::parse(std::string_view data) {
+    CommandList commands;
+    CommandList spare;
+    parse(data, commands, spare);
+    return commands;
+}
+
+void RESPParser::parse(std::string_view data, CommandList& commands, CommandList& spare) {
+    recycle(commands, spare);
+
+    // 没有残留数据时直接解析收到的数据，只把不完整的尾部拷入缓冲区
+    bool buffered = !buffer_.empty();
+    if (buffered) {
+        buffer_.append(data.data(), data.size());
     }
-    
-    std::vector<std::string> result;
-    result.reserve(array.size()); // 预分配空间
-    
-    for (const auto& element : array) {
-        if (element->type == Type::BulkString) {
-            result.emplace_back(element->value);
-        } else {
-            // 命令的所有元素都必须是批量字符串
-            return {};
+    std::string_view view = buffered ? std::string_view(buffer_) : data;
+
+    size_t pos = 0;
+    while (pos < view.size()) {
+        if (!is_type_marker(view[pos])) {
+            // 跳过无效数据直到找到有效的类型标记
+            ++pos;
+            continue;
         }
-    }
-    
-    return result;
-}
 
-// 实例方法
+        Command cmd;
+        if (!spare.empty()) {
+            cmd = std::move(spare.back());
+            spare.pop_back();
+        }
 
-std::vector<std::vector<std::string>> RESPParser::parse(std::string_view data) {
-    // 将新数据追加到缓冲区
-    size_t old_size = context_.buffer.size();
-    context_.buffer.append(data.data(), data.size());
-    
-    // 创建整个缓冲区的视图
-    std::string_view buffer_view(context_.buffer);
-    
-    // 尝试解析尽可能多的完整命令
-    while (true) {
-        auto resp_value = try_parse_next(buffer_view);
-        if (!resp_value) {
-            break; // 没有更多完整的命令
+        size_t start = pos;
+        bool is_command = false;
+        Result result = parse_message(view, pos, cmd, is_command);
+        if (result == Result::Complete && is_command) {
+            commands.push_back(std::move(cmd));
+            continue;
+        }
+        if (spare.size() < MAX_SPARE_COMMANDS) {
+            spare.push_back(std::move(cmd));
+        }
+        if (result == Result::Incomplete) {
+            // 数据不完整：回退到本条消息起点，等待更多数据后重新解析
+            pos = start;
+            break;
+        }
+        if (result == Result::Invalid) {
+            pos = start + 1;
         }
-        
-        // 添加到已完成命令列表
-        add_completed_command(std::move(*resp_value));
     }
-    
+
     // 压缩缓冲区 - 移除已处理的数据
-    if (context_.position > 0) {
-        context_.buffer.erase(0, context_.position);
-        context_.position = 0;
+    if (buffered) {
+        buffer_.erase(0, pos);
+    } else {
+        buffer_.assign(view.data() + pos, view.size() - pos);
     }
-    
-    // 返回所有完整的命令
-    return get_commands();
 }
 
-std::vector<std::vector<std::string>> RESPParser::get_commands() {
-    std::vector<std::vector<std::string>> commands;
-    commands.reserve(context_.completed_values.size()); // 预分配空间
-    
-    while (!context_.completed_values.empty()) {
-        auto value = std::move(context_.completed_values.front());
-        context_.completed_values.pop_front();
-        
-        auto cmd = value->to_command();
-        if (!cmd.empty()) {
-            commands.push_back(std::move(cmd));
+void RESPParser::recycle(CommandList& commands, CommandList& spare) {
+    for (auto& cmd : commands) {
+        // 被移走的命令（如转入慢命令等待队列）没有可复用的容量
+        if (cmd.capacity() > 0 && spare.size() < MAX_SPARE_COMMANDS) {
+            spare.push_back(std::move(cmd));
         }
     }
-    
-    return commands;
+    commands.clear();
 }
 
-std::optional<std::unique_ptr<RESPParser::RESPValue>> RESPParser::try_parse_next(std::string_view data) {
-    // 检查是否有足够的数据
-    if (context_.position >= data.size()) {
-        return std::nullopt;
+RESPParser::Result RESPParser::parse_message(std::string_view data, size_t& pos, Command& cmd, bool& is_command) {
+    if (data[pos] != '*') {
+        // 非数组的顶层消息不是命令，解析后丢弃
+        return skip_value(data, pos, 0);
     }
-    
-    // 根据当前字符决定解析方法
-    char type = data[context_.position];
-    std::optional<std::unique_ptr<RESPValue>> result;
-    
-    switch (type) {
-        case '+': // 简单字符串
-            result = parse_simple_string(data, context_.position);
-            break;
-        case '-': // 错误
-            result = parse_error(data, context_.position);
-            break;
-        case ':': // 整数
-            result = parse_integer(data, context_.position);
-            break;
-        case '$': // 批量字符串
-            result = parse_bulk_string(data, context_.position);
-            break;
-        case '*': // 数组
-            result = parse_array(data, context_.position);
-            break;
-        default: // 不支持的类型
-            // 尝试跳过无效数据直到找到有效的类型标记
-            while (context_.position < data.size() && 
-                   data[context_.position] != '+' && 
-                   data[context_.position] != '-' && 
-                   data[context_.position] != ':' && 
-                   data[context_.position] != '$' && 
-                   data[context_.position] != '*') {
-                context_.position++;
-            }
-            return std::nullopt;
-    }
-    
-    return result;
-}
 
-std::optional<std::unique_ptr<RESPParser::RESPValue>> RESPParser::parse_simple_string(std::string_view data, size_t& pos) {
-    pos++; // 跳过'+'
-    
-    size_t crlf = find_crlf(data, pos);
-    if (crlf == std::string::npos) {
-        // 数据不完整
-        return std::nullopt;
+    std::string_view line;
+    Result result = read_line(data, pos, line);
+    if (result != Result::Complete) {
+        return result;
+    }
+    long long count = 0;
+    if (!parse_length(line, count) || count > MAX_ARRAY_LENGTH) {
+        return Result::Invalid;
     }
-    
-    auto value = std::make_unique<RESPValue>();
-    value->type = RESPValue::Type::SimpleString;
-    value->value = data.substr(pos, crlf - pos);
-    
-    pos = crlf + 2; // 跳过\r\n
-    return value;
-}
 
-std::optional<std::unique_ptr<RESPParser::RESPValue>> RESPParser::parse_error(std::string_view data, size_t& pos) {
-    pos++; // 跳过'-'
-    
-    size_t crlf = find_crlf(data, pos);
-    if (crlf == std::string::npos) {
-        // 数据不完整
-        return std::nullopt;
+    size_t argc = 0;
+    bool all_bulk = true;
+    for (long long i = 0; i < count; ++i) {
+        if (pos >= data.size()) {
+            return Result::Incomplete;
+        }
+        if (data[pos] != '$') {
+            // 命令的所有元素都必须是批量字符串，否则整条消息丢弃
+            all_bulk = false;
+            result = skip_value(data, pos, 1);
+            if (result != Result::Complete) {
+                return result;
+            }
+            continue;
+        }
+
+        result = read_line(data, pos, line);
+        if (result != Result::Complete) {
+            return result;
+        }
+        long long len = 0;
+        if (!parse_length(line, len) || len > MAX_BULK_LENGTH) {
+            return Result::Invalid;
+        }
+        std::string_view arg;  // NULL 批量字符串作为空参数
+        if (len >= 0) {
+            if (data.size() - pos < static_cast<size_t>(len) + 2) {
+                return Result::Incomplete;
+            }
+            arg = data.substr(pos, static_cast<size_t>(len));
+            pos += static_cast<size_t>(len) + 2;  // 跳过字符串内容和\r\n
+        }
+
+        if (all_bulk) {
+            // 复用上次留下的参数字符串，容量足够时不分配
+            if (argc < cmd.size()) {
+                cmd[argc].assign(arg.data(), arg.size());
+            } else {
+                cmd.emplace_back(arg);
+            }
+            ++argc;
+        }
     }
-    
-    auto value = std::make_unique<RESPValue>();
-    value->type = RESPValue::Type::Error;
-    value->value = data.substr(pos, crlf - pos);
-    
-    pos = crlf + 2; // 跳过\r\n
-    return value;
-}
 
-std::optional<std::unique_ptr<RESPParser::RESPValue>> RESPParser::parse_integer(std::string_view data, size_t& pos) {
-    pos++; // 跳过':'
-    
-    size_t crlf = find_crlf(data, pos);
-    if (crlf == std::string::npos) {
-        // 数据不完整
-        return std::nullopt;
+    is_command = all_bulk && argc > 0;
+    if (is_command) {
+        cmd.resize(argc);
     }
-    
-    auto value = std::make_unique<RESPValue>();
-    value->type = RESPValue::Type::Integer;
-    value->value = data.substr(pos, crlf - pos);
-    
-    pos = crlf + 2; // 跳过\r\n
-    return value;
+    return Result::Complete;
 }
 
-std::optional<std::unique_ptr<RESPParser::RESPValue>> RESPParser::parse_bulk_string(std::string_view data, size_t& pos) {
-    pos++; // 跳过'$'
-    
-    size_t crlf = find_crlf(data, pos);
-    if (crlf == std::string::npos) {
-        // 数据不完整
-        return std::nullopt;
+RESPParser::Result RESPParser::skip_value(std::string_view data, size_t& pos, int depth) {
+    if (depth > MAX_NESTING_DEPTH) {
+        return Result::Invalid;
     }
-    
-    // 解析长度
-    std::string len_str(data.substr(pos, crlf - pos));
-    int len = std::stoi(len_str);
-    
-    pos = crlf + 2; // 跳过\r\n
-    
-    if (len < 0) {
-        // 处理NULL批量字符串
-        auto value = std::make_unique<RESPValue>();
-        value->type = RESPValue::Type::BulkString;
-        value->value = std::string_view();
-        return value;
+
+    char type = data[pos];
+    std::string_view line;
+    Result result = read_line(data, pos, line);
+    if (result != Result::Complete) {
+        return result;
     }
-    
-    // 检查是否有足够的数据
-    if (pos + len + 2 > data.size()) {
-        // 数据不完整
-        return std::nullopt;
+
+    switch (type) {
+        case '+': // 简单字符串
+        case '-': // 错误
+        case ':': // 整数
+            return Result::Complete;
+        case '$': { // 批量字符串
+            long long len = 0;
+            if (!parse_length(line, len) || len > MAX_BULK_LENGTH) {
+                return Result::Invalid;
+            }
+            if (len >= 0) {
+                if (data.size() - pos < static_cast<size_t>(len) + 2) {
+                    return Result::Incomplete;
+                }
+                pos += static_cast<size_t>(len) + 2;
+            }
+            return Result::Complete;
+        }
+        case '*': { // 数组
+            long long count = 0;
+            if (!parse_length(line, count) || count > MAX_ARRAY_LENGTH) {
+                return Result::Invalid;
+            }
+            for (long long i = 0; i < count; ++i) {
+                if (pos >= data.size()) {
+                    return Result::Incomplete;
+                }
+                result = skip_value(data, pos, depth + 1);
+                if (result != Result::Complete) {
+                    return result;
+                }
+            }
+            return Result::Complete;
+        }
+        default: // 不支持的类型
+            return Result::Invalid;
     }
-    
-    auto value = std::make_unique<RESPValue>();
-    value->type = RESPValue::Type::BulkString;
-    value->value = data.substr(pos, len);
-    
-    pos += len + 2; // 跳过字符串内容和\r\n
-    return value;
 }
 
-std::optional<std::unique_ptr<RESPParser::RESPValue>> RESPParser::parse_array(std::string_view data, size_t& pos) {
-    pos++; // 跳过'*'
-    
-    size_t crlf = find_crlf(data, pos);
-    if (crlf == std::string::npos) {
-        // 数据不完整
-        return std::nullopt;
+RESPParser::Result RESPParser::read_line(std::string_view data, size_t& pos, std::string_view& line) {
+    size_t crlf = find_crlf(data, pos + 1);
+    if (crlf == std::string_view::npos) {
+        return data.size() - pos > MAX_LINE_LENGTH ? Result::Invalid : Result::Incomplete;
     }
-    
-    // 解析数组长度
-    std::string len_str(data.substr(pos, crlf - pos));
-    int count = std::stoi(len_str);
-    
+    line = data.substr(pos + 1, crlf - pos - 1);
     pos = crlf + 2; // 跳过\r\n
-    
-    auto array = std::make_unique<RESPValue>();
-    array->type = RESPValue::Type::Array;
-    
-    if (count < 0) {
-        // NULL数组
-        return array;
-    }
-    
-    // 预分配数组空间
-    array->array.reserve(count);
-    
-    // 解析数组元素，避免递归调用
-    for (int i = 0; i < count; ++i) {
-        // 检查是否有足够的数据
-        if (pos >= data.size()) {
-            return std::nullopt;
-        }
-        
-        // 直接在这里解析元素，避免递归调用try_parse_next
-        char type = data[pos];
-        std::optional<std::unique_ptr<RESPValue>> element;
-        
-        switch (type) {
-            case '+': // 简单字符串
-                element = parse_simple_string(data, pos);
-                break;
-            case '-': // 错误
-                element = parse_error(data, pos);
-                break;
-            case ':': // 整数
-                element = parse_integer(data, pos);
-                break;
-            case '$': // 批量字符串
-                element = parse_bulk_string(data, pos);
-                break;
-            case '*': // 嵌套数组（保留递归处理）
-                element = parse_array(data, pos);
-                break;
-            default:
-                // 不支持的类型
-                return std::nullopt;
-        }
-        
-        if (!element) {
-            // 数据不完整
-            return std::nullopt;
-        }
-        
-        array->array.push_back(std::move(*element));
-    }
-    
-    return array;
+    return Result::Complete;
 }
 
-void RESPParser::add_completed_command(std::unique_ptr<RESPValue> value) {
-    // 只有数组类型才被视为命令
-    if (value && value->type == RESPValue::Type::Array) {
-        context_.completed_values.push_back(std::move(value));
+bool RESPParser::parse_length(std::string_view text, long long& value) {
+    if (text.empty()) {
+        return false;
     }
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
 }
 
 size_t RESPParser::find_crlf(std::string_view data, size_t start) {
     // 查找\r\n序列
-    for (size_t i = start; i < data.size() - 1; ++i) {
-        if (data[i] == '\r' && data[i + 1] == '\n') {
+    while (start + 1 < data.size()) {
+        const void* found = std::memchr(data.data() + start, '\r', data.size() - start - 1);
+        if (!found) {
+            break;
+        }
+        size_t i = static_cast<const char*>(found) - data.data();
+        if (data[i + 1] == '\n') {
             return i;
         }
+        start = i + 1;
     }
-    return std::string::npos;
+    return std::string_view::npos;
 }
@@ -1,44 +1,146 @@
 #include "RedisServer.h"
+#include "Config.h"
+#include "Logger.h"
+#include "LatencyMonitor.h"
+#include "CommandCapture.h"
 #include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <poll.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <unistd.h>
-#include <iostream>
+#include <algorithm>
 #include <cstring>
+#include <ctime>
+#include <cstdio>
 
 RedisServer::RedisServer(const Config& config)
     : config_(config), server_fd_(-1) {
     
+    // 后台任务调度器须在创建 DataStore 之前启动（落盘、缓存调整等任务在其中登记）
+    TaskScheduler::Options scheduler_options;
+    scheduler_options.threads = config.background_threads;
+    TaskScheduler::instance().start(scheduler_options);
+    
     // 创建简化的DataStore配置
     DataStore::Options ds_options;
     ds_options.shard_count = config.shard_count;
     ds_options.cache_size = config.cache_size_mb * 1000; // 转换为条目数
     ds_options.enable_compression = config.enable_compression;
+    ds_options.enable_cache = config.enable_cache;
+    ds_options.enable_persistence = config.enable_persistence;
     ds_options.persist_path = "./data/";
     ds_options.sync_interval = std::chrono::seconds(config.sync_interval_sec);
     ds_options.memory_pool_block_size = 4096;
-    ds_options.bucket_per_shard = 16;
+    ds_options.bucket_per_shard = config.bucket_per_shard;
     ds_options.cache_shards = config.shard_count;
     ds_options.cache_policy = CachePolicy::Type::LRU;
     ds_options.adaptive_cache_sizing = false; // 简化：关闭自适应
+    ds_options.lazyfree_threshold = config.lazyfree_threshold_kb * 1024;
     
     datastore_ = std::make_shared<DataStore>(ds_options);
-    handler_ = std::make_shared<CommandHandler>(datastore_);
+    // 热点键采样配置
+    HotKeyTracker::Options hotkey_options;
+    hotkey_options.enabled = config.enable_hotkeys;
+    hotkey_options.sample_rate = config.hotkey_sample_rate;
+    hotkey_options.sketch_capacity = config.hotkey_capacity;
+    
+    handler_ = std::make_shared<CommandHandler>(datastore_, hotkey_options);
+    for (const auto& module : config.modules) {
+        handler_->load_module(module);
+    }
     
     // 配置线程池选项，启用CPU亲和性
     ThreadPool::Options pool_options;
     pool_options.enable_cpu_affinity = true;
     pool_options.auto_detect_topology = true;
+    pool_options.slow_threads = config.slow_threads;
+    pool_options.slow_queue_limit = config.slow_queue_limit;
+    pool_options.admission.enabled = config.enable_admission;
+    pool_options.admission.target_us = config.admission_target_ms * 1000;
+    pool_options.admission.interval_ms = std::max<uint32_t>(1, config.admission_interval_ms);
+    pool_options.client_limits = config.client_limits;
+    pool_options.busy_poll.enabled = config.enable_busy_poll;
+    pool_options.busy_poll.window_us = config.busy_poll_window_us;
+    pool_options.busy_poll.socket_busy_poll_us = config.busy_poll_socket_us;
+    pool_options.steer_by_incoming_cpu = config.connection_steering == "incoming_cpu";
     // 可以根据需要自定义CPU分配
     // pool_options.custom_cpu_assignment = {0, 1, 2, 3, ...};
     
     worker_pool_ = std::make_unique<ThreadPool>(config.worker_threads, handler_, pool_options);
     
+    // 后台任务线程绑定到 Worker 未占用的 CPU；全部被占用时不绑定，交给内核调度
+    std::vector<int> background_cpus;
+    std::vector<int> worker_cpus = worker_pool_->worker_cpus();
+    for (int cpu : ThreadAffinity::get_current_thread_affinity()) {
+        if (std::find(worker_cpus.begin(), worker_cpus.end(), cpu) == worker_cpus.end()) {
+            background_cpus.push_back(cpu);
+        }
+    }
+    if (!background_cpus.empty()) {
+        TaskScheduler::instance().set_cpu_affinity(background_cpus);
+        LOG_INFO("Background tasks bound to %zu CPU(s) not used by workers", background_cpus.size());
+    }
+    handler_->set_max_set_run(config.batch_size);
+    handler_->set_near_cache_capacity(config.near_cache_entries);
+    setup_runtime_config();
+    
+    // 延迟监控与卡顿看门狗
+    LatencyMonitor::instance().set_threshold_ms(config.latency_monitor_threshold_ms);
+    if (config.enable_watchdog) {
+        Watchdog::Options watchdog_options;
+        watchdog_options.threshold = std::chrono::milliseconds(config.watchdog_threshold_ms);
+        watchdog_options.check_interval = std::chrono::milliseconds(
+            std::max<uint32_t>(1, config.watchdog_threshold_ms / 4));
+        watchdog_ = std::make_unique<Watchdog>(watchdog_options);
+        
+        auto heartbeats = worker_pool_->get_heartbeats();
+        for (size_t i = 0; i < heartbeats.size(); ++i) {
+            watchdog_->watch("worker-" + std::to_string(i), heartbeats[i]);
+        }
+    }
+    
     start_time_ = std::chrono::steady_clock::now();
 }
 
+void RedisServer::setup_runtime_config() {
+    config_registry_ = std::make_shared<ConfigRegistry>();
+    ::Config::register_parameters(config_, *config_registry_);
+    config_registry_->set_path(config_.config_file);
+    
+    // 可在运行时修改的参数：字段已由注册表写入 config_，这里使其生效
+    config_registry_->on_change("storage.cache_size_mb", [this] {
+        datastore_->set_cache_capacity(config_.cache_size_mb * 1000);
+    });
+    config_registry_->on_change("storage.cache_policy", [this] {
+        datastore_->set_cache_policy(CachePolicy::Type::LRU);  // 目前只有 LRU
+    });
+    config_registry_->on_change("storage.sync_interval_sec", [this] {
+        datastore_->set_sync_interval(std::chrono::seconds(config_.sync_interval_sec));
+    });
+    auto publish_limits = [this] { worker_pool_->set_client_limits(config_.client_limits); };
+    config_registry_->on_change("clients.ratelimit", publish_limits);
+    config_registry_->on_change("clients.output_buffer_limit", publish_limits);
+    config_registry_->on_change("clients.maxmemory_clients", publish_limits);
+    config_registry_->on_change("logging.level", [this] {
+        Logger::Level level;
+        if (Logger::parse_level(config_.log_level, level)) {
+            Logger::instance().set_level(level);
+        }
+    });
+    config_registry_->on_change("performance.batch_size", [this] {
+        handler_->set_max_set_run(config_.batch_size);
+    });
+    config_registry_->on_change("hotkeys.near_cache_entries", [this] {
+        handler_->set_near_cache_capacity(config_.near_cache_entries);
+    });
+    
+    handler_->set_config_registry(config_registry_);
+}
+
 RedisServer::~RedisServer() {
     stop();
 }
@@ -46,25 +148,61 @@ RedisServer::~RedisServer() {
 void RedisServer::run() {
     try {
         setup_server_socket();
-        std::cout << "Socket setup successful, server_fd = " << server_fd_ << std::endl;
+        LOG_INFO("Socket setup successful, server_fd = %d", server_fd_);
         
-        std::cout << "Optimized Redis Server starting on " << config_.host << ":" << config_.port << std::endl;
-        std::cout << "Configuration: " << config_.worker_threads << " workers, " 
-                  << config_.shard_count << " shards" << std::endl;
+        LOG_INFO("Optimized Redis Server starting on %s:%d", config_.host.c_str(), config_.port);
+        LOG_INFO("Configuration: %zu workers, %zu shards", config_.worker_threads, config_.shard_count);
         
         running_ = true;
         
         // 启动Worker线程池
         worker_pool_->start();
-        std::cout << "Worker pool started" << std::endl;
+        LOG_INFO("Worker pool started");
+        
+        if (watchdog_) {
+            watchdog_->start();
+            LOG_INFO("Event loop watchdog started (threshold %u ms)", config_.watchdog_threshold_ms);
+        }
+        
+        // 流量抓取
+        CommandCapture::instance().set_directory(config_.capture_dir);
+        if (config_.enable_capture) {
+            CommandCapture::Options capture_options;
+            capture_options.file_name = "capture-" + std::to_string(std::time(nullptr)) + ".trace";
+            capture_options.sample_rate = config_.capture_sample_rate;
+            capture_options.max_bytes = static_cast<uint64_t>(config_.capture_max_mb) * 1024 * 1024;
+            std::string error;
+            if (!CommandCapture::instance().start(capture_options, error)) {
+                LOG_ERROR("Failed to start command capture: %s", error.c_str());
+            }
+        }
         
         // 启动accept线程
         accept_thread_ = std::thread(&RedisServer::accept_loop, this);
-        std::cout << "Accept thread started" << std::endl;
+        LOG_INFO("Accept thread started");
+        
+        // 共享内存传输的握手监听
+        if (config_.enable_shm) {
+            setup_shm_socket();
+            shm_accept_thread_ = std::thread(&RedisServer::shm_accept_loop, this);
+            LOG_INFO("Shared memory transport listening on %s", config_.shm_path.c_str());
+        }
+        
+        // 周期统计输出（后台任务调度器）
+        TaskScheduler::TaskOptions stats_options;
+        stats_options.name = "stats";
+        stats_options.priority = TaskScheduler::Priority::LOW;
+        stats_options.delay = std::chrono::seconds(30);
+        stats_options.period = std::chrono::seconds(30);
+        stats_task_ = TaskScheduler::instance().schedule([this] { print_stats(); }, stats_options);
         
-        // 启动统计线程
-        stats_thread_ = std::thread(&RedisServer::print_stats_loop, this);
-        std::cout << "Stats thread started" << std::endl;
+        // 启动指标导出器
+        if (config_.enable_metrics) {
+            metrics_exporter_ = std::make_unique<MetricsExporter>(
+                config_.host, config_.metrics_port, [this] { return render_metrics(); });
+            metrics_exporter_->start();
+            LOG_INFO("Metrics exporter listening on %s:%d/metrics", config_.host.c_str(), config_.metrics_port);
+        }
         
         // 等待accept线程
         if (accept_thread_.joinable()) {
@@ -72,7 +210,7 @@ void RedisServer::run() {
         }
         
     } catch (const std::exception& e) {
-        std::cerr << "Error during server startup: " << e.what() << std::endl;
+        LOG_ERROR("Error during server startup: %s", e.what());
         running_ = false;
         throw;
     }
@@ -85,10 +223,28 @@ void RedisServer::stop() {
         accept_thread_.join();
     }
     
-    if (stats_thread_.joinable()) {
-        stats_thread_.join();
+    if (shm_accept_thread_.joinable()) {
+        shm_accept_thread_.join();
+    }
+    if (shm_fd_ >= 0) {
+        close(shm_fd_);
+        shm_fd_ = -1;
+        unlink(config_.shm_path.c_str());
+    }
+    
+    TaskScheduler::instance().cancel(stats_task_);
+    stats_task_ = 0;
+    
+    if (metrics_exporter_) {
+        metrics_exporter_->stop();
+    }
+    
+    if (watchdog_) {
+        watchdog_->stop();
     }
     
+    CommandCapture::instance().stop();
+    
     if (worker_pool_) {
         worker_pool_->stop();
     }
@@ -97,6 +253,12 @@ void RedisServer::stop() {
         close(server_fd_);
         server_fd_ = -1;
     }
+    
+    if (unix_fd_ >= 0) {
+        close(unix_fd_);
+        unix_fd_ = -1;
+        unlink(config_.unixsocket.c_str());
+    }
 }
 
 void RedisServer::setup_server_socket() {
@@ -121,6 +283,102 @@ void RedisServer::setup_server_socket() {
         close(server_fd_);
         throw std::runtime_error("Failed to listen on server socket");
     }
+    fcntl(server_fd_, F_SETFL, fcntl(server_fd_, F_GETFL, 0) | O_NONBLOCK);
+    
+    if (!config_.unixsocket.empty()) {
+        setup_unix_socket();
+    }
+}
+
+void RedisServer::setup_unix_socket() {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (config_.unixsocket.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Unix socket path too long: " + config_.unixsocket);
+    }
+    std::memcpy(addr.sun_path, config_.unixsocket.c_str(), config_.unixsocket.size() + 1);
+    
+    unix_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (unix_fd_ < 0) {
+        throw std::runtime_error("Failed to create unix socket");
+    }
+    
+    // 清理上次异常退出遗留的套接字文件
+    unlink(config_.unixsocket.c_str());
+    if (bind(unix_fd_, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(unix_fd_, 1024) < 0) {
+        close(unix_fd_);
+        unix_fd_ = -1;
+        throw std::runtime_error("Failed to listen on unix socket " + config_.unixsocket);
+    }
+    chmod(config_.unixsocket.c_str(), config_.unixsocket_perm);
+    LOG_INFO("Listening on unix socket %s (perm %o)", config_.unixsocket.c_str(), config_.unixsocket_perm);
+}
+
+void RedisServer::setup_shm_socket() {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (config_.shm_path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Shared memory socket path too long: " + config_.shm_path);
+    }
+    std::memcpy(addr.sun_path, config_.shm_path.c_str(), config_.shm_path.size() + 1);
+    
+    shm_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (shm_fd_ < 0) {
+        throw std::runtime_error("Failed to create shared memory socket");
+    }
+    
+    // 清理上次异常退出遗留的套接字文件
+    unlink(config_.shm_path.c_str());
+    if (bind(shm_fd_, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(shm_fd_, 128) < 0) {
+        close(shm_fd_);
+        shm_fd_ = -1;
+        throw std::runtime_error("Failed to listen on shared memory socket " + config_.shm_path);
+    }
+    // 能连上握手套接字就能拿到共享段与门铃，权限与 Unix 域套接字一样按配置收紧
+    chmod(config_.shm_path.c_str(), config_.shm_perm);
+}
+
+void RedisServer::shm_accept_loop() {
+    ShmSession::Options options;
+    options.frame_capacity = config_.shm_ring_kb * 1024;
+    options.arena_capacity = config_.shm_arena_mb * 1024 * 1024;
+    
+    while (running_) {
+        // 带超时等待，使 stop() 能及时结束本线程
+        pollfd pfd{shm_fd_, POLLIN, 0};
+        int ready = poll(&pfd, 1, 100);
+        if (ready <= 0) continue;
+        
+        int control_fd = accept4(shm_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (control_fd < 0) {
+            if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK && running_) {
+                LOG_ERROR("shared memory accept failed: %s (errno %d)", strerror(errno), errno);
+            }
+            continue;
+        }
+        
+        if (worker_pool_->client_count() >= config_.max_connections) {
+            LOG_WARN("Max connections reached, rejecting shared memory client");
+            close(control_fd);
+            continue;
+        }
+        
+        // 与 TCP 一样在过载时拒绝新会话（握手之前关闭，客户端得到握手失败）
+        if (worker_pool_->overloaded()) {
+            close(control_fd);
+            rejected_connections_++;
+            LOG_WARN("Server overloaded, rejecting shared memory client");
+            continue;
+        }
+        
+        try {
+            worker_pool_->assign_shm_session(
+                ShmSession::accept(control_fd, ThreadPool::next_connection_id(), options));
+            total_connections_++;
+        } catch (const std::exception& e) {
+            LOG_WARN("Shared memory handshake failed: %s", e.what());
+        }
+    }
 }
 
 void RedisServer::optimize_socket(int sockfd) {
@@ -135,74 +393,148 @@ void RedisServer::optimize_socket(int sockfd) {
 }
 
 void RedisServer::accept_loop() {
-    std::cout << "Accept loop started, listening on " << config_.host << ":" << config_.port << std::endl;
-    std::cout << "Server fd: " << server_fd_ << std::endl;
+    LOG_INFO("Accept loop started, listening on %s:%d (fd %d)", config_.host.c_str(), config_.port, server_fd_);
     
     if (server_fd_ < 0) {
-        std::cerr << "Error: Invalid server socket fd in accept loop!" << std::endl;
+        LOG_ERROR("Invalid server socket fd in accept loop!");
         return;
     }
-
+    
+    // 同时等待TCP与Unix域套接字；带超时以便 stop() 能及时结束本线程
+    pollfd fds[2] = {{server_fd_, POLLIN, 0}, {unix_fd_, POLLIN, 0}};
+    nfds_t nfds = unix_fd_ >= 0 ? 2 : 1;
+    
     while (running_) {
-        sockaddr_in client_addr{};
-        socklen_t addr_len = sizeof(client_addr);
+        int ready = poll(fds, nfds, 100);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("poll on listening sockets failed: %s (errno %d)", strerror(errno), errno);
+            break;
+        }
+        if (ready == 0) continue;
         
-        int client_fd = accept(server_fd_, (sockaddr*)&client_addr, &addr_len);
+        if (fds[0].revents & POLLIN) {
+            accept_connection(server_fd_, true);
+        }
+        if (nfds > 1 && (fds[1].revents & POLLIN)) {
+            accept_connection(unix_fd_, false);
+        }
+    }
+    
+    LOG_INFO("Accept loop ended");
+}
+
+void RedisServer::accept_connection(int listen_fd, bool tcp) {
+    // 监听套接字为非阻塞：一次就绪可能对应多个连接，取到 EAGAIN 为止
+    while (running_) {
+        int client_fd = accept(listen_fd, nullptr, nullptr);
         if (client_fd < 0) {
-            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
-                continue;
-            }
-            if (running_) {
-                perror("accept failed");
-                std::cout << "Accept failed with errno: " << errno << std::endl;
+            if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR("accept failed: %s (errno %d)", strerror(errno), errno);
             }
-            break;
+            return;
         }
         
-        std::cout << "Accepted connection: fd=" << client_fd << std::endl;
+        LOG_DEBUG("Accepted %s connection: fd=%d", tcp ? "TCP" : "unix socket", client_fd);
         
         // 检查连接数限制
-        auto current_conns = worker_pool_->get_stats().total_clients;
-        if (current_conns >= config_.max_connections) {
-            std::cout << "Max connections reached, rejecting client" << std::endl;
+        if (worker_pool_->client_count() >= config_.max_connections) {
+            LOG_WARN("Max connections reached, rejecting client");
+            close(client_fd);
+            continue;
+        }
+        
+        // 过载保护：所有Worker都积压时直接拒绝，客户端立即得到错误而不是排队超时
+        if (worker_pool_->overloaded()) {
+            static const char busy[] = "-BUSY server is overloaded, try again later\r\n";
+            ssize_t n = send(client_fd, busy, sizeof(busy) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+            (void)n;
             close(client_fd);
+            rejected_connections_++;
+            LOG_WARN("Server overloaded, rejecting client");
             continue;
         }
         
-        optimize_socket(client_fd);
+        // Unix域套接字没有TCP协议栈，跳过TCP相关的套接字选项
+        if (tcp) {
+            optimize_socket(client_fd);
+        }
         
         // 分配给Worker
-        worker_pool_->assign_client(client_fd);
+        worker_pool_->assign_client(client_fd, tcp);
         
         total_connections_++;
-        std::cout << "Client assigned to worker, total connections: " << total_connections_.load() << std::endl;
+        LOG_DEBUG("Client assigned to worker, total connections: %lu",
+                  static_cast<unsigned long>(total_connections_.load()));
     }
-    
-    std::cout << "Accept loop ended" << std::endl;
 }
 
-void RedisServer::print_stats_loop() {
-    while (running_) {
-        std::this_thread::sleep_for(std::chrono::seconds(30));
-        if (!running_) break;
-        
-        auto stats = get_stats();
-        auto pool_stats = worker_pool_->get_stats();
-        
-        std::cout << "\n=== Optimized Server Stats ===" << std::endl;
-        std::cout << "Uptime: " << stats.uptime.count() << " seconds" << std::endl;
-        std::cout << "Total connections: " << stats.total_connections << std::endl;
-        std::cout << "Current connections: " << pool_stats.total_clients << std::endl;
-        std::cout << "Total commands: " << pool_stats.total_commands << std::endl;
-        std::cout << "Commands per second: " << stats.commands_per_second << std::endl;
-        
-        // Worker负载分布
-        std::cout << "Worker load distribution: ";
-        for (size_t i = 0; i < pool_stats.worker_clients.size(); ++i) {
-            std::cout << "[" << i << "]:" << pool_stats.worker_clients[i] << " ";
+void RedisServer::print_stats() {
+    auto stats = get_stats();
+    auto pool_stats = worker_pool_->get_stats();
+    
+    LOG_INFO("=== Optimized Server Stats ===");
+    LOG_INFO("Uptime: %lld seconds", static_cast<long long>(stats.uptime.count()));
+    LOG_INFO("Total connections: %lu", static_cast<unsigned long>(stats.total_connections));
+    LOG_INFO("Current connections: %zu", pool_stats.total_clients);
+    LOG_INFO("Total commands: %lu", static_cast<unsigned long>(pool_stats.total_commands));
+    if (pool_stats.shed_commands > 0 || rejected_connections_.load() > 0) {
+        LOG_INFO("Overload: %zu workers overloaded, %lu commands shed, %lu connections rejected",
+                 pool_stats.overloaded_workers, static_cast<unsigned long>(pool_stats.shed_commands),
+                 static_cast<unsigned long>(rejected_connections_.load()));
+    }
+    if (pool_stats.evicted_clients > 0 || worker_pool_->client_limits().load()->max_client_memory > 0) {
+        LOG_INFO("Client buffers: %zu bytes, %lu clients evicted",
+                 pool_stats.client_memory, static_cast<unsigned long>(pool_stats.evicted_clients));
+    }
+    if (pool_stats.offloaded_commands > 0 || pool_stats.offload_rejected > 0) {
+        LOG_INFO("Slow commands offloaded: %lu, run inline (queue full): %lu",
+                 static_cast<unsigned long>(pool_stats.offloaded_commands),
+                 static_cast<unsigned long>(pool_stats.offload_rejected));
+    }
+    uint64_t steered = pool_stats.steered_same_cpu + pool_stats.steered_smt + pool_stats.steered_llc;
+    if (steered + pool_stats.steered_remote > 0) {
+        LOG_INFO("Connection locality: %.1f%% steered (%lu same CPU, %lu SMT sibling, %lu shared L3, %lu elsewhere)",
+                 100.0 * steered / (steered + pool_stats.steered_remote),
+                 static_cast<unsigned long>(pool_stats.steered_same_cpu),
+                 static_cast<unsigned long>(pool_stats.steered_smt),
+                 static_cast<unsigned long>(pool_stats.steered_llc),
+                 static_cast<unsigned long>(pool_stats.steered_remote));
+    }
+    if (config_.enable_busy_poll) {
+        BusyPoll::Stats busy;
+        for (const auto& worker : pool_stats.worker_busy_poll) {
+            busy.spin_wakeups += worker.spin_wakeups;
+            busy.blocking_wakeups += worker.blocking_wakeups;
+            busy.spin_timeouts += worker.spin_timeouts;
+            busy.spin_us += worker.spin_us;
+        }
+        LOG_INFO("Busy poll: %lu spin wakeups, %lu blocking wakeups, %lu idle windows, %.2f CPU seconds spinning",
+                 static_cast<unsigned long>(busy.spin_wakeups), static_cast<unsigned long>(busy.blocking_wakeups),
+                 static_cast<unsigned long>(busy.spin_timeouts), busy.spin_us / 1e6);
+    }
+    LOG_INFO("Commands per second: %.2f", stats.commands_per_second);
+    auto tasks = TaskScheduler::instance().stats();
+    LOG_INFO("Background tasks: %zu registered, %lu runs (%lu stolen, %lu throttled), %.2f CPU seconds",
+             tasks.tasks, static_cast<unsigned long>(tasks.executed), static_cast<unsigned long>(tasks.stolen),
+             static_cast<unsigned long>(tasks.throttled), tasks.cpu_seconds);
+    
+    // Worker负载分布（每行16个，避免超出单条日志长度）
+    constexpr size_t PER_LINE = 16;
+    for (size_t begin = 0; begin < pool_stats.worker_clients.size(); begin += PER_LINE) {
+        std::string line;
+        size_t end = std::min(begin + PER_LINE, pool_stats.worker_clients.size());
+        for (size_t i = begin; i < end; ++i) {
+            line += "[" + std::to_string(i) + "]:" + std::to_string(pool_stats.worker_clients[i]) + " ";
         }
-        std::cout << std::endl;
-        std::cout << "==============================" << std::endl;
+        LOG_INFO("Worker load distribution: %s", line.c_str());
+    }
+    
+    auto& logger = Logger::instance();
+    if (logger.dropped() > 0 || logger.suppressed() > 0) {
+        LOG_INFO("Log messages dropped: %lu, rate-limited: %lu",
+                 static_cast<unsigned long>(logger.dropped()),
+                 static_cast<unsigned long>(logger.suppressed()));
     }
 }
 
@@ -222,3 +554,146 @@ RedisServer::Stats RedisServer::get_stats() const {
         uptime
     };
 }
+
+std::string RedisServer::render_metrics() const {
+    using namespace prometheus;
+    std::string out;
+    out.reserve(16384);
+    
+    auto stats = get_stats();
+    auto pool_stats = worker_pool_->get_stats();
+    
+    // 服务器
+    header(out, "simple_redis_uptime_seconds", "gauge", "Seconds since the server started.");
+    sample(out, "simple_redis_uptime_seconds", "", static_cast<uint64_t>(stats.uptime.count()));
+    header(out, "simple_redis_connections_received_total", "counter", "Total accepted client connections.");
+    sample(out, "simple_redis_connections_received_total", "", stats.total_connections);
+    
+    // 每个Worker的命令数与客户端数
+    header(out, "simple_redis_worker_commands_processed_total", "counter", "Commands processed per worker thread.");
+    for (size_t i = 0; i < pool_stats.worker_commands.size(); ++i) {
+        sample(out, "simple_redis_worker_commands_processed_total",
+               "worker=\"" + std::to_string(i) + "\"", pool_stats.worker_commands[i]);
+    }
+    header(out, "simple_redis_worker_connected_clients", "gauge", "Connected clients per worker thread.");
+    for (size_t i = 0; i < pool_stats.worker_clients.size(); ++i) {
+        sample(out, "simple_redis_worker_connected_clients",
+               "worker=\"" + std::to_string(i) + "\"", static_cast<uint64_t>(pool_stats.worker_clients[i]));
+    }
+    
+    // 按收包CPU引导的连接
+    if (config_.connection_steering == "incoming_cpu") {
+        header(out, "simple_redis_connections_steered_total", "counter",
+               "TCP connections assigned by incoming CPU, by locality of the chosen worker.");
+        sample(out, "simple_redis_connections_steered_total", "locality=\"cpu\"", pool_stats.steered_same_cpu);
+        sample(out, "simple_redis_connections_steered_total", "locality=\"smt\"", pool_stats.steered_smt);
+        sample(out, "simple_redis_connections_steered_total", "locality=\"llc\"", pool_stats.steered_llc);
+        sample(out, "simple_redis_connections_steered_total", "locality=\"none\"", pool_stats.steered_remote);
+    }
+    
+    // 事件循环忙轮询：自旋省下的唤醒与为此多花的CPU
+    if (config_.enable_busy_poll) {
+        header(out, "simple_redis_worker_wakeups_total", "counter",
+               "Event loop wakeups per worker, by whether events arrived while spinning or after blocking.");
+        for (size_t i = 0; i < pool_stats.worker_busy_poll.size(); ++i) {
+            std::string worker = "worker=\"" + std::to_string(i) + "\"";
+            sample(out, "simple_redis_worker_wakeups_total", worker + ",mode=\"spin\"",
+                   pool_stats.worker_busy_poll[i].spin_wakeups);
+            sample(out, "simple_redis_worker_wakeups_total", worker + ",mode=\"blocking\"",
+                   pool_stats.worker_busy_poll[i].blocking_wakeups);
+        }
+        header(out, "simple_redis_worker_busy_poll_seconds_total", "counter",
+               "Time spent spinning in the busy-poll window per worker.");
+        for (size_t i = 0; i < pool_stats.worker_busy_poll.size(); ++i) {
+            sample(out, "simple_redis_worker_busy_poll_seconds_total",
+                   "worker=\"" + std::to_string(i) + "\"", pool_stats.worker_busy_poll[i].spin_us / 1e6);
+        }
+        header(out, "simple_redis_worker_busy_poll_idle_windows_total", "counter",
+               "Busy-poll windows that expired without events per worker.");
+        for (size_t i = 0; i < pool_stats.worker_busy_poll.size(); ++i) {
+            sample(out, "simple_redis_worker_busy_poll_idle_windows_total",
+                   "worker=\"" + std::to_string(i) + "\"", pool_stats.worker_busy_poll[i].spin_timeouts);
+        }
+        header(out, "simple_redis_worker_busy_poll_window_microseconds", "gauge",
+               "Current adaptive busy-poll window per worker.");
+        for (size_t i = 0; i < pool_stats.worker_busy_poll.size(); ++i) {
+            sample(out, "simple_redis_worker_busy_poll_window_microseconds",
+                   "worker=\"" + std::to_string(i) + "\"",
+                   static_cast<uint64_t>(pool_stats.worker_busy_poll[i].window_us));
+        }
+    }
+    
+    // 事件循环卡顿
+    if (watchdog_) {
+        header(out, "simple_redis_event_loop_stalls_total", "counter", "Worker event loop stalls detected by the watchdog.");
+        sample(out, "simple_redis_event_loop_stalls_total", "", watchdog_->stalls_detected());
+    }
+    
+    // 每个命令的延迟直方图
+    auto cmd_stats = handler_->get_command_stats();
+    header(out, "simple_redis_command_duration_seconds", "histogram", "Command execution latency.");
+    for (const auto& cmd : cmd_stats) {
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b < CommandMetrics::BUCKET_COUNT; ++b) {
+            cumulative += cmd.buckets[b];
+            std::string le;
+            if (b < CommandMetrics::BUCKET_BOUNDS_US.size()) {
+                char buf[32];
+                std::snprintf(buf, sizeof(buf), "%g", CommandMetrics::BUCKET_BOUNDS_US[b] / 1e6);
+                le = buf;
+            } else {
+                le = "+Inf";
+            }
+            sample(out, "simple_redis_command_duration_seconds_bucket",
+                   "cmd=\"" + cmd.name + "\",le=\"" + le + "\"", cumulative);
+        }
+        sample(out, "simple_redis_command_duration_seconds_sum",
+               "cmd=\"" + cmd.name + "\"", cmd.total_time_us / 1e6);
+        sample(out, "simple_redis_command_duration_seconds_count",
+               "cmd=\"" + cmd.name + "\"", cmd.calls);
+    }
+    
+    // 缓存
+    auto cache = datastore_->get_cache_stats();
+    header(out, "simple_redis_cache_hits_total", "counter", "Cache lookups that hit.");
+    sample(out, "simple_redis_cache_hits_total", "", static_cast<uint64_t>(cache.hits));
+    header(out, "simple_redis_cache_misses_total", "counter", "Cache lookups that missed.");
+    sample(out, "simple_redis_cache_misses_total", "", static_cast<uint64_t>(cache.misses));
+    header(out, "simple_redis_cache_hit_ratio", "gauge", "Cache hit ratio since start.");
+    sample(out, "simple_redis_cache_hit_ratio", "", cache.hit_ratio);
+    header(out, "simple_redis_cache_evictions_total", "counter", "Items evicted from the cache.");
+    sample(out, "simple_redis_cache_evictions_total", "", static_cast<uint64_t>(cache.evictions));
+    header(out, "simple_redis_cache_expirations_total", "counter", "Items expired from the cache.");
+    sample(out, "simple_redis_cache_expirations_total", "", static_cast<uint64_t>(cache.expirations));
+    header(out, "simple_redis_cache_items", "gauge", "Items currently cached.");
+    sample(out, "simple_redis_cache_items", "", static_cast<uint64_t>(cache.size));
+    header(out, "simple_redis_cache_capacity_items", "gauge", "Cache capacity in items.");
+    sample(out, "simple_redis_cache_capacity_items", "", static_cast<uint64_t>(cache.capacity));
+    header(out, "simple_redis_cache_memory_bytes", "gauge", "Estimated memory used by cached items.");
+    sample(out, "simple_redis_cache_memory_bytes", "", static_cast<uint64_t>(cache.memory_usage));
+    
+    // 持久化
+    auto persist = datastore_->get_persistence_stats();
+    header(out, "simple_redis_persistence_saves_total", "counter", "Completed full snapshots to disk.");
+    sample(out, "simple_redis_persistence_saves_total", "", persist.saves);
+    header(out, "simple_redis_persistence_failures_total", "counter", "Shard files that failed to save.");
+    sample(out, "simple_redis_persistence_failures_total", "", persist.failures);
+    header(out, "simple_redis_persistence_last_duration_seconds", "gauge", "Duration of the last snapshot.");
+    sample(out, "simple_redis_persistence_last_duration_seconds", "", persist.last_duration_sec);
+    header(out, "simple_redis_persistence_duration_seconds_total", "counter", "Total time spent writing snapshots.");
+    sample(out, "simple_redis_persistence_duration_seconds_total", "", persist.total_duration_sec);
+    header(out, "simple_redis_persistence_last_save_timestamp_seconds", "gauge", "Unix time of the last snapshot.");
+    sample(out, "simple_redis_persistence_last_save_timestamp_seconds", "",
+           static_cast<uint64_t>(persist.last_save_time));
+    
+    // 内存池
+    auto pool = MemoryBlockPool::global_stats();
+    header(out, "simple_redis_allocator_reserved_bytes", "gauge", "Bytes reserved by memory block pools.");
+    sample(out, "simple_redis_allocator_reserved_bytes", "", static_cast<uint64_t>(pool.reserved_bytes));
+    header(out, "simple_redis_allocator_used_bytes", "gauge", "Bytes handed out by memory block pools.");
+    sample(out, "simple_redis_allocator_used_bytes", "", static_cast<uint64_t>(pool.used_bytes));
+    header(out, "simple_redis_allocator_chunks", "gauge", "Chunks allocated by memory block pools.");
+    sample(out, "simple_redis_allocator_chunks", "", static_cast<uint64_t>(pool.chunks));
+    
+    return out;
+}
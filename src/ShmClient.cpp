@@ -0,0 +1,224 @@
+#include "ShmClient.h"
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+namespace {
+    inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+}
+
+ShmClient::~ShmClient() {
+    close();
+}
+
+bool ShmClient::connect(const std::string& path, std::string& error) {
+    close();
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        error = "socket path too long: " + path;
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    control_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (control_fd_ < 0 || ::connect(control_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        error = "cannot connect to " + path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+
+    shm::Handshake handshake;
+    int fds[shm::HANDSHAKE_FDS] = {-1, -1, -1};
+    int received = shm::recv_with_fds(control_fd_, &handshake, sizeof(handshake), fds, shm::HANDSHAKE_FDS);
+    if (received != shm::HANDSHAKE_FDS || handshake.magic != shm::MAGIC || handshake.version != shm::VERSION) {
+        for (int i = 0; i < received; ++i) ::close(fds[i]);
+        error = "shared memory handshake failed";
+        close();
+        return false;
+    }
+    int memfd = fds[0];
+    server_doorbell_ = fds[1];
+    client_doorbell_ = fds[2];
+
+    shm::Layout layout;
+    layout.frame_capacity = handshake.frame_capacity;
+    layout.arena_capacity = handshake.arena_capacity;
+    size_ = layout.total_size();
+    void* base = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    ::close(memfd);
+    if (base == MAP_FAILED) {
+        error = std::string("mmap failed: ") + std::strerror(errno);
+        close();
+        return false;
+    }
+    base_ = base;
+    connection_id_ = handshake.connection_id;
+
+    auto* header = static_cast<shm::SegmentHeader*>(base_);
+    char* bytes = static_cast<char*>(base_);
+    requests_.attach(&header->request, bytes + layout.request_frames(), layout.frame_capacity,
+                     bytes + layout.request_arena(), layout.arena_capacity);
+    responses_.attach(&header->response, bytes + layout.response_frames(), layout.frame_capacity,
+                      bytes + layout.response_arena(), layout.arena_capacity);
+
+    // 单核上自旋只会抢占服务器线程，直接睡眠等待门铃
+    spin_limit_ = std::thread::hardware_concurrency() > 1 ? 4096 : 0;
+    holding_ = false;
+    return true;
+}
+
+void ShmClient::close() {
+    if (base_) {
+        munmap(base_, size_);
+        base_ = nullptr;
+    }
+    for (int* fd : {&control_fd_, &server_doorbell_, &client_doorbell_}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+    holding_ = false;
+}
+
+char* ShmClient::reserve(size_t len) {
+    if (!base_) return nullptr;
+    release_held();
+    return requests_.reserve(len);
+}
+
+bool ShmClient::command(const std::vector<std::string_view>& args, std::string_view& reply) {
+    std::vector<std::vector<std::string_view>> commands{args};
+    return run(commands, nullptr, &reply);
+}
+
+bool ShmClient::pipeline(const std::vector<std::vector<std::string_view>>& commands,
+                         const std::function<void(std::string_view)>& on_reply) {
+    return run(commands, &on_reply, nullptr);
+}
+
+bool ShmClient::run(const std::vector<std::vector<std::string_view>>& commands,
+                    const std::function<void(std::string_view)>* on_reply, std::string_view* held_reply) {
+    if (!base_) {
+        error_ = "not connected";
+        return false;
+    }
+    release_held();
+
+    size_t sent = 0;
+    size_t received = 0;
+    int spins = 0;
+    while (received < commands.size()) {
+        bool progressed = false;
+
+        // 尽量多发送：请求通道满时转去收取回复，避免与服务器互相等待
+        while (sent < commands.size()) {
+            if (!requests_.send(commands[sent])) {
+                if (requests_.protocol_error()) {
+                    error_ = "request channel corrupted by server";
+                    return false;
+                }
+                if (requests_.oversized()) {
+                    error_ = "command too large for shared memory transport";
+                    return false;
+                }
+                break;
+            }
+            if (requests_.consumer_needs_wakeup()) ring_server();
+            sent++;
+            progressed = true;
+        }
+
+        while (received < sent && responses_.peek(message_)) {
+            if (message_.parts.size() != 1) {
+                error_ = "malformed reply";
+                return false;
+            }
+            received++;
+            progressed = true;
+            if (held_reply && received == commands.size()) {
+                // 最后一条回复保留在共享内存中，直到下一次调用才释放
+                *held_reply = message_.parts[0];
+                holding_ = true;
+                return true;
+            }
+            if (on_reply) (*on_reply)(message_.parts[0]);
+            if (responses_.release(message_)) ring_server();
+        }
+        if (responses_.corrupted()) {
+            error_ = "malformed reply";
+            return false;
+        }
+
+        if (progressed || received == commands.size()) {
+            spins = 0;
+            continue;
+        }
+        if (spins++ < spin_limit_) {
+            cpu_relax();
+            continue;
+        }
+        spins = 0;
+
+        // 登记等待后复查，确认确实无事可做再睡眠
+        bool blocked_on_send = sent < commands.size();
+        if (blocked_on_send) requests_.mark_waiting();
+        if (!responses_.prepare_wait()) continue;
+        if (blocked_on_send && requests_.send(commands[sent])) {
+            if (requests_.consumer_needs_wakeup()) ring_server();
+            sent++;
+            continue;
+        }
+        if (!wait_doorbell()) return false;
+    }
+    return true;
+}
+
+bool ShmClient::wait_doorbell() {
+    pollfd fds[2] = {{client_doorbell_, POLLIN, 0}, {control_fd_, POLLIN, 0}};
+    while (true) {
+        int n = poll(fds, 2, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            error_ = std::string("poll failed: ") + std::strerror(errno);
+            return false;
+        }
+        if (fds[1].revents) {
+            // 控制连接只会在服务器关闭会话时可读
+            error_ = "connection closed by server";
+            return false;
+        }
+        if (fds[0].revents & POLLIN) {
+            uint64_t value;
+            ssize_t r = read(client_doorbell_, &value, sizeof(value));
+            (void)r;
+            return true;
+        }
+    }
+}
+
+void ShmClient::ring_server() {
+    uint64_t one = 1;
+    ssize_t n = write(server_doorbell_, &one, sizeof(one));
+    (void)n;
+}
+
+void ShmClient::release_held() {
+    if (holding_) {
+        holding_ = false;
+        if (responses_.release(message_)) ring_server();
+    }
+}
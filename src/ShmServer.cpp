@@ -0,0 +1,109 @@
+#include "ShmServer.h"
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace {
+    constexpr size_t MIN_CAPACITY = 64 * 1024;
+
+    size_t round_up_pow2(size_t v) {
+        size_t p = 1;
+        while (p < v) p <<= 1;
+        return p;
+    }
+
+    std::runtime_error system_error(const char* what) {
+        return std::runtime_error(std::string(what) + ": " + std::strerror(errno));
+    }
+}
+
+std::unique_ptr<ShmSession> ShmSession::accept(int control_fd, uint64_t id, const Options& options) {
+    std::unique_ptr<ShmSession> session(new ShmSession());
+    session->control_fd_ = control_fd;
+    session->id_ = id;
+
+    shm::Layout layout;
+    layout.frame_capacity = round_up_pow2(std::max(options.frame_capacity, MIN_CAPACITY));
+    layout.arena_capacity = round_up_pow2(std::max(options.arena_capacity, MIN_CAPACITY));
+
+    session->memfd_ = memfd_create("simple_redis_shm", MFD_CLOEXEC);
+    if (session->memfd_ < 0) throw system_error("memfd_create failed");
+    session->size_ = layout.total_size();
+    if (ftruncate(session->memfd_, static_cast<off_t>(session->size_)) < 0) throw system_error("ftruncate failed");
+
+    void* base = mmap(nullptr, session->size_, PROT_READ | PROT_WRITE, MAP_SHARED, session->memfd_, 0);
+    if (base == MAP_FAILED) throw system_error("mmap failed");
+    session->base_ = base;
+
+    auto* header = new (base) shm::SegmentHeader();
+    header->magic = shm::MAGIC;
+    header->version = shm::VERSION;
+    header->frame_capacity = layout.frame_capacity;
+    header->arena_capacity = layout.arena_capacity;
+    // 会话交给 Worker 之前视为服务器在睡眠：客户端的第一条请求会敲响门铃，
+    // 门铃描述符加入 epoll 时已可读，Worker 随即开始处理
+    header->request.consumer_waiting.store(1, std::memory_order_relaxed);
+
+    char* bytes = static_cast<char*>(base);
+    session->requests_.attach(&header->request, bytes + layout.request_frames(), layout.frame_capacity,
+                              bytes + layout.request_arena(), layout.arena_capacity);
+    session->responses_.attach(&header->response, bytes + layout.response_frames(), layout.frame_capacity,
+                               bytes + layout.response_arena(), layout.arena_capacity);
+
+    session->server_doorbell_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    session->client_doorbell_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (session->server_doorbell_ < 0 || session->client_doorbell_ < 0) throw system_error("eventfd failed");
+
+    shm::Handshake handshake;
+    handshake.frame_capacity = layout.frame_capacity;
+    handshake.arena_capacity = layout.arena_capacity;
+    handshake.connection_id = id;
+    int fds[shm::HANDSHAKE_FDS] = {session->memfd_, session->server_doorbell_, session->client_doorbell_};
+    if (!shm::send_with_fds(control_fd, &handshake, sizeof(handshake), fds, shm::HANDSHAKE_FDS)) {
+        throw system_error("handshake failed");
+    }
+
+    // 客户端已持有自己的描述符与映射
+    close(session->memfd_);
+    session->memfd_ = -1;
+    return session;
+}
+
+ShmSession::~ShmSession() {
+    if (base_) munmap(base_, size_);
+    for (int fd : {memfd_, server_doorbell_, client_doorbell_, control_fd_}) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+bool ShmSession::send_response(const std::string& response) {
+    static const std::string too_large = "-ERR reply too large for shared memory transport\r\n";
+
+    std::string_view part(response);
+    if (!responses_.send(&part, 1)) {
+        if (responses_.protocol_error()) return false;
+        if (responses_.oversized()) part = too_large;
+        // 登记等待后重试一次，避免客户端在登记之前刚好释放空间而错过唤醒
+        responses_.mark_waiting();
+        if (!responses_.send(&part, 1)) return false;
+    }
+    if (responses_.consumer_needs_wakeup()) ring_client();
+    return true;
+}
+
+void ShmSession::ring_client() {
+    uint64_t one = 1;
+    ssize_t n = write(client_doorbell_, &one, sizeof(one));
+    (void)n;
+}
+
+void ShmSession::clear_doorbell() {
+    uint64_t value;
+    ssize_t n = read(server_doorbell_, &value, sizeof(value));
+    (void)n;
+}
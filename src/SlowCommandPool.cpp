@@ -0,0 +1,75 @@
+#include "SlowCommandPool.h"
+#include "Logger.h"
+
+SlowCommandPool::SlowCommandPool(const Options& options)
+    : options_(options) {}
+
+SlowCommandPool::~SlowCommandPool() {
+    stop();
+}
+
+void SlowCommandPool::start() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+    }
+    for (size_t i = 0; i < options_.threads; ++i) {
+        threads_.emplace_back(&SlowCommandPool::run, this);
+    }
+    LOG_INFO("Slow command pool started (%zu threads, queue limit %zu)", options_.threads, options_.queue_limit);
+}
+
+void SlowCommandPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads_.clear();
+}
+
+bool SlowCommandPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || threads_.empty() || queue_.size() >= options_.queue_limit) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        queue_.push_back(std::move(task));
+    }
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    cv_.notify_one();
+    return true;
+}
+
+void SlowCommandPool::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            task = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        task();
+        completed_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+SlowCommandPool::Stats SlowCommandPool::stats() const {
+    Stats stats;
+    stats.submitted = submitted_.load(std::memory_order_relaxed);
+    stats.completed = completed_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.queued = queue_.size();
+    return stats;
+}
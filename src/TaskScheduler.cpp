@@ -0,0 +1,341 @@
+#include "TaskScheduler.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+namespace {
+
+// 调度线程在本线程上的序号（非调度线程为 -1），线程内提交的任务放入自己的队列
+thread_local int t_worker_index = -1;
+
+uint64_t thread_cpu_ns() {
+#ifdef __linux__
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    }
+#endif
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+TaskScheduler& TaskScheduler::instance() {
+    // 不析构：静态对象（如全局的服务器实例）析构时仍可能取消任务
+    static TaskScheduler* scheduler = new TaskScheduler();
+    return *scheduler;
+}
+
+void TaskScheduler::start(const Options& options) {
+    std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+    if (state_.load() != State::IDLE) return;
+
+    size_t threads = std::max<size_t>(1, options.threads);
+    workers_.clear();
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    state_ = State::RUNNING;
+    for (size_t i = 0; i < threads; ++i) {
+        workers_[i]->thread = std::thread(&TaskScheduler::worker_loop, this, i);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bind_threads();
+    }
+    LOG_INFO("Background task scheduler started with %zu threads", threads);
+}
+
+void TaskScheduler::stop() {
+    std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+    if (state_.load() == State::STOPPED) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        state_ = State::STOPPED;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    // 丢弃未执行的任务；任务对象在锁外析构（捕获的状态可能较大）
+    std::vector<std::shared_ptr<Job>> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : jobs_) dropped.push_back(std::move(entry.second));
+        jobs_.clear();
+        timers_.clear();
+        queued_ = 0;
+        for (auto& worker : workers_) {
+            for (auto& queue : worker->ready) queue.clear();
+        }
+    }
+    done_cv_.notify_all();
+}
+
+TaskScheduler::TaskId TaskScheduler::schedule(Task task, const TaskOptions& options) {
+    if (state_.load() == State::IDLE) {
+        // 嵌入式使用时没有显式启动：以默认参数启动，进程退出时停止
+        start();
+        static bool registered = (std::atexit([] { TaskScheduler::instance().stop(); }), true);
+        (void)registered;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->name = options.name;
+    job->priority = options.priority;
+    job->period = options.period;
+    job->cpu_budget = options.cpu_budget;
+    job->task = std::move(task);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_.load() != State::RUNNING) {
+        return 0;
+    }
+    job->id = next_id_++;
+    job->last_finish = Clock::now();
+    jobs_.emplace(job->id, job);
+    if (options.delay.count() > 0) {
+        arm(job, Clock::now() + options.delay);
+    } else {
+        enqueue(job);
+    }
+    return job->id;
+}
+
+bool TaskScheduler::cancel(TaskId id) {
+    std::shared_ptr<Job> job;
+    Task released;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = jobs_.find(id);
+        if (it == jobs_.end()) return false;
+        job = it->second;
+        job->cancelled = true;
+        disarm(*job);
+
+        if (job->running && job->runner != std::this_thread::get_id()) {
+            done_cv_.wait(lock, [&] { return !job->running; });
+        }
+        if (!job->running) {
+            // 已在队列中的任务出队时发现已取消即丢弃；捕获的状态现在就释放
+            released = std::move(job->task);
+            if (!job->queued) {
+                jobs_.erase(id);
+            }
+        }
+    }
+    return true;
+}
+
+bool TaskScheduler::set_period(TaskId id, std::chrono::milliseconds period) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(id);
+    if (it == jobs_.end() || it->second->cancelled) return false;
+    auto& job = it->second;
+    job->period = period;
+    if (job->armed && period.count() > 0) {
+        // 等待中的周期任务：从上一次执行结束起按新周期重新计时
+        disarm(*job);
+        arm(job, job->last_finish + period);
+    }
+    return true;
+}
+
+void TaskScheduler::set_cpu_affinity(const std::vector<int>& cpus) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cpus_ = cpus;
+    bind_threads();
+}
+
+TaskScheduler::Stats TaskScheduler::stats() const {
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.threads = state_.load() == State::RUNNING ? workers_.size() : 0;
+        stats.tasks = jobs_.size();
+    }
+    stats.executed = executed_.load(std::memory_order_relaxed);
+    stats.stolen = stolen_.load(std::memory_order_relaxed);
+    stats.throttled = throttled_.load(std::memory_order_relaxed);
+    stats.cpu_seconds = cpu_ns_.load(std::memory_order_relaxed) / 1e9;
+    return stats;
+}
+
+void TaskScheduler::worker_loop(size_t index) {
+    t_worker_index = static_cast<int>(index);
+#ifdef __linux__
+    std::string name = "bg-task-" + std::to_string(index);
+    pthread_setname_np(pthread_self(), name.c_str());
+#endif
+
+    while (state_.load() == State::RUNNING) {
+        std::shared_ptr<Job> job = pop_local(index);
+        if (!job) {
+            job = steal(index);
+            if (job) stolen_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (job) {
+            run_job(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (release_due_timers(Clock::now())) continue;
+        if (queued_ > 0 || state_.load() != State::RUNNING) continue;
+        if (timers_.empty()) {
+            cv_.wait(lock);
+        } else {
+            cv_.wait_until(lock, timers_.begin()->first);
+        }
+    }
+}
+
+std::shared_ptr<TaskScheduler::Job> TaskScheduler::pop_local(size_t index) {
+    // 自己的队列从头部取（先进先出），高优先级优先
+    Worker& worker = *workers_[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    for (auto& queue : worker.ready) {
+        if (!queue.empty()) {
+            auto job = std::move(queue.front());
+            queue.pop_front();
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<TaskScheduler::Job> TaskScheduler::steal(size_t index) {
+    // 从其他线程队列尾部窃取，与其自身出队的一端错开；按优先级逐级查找
+    for (size_t level = 0; level < PRIORITY_LEVELS; ++level) {
+        for (size_t k = 1; k < workers_.size(); ++k) {
+            Worker& victim = *workers_[(index + k) % workers_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            auto& queue = victim.ready[level];
+            if (!queue.empty()) {
+                auto job = std::move(queue.back());
+                queue.pop_back();
+                return job;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void TaskScheduler::run_job(const std::shared_ptr<Job>& job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --queued_;
+        job->queued = false;
+        if (job->cancelled || state_.load() != State::RUNNING) {
+            jobs_.erase(job->id);
+            return;
+        }
+        job->running = true;
+        job->runner = std::this_thread::get_id();
+    }
+
+    uint64_t cpu_start = thread_cpu_ns();
+    try {
+        job->task();
+    } catch (const std::exception& e) {
+        LOG_ERROR("Background task '%s' failed: %s", job->name.c_str(), e.what());
+    } catch (...) {
+        LOG_ERROR("Background task '%s' failed with an unknown exception", job->name.c_str());
+    }
+    uint64_t cpu_used = thread_cpu_ns() - cpu_start;
+    executed_.fetch_add(1, std::memory_order_relaxed);
+    cpu_ns_.fetch_add(cpu_used, std::memory_order_relaxed);
+
+    Task released;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job->running = false;
+        job->last_finish = Clock::now();
+        if (job->cancelled || job->period.count() == 0 || state_.load() != State::RUNNING) {
+            released = std::move(job->task);
+            jobs_.erase(job->id);
+        } else {
+            // 周期任务：执行结束后按周期重新计时；超出 CPU 预算时推迟，使平均占用不超过预算
+            auto delay = std::chrono::duration_cast<Clock::duration>(job->period);
+            if (job->cpu_budget > 0) {
+                auto penalty = std::chrono::nanoseconds(
+                    static_cast<int64_t>(cpu_used * (1.0 / job->cpu_budget - 1.0)));
+                if (penalty > delay) {
+                    delay = std::chrono::duration_cast<Clock::duration>(penalty);
+                    throttled_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            arm(job, job->last_finish + delay);
+        }
+    }
+    done_cv_.notify_all();
+}
+
+void TaskScheduler::arm(const std::shared_ptr<Job>& job, Clock::time_point due) {
+    bool earliest = timers_.empty() || due < timers_.begin()->first;
+    job->timer = timers_.emplace(due, job->id);
+    job->armed = true;
+    if (earliest) cv_.notify_one();
+}
+
+void TaskScheduler::disarm(Job& job) {
+    if (job.armed) {
+        timers_.erase(job.timer);
+        job.armed = false;
+    }
+}
+
+void TaskScheduler::enqueue(const std::shared_ptr<Job>& job) {
+    size_t index = t_worker_index >= 0 ? static_cast<size_t>(t_worker_index)
+                                       : next_worker_++ % workers_.size();
+    {
+        Worker& worker = *workers_[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.ready[static_cast<size_t>(job->priority)].push_back(job);
+    }
+    job->queued = true;
+    ++queued_;
+    cv_.notify_one();
+}
+
+bool TaskScheduler::release_due_timers(Clock::time_point now) {
+    bool released = false;
+    while (!timers_.empty() && timers_.begin()->first <= now) {
+        auto it = jobs_.find(timers_.begin()->second);
+        timers_.erase(timers_.begin());
+        if (it == jobs_.end()) continue;
+        it->second->armed = false;
+        enqueue(it->second);
+        released = true;
+    }
+    return released;
+}
+
+void TaskScheduler::bind_threads() {
+#ifdef __linux__
+    if (cpus_.empty() || state_.load() != State::RUNNING) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus_) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    for (auto& worker : workers_) {
+        int result = pthread_setaffinity_np(worker->thread.native_handle(), sizeof(set), &set);
+        if (result != 0) {
+            LOG_WARN("Failed to bind background task thread: %s", strerror(result));
+        }
+    }
+#endif
+}
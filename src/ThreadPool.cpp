@@ -1,27 +1,116 @@
 #include "ThreadPool.h"
+#include "Logger.h"
+#include "LatencyMonitor.h"
+#include "Clock.h"
+#include "CommandCapture.h"
 #include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <netinet/tcp.h>
 #include <netinet/in.h>
-#include <iostream>
 #include <algorithm>
 #include <cstring>
 #include <cerrno>
+#include <strings.h>
+
+namespace {
+    std::atomic<uint64_t> g_next_connection_id{1};
+    
+    // 所有Worker的连接缓冲区总和与被逐出的连接数（只在缓冲区容量变化时更新，不在每条命令上争用）
+    std::atomic<size_t> g_client_memory{0};
+    std::atomic<uint64_t> g_evicted_clients{0};
+    // 已选中、等待所属Worker关闭的连接占用的字节数
+    std::atomic<size_t> g_pending_eviction{0};
+    
+    // 只有基础输入缓冲区的连接不参与客户端内存逐出
+    constexpr size_t CLIENT_BASE_MEMORY = 16 * 1024;
+    // 输出缓冲区清空后保留的最大容量，超出则释放
+    constexpr size_t OUTPUT_BUFFER_KEEP = 64 * 1024;
+    
+    // 共享内存会话的描述符在 epoll 数据中带上该标记，与TCP连接区分
+    constexpr uint64_t SHM_EVENT_TAG = 1ull << 32;
+    // 慢命令完成通知（eventfd）
+    constexpr uint64_t COMPLETION_EVENT_TAG = 1ull << 33;
+    
+    constexpr std::string_view BUSY_REPLY = "-BUSY server is overloaded, try again later\r\n";
+    
+    inline uint64_t now_us() {
+        return static_cast<uint64_t>(Clock::ticks_to_us(Clock::ticks()));
+    }
+    
+    // 按规则重置令牌桶（没有规则且原本不限速时跳过）
+    void configure_rate(const ClientLimits& limits, const std::string& name, const std::string& addr,
+                        TokenBucket& commands, TokenBucket& bytes) {
+        if (limits.rate_rules.empty() && !commands.limited() && !bytes.limited()) {
+            return;
+        }
+        const auto* rule = limits.match(name, addr);
+        uint64_t now = now_us();
+        commands.configure(rule ? rule->commands_per_sec : 0, now);
+        bytes.configure(rule ? rule->bytes_per_sec : 0, now);
+    }
+    
+    // 来源地址：TCP 为 ip:port，Unix 套接字为路径（匿名客户端为空路径）
+    std::string peer_address(int fd) {
+        sockaddr_storage addr{};
+        socklen_t len = sizeof(addr);
+        if (getpeername(fd, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+            return "";
+        }
+        char ip[INET6_ADDRSTRLEN] = {0};
+        if (addr.ss_family == AF_INET) {
+            auto* in = reinterpret_cast<sockaddr_in*>(&addr);
+            inet_ntop(AF_INET, &in->sin_addr, ip, sizeof(ip));
+            return std::string(ip) + ":" + std::to_string(ntohs(in->sin_port));
+        }
+        if (addr.ss_family == AF_INET6) {
+            auto* in6 = reinterpret_cast<sockaddr_in6*>(&addr);
+            inet_ntop(AF_INET6, &in6->sin6_addr, ip, sizeof(ip));
+            return std::string(ip) + ":" + std::to_string(ntohs(in6->sin6_port));
+        }
+        if (addr.ss_family == AF_UNIX) {
+            // 服务端 accept 得到的对端通常没有绑定路径，用本端监听路径代替
+            sockaddr_un local{};
+            socklen_t local_len = sizeof(local);
+            if (getsockname(fd, reinterpret_cast<sockaddr*>(&local), &local_len) == 0) {
+                return std::string("unix:") + local.sun_path;
+            }
+            return "unix:";
+        }
+        return "";
+    }
+}
 
 // WorkerThread实现
-WorkerThread::WorkerThread(int worker_id, std::shared_ptr<CommandHandler> handler, int cpu_id)
-    : worker_id_(worker_id), cpu_id_(cpu_id), handler_(handler) {
+WorkerThread::WorkerThread(int worker_id, std::shared_ptr<CommandHandler> handler, int cpu_id,
+                           const AdmissionControl::Options& admission, const ClientLimits& limits,
+                           const BusyPoll::Options& busy_poll)
+    : worker_id_(worker_id), cpu_id_(cpu_id), handler_(handler), limits_(limits), admission_(admission)
+    , busy_poll_(busy_poll) {
     
     // 创建epoll实例
     epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
     if (epoll_fd_ < 0) {
         throw std::runtime_error("Failed to create epoll instance for worker " + std::to_string(worker_id));
     }
+    
+    completion_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.u64 = COMPLETION_EVENT_TAG;
+    if (completion_fd_ < 0 || epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, completion_fd_, &ev) < 0) {
+        throw std::runtime_error("Failed to create completion eventfd for worker " + std::to_string(worker_id));
+    }
 }
 
 WorkerThread::~WorkerThread() {
     stop();
+    if (completion_fd_ >= 0) {
+        close(completion_fd_);
+    }
     if (epoll_fd_ >= 0) {
         close(epoll_fd_);
     }
@@ -51,32 +140,56 @@ void WorkerThread::stop() {
     std::lock_guard<std::mutex> lock(clients_mutex_);
     for (const auto& [fd, client] : clients_) {
         close(fd);
+        g_client_memory.fetch_sub(client->memory.load(std::memory_order_relaxed), std::memory_order_relaxed);
     }
     clients_.clear();
+    for (const auto& [fd, session] : shm_sessions_) {
+        if (fd == session->doorbell_fd()) {
+            g_client_memory.fetch_sub(session->memory.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+    shm_sessions_.clear();
 }
 
-void WorkerThread::add_client(int client_fd) {
+void WorkerThread::add_client(int client_fd, bool tcp) {
     // 设置非阻塞
     int flags = fcntl(client_fd, F_GETFL, 0);
     fcntl(client_fd, F_SETFL, flags | O_NONBLOCK);
     
-    // 设置TCP_NODELAY
-    int opt = 1;
-    setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
-    
-    // 添加到epoll
-    epoll_event ev{EPOLLIN | EPOLLET, {.fd = client_fd}};
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client_fd, &ev) < 0) {
-        close(client_fd);
-        return;
+    // 设置TCP_NODELAY（Unix域套接字不适用）
+    if (tcp) {
+        int opt = 1;
+        setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+        busy_poll_.configure_socket(client_fd);
     }
     
-    // 创建客户端信息
+    // 先创建客户端信息再加入epoll：边缘触发下，若首批数据在登记前到达，事件会被丢弃且不再触发
+    auto client = std::make_unique<ClientInfo>();
+    client->id = ThreadPool::next_connection_id();
+    client->addr = peer_address(client_fd);
+    client->created_ms = Clock::coarse_ms32();
+    client->last_active_ms = client->created_ms;
+    // 在接受线程中执行：读取线程池发布的快照，不碰本Worker的 limits_
+    if (pool_) {
+        apply_rate_rule(*client, *pool_->client_limits().load());
+    } else {
+        apply_rate_rule(*client, limits_);
+    }
+    update_client_memory(*client);
     {
         std::lock_guard<std::mutex> lock(clients_mutex_);
-        clients_[client_fd] = std::make_unique<ClientInfo>();
+        clients_[client_fd] = std::move(client);
         client_count_++;
     }
+    
+    // 添加到epoll：边缘触发的 EPOLLOUT 只在发送缓冲区由满变为可写时通知，无需反复修改监听事件
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    ev.data.u64 = static_cast<uint32_t>(client_fd);
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client_fd, &ev) < 0) {
+        remove_client(client_fd);
+        return;
+    }
 }
 
 void WorkerThread::remove_client(int client_fd) {
@@ -84,7 +197,10 @@ void WorkerThread::remove_client(int client_fd) {
     close(client_fd);
     
     std::lock_guard<std::mutex> lock(clients_mutex_);
-    if (clients_.erase(client_fd) > 0) {
+    auto it = clients_.find(client_fd);
+    if (it != clients_.end()) {
+        g_client_memory.fetch_sub(it->second->memory.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        clients_.erase(it);
         client_count_--;
     }
 }
@@ -100,47 +216,133 @@ void WorkerThread::worker_loop() {
     constexpr int MAX_EVENTS = 256;
     epoll_event events[MAX_EVENTS];
     
+    heartbeat_.attach_current_thread();
+    auto& latency_monitor = LatencyMonitor::instance();
+    
+    const bool admission_enabled = admission_.enabled();
+    const bool busy_poll_enabled = busy_poll_.enabled();
+    uint64_t last_batch_start_us = 0;
+    bool spun_empty = false;    // 上一次自旋轮询没有事件：本批事件是在那之后才就绪的
+    
     while (running_) {
-        int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, 100); // 100ms超时
+        if (pool_) {
+            refresh_limits();
+        }
+        uint64_t wait_start_us = admission_enabled ? now_us() : 0;
+        // 有限速中的连接时缩短超时，及时恢复读取
+        int timeout = throttled_.empty() ? 100 : 1; // 100ms超时
+        if (busy_poll_enabled) {
+            // 活动后的自旋窗口内以 0 超时轮询，不进入睡眠
+            timeout = busy_poll_.timeout_ms(now_us(), timeout);
+        }
+        int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout);
         
         if (n < 0) {
             if (errno == EINTR) continue;
             break;
         }
+        if (busy_poll_enabled) {
+            busy_poll_.on_wait(now_us(), n, timeout);
+        }
         
-        // 处理事件
+        if (n == 0) {
+            if (timeout == 0) {
+                // 自旋中的空轮询：空闲时的维护工作留到窗口到期、真正空闲时再做
+                spun_empty = true;
+                continue;
+            }
+            if (admission_enabled) {
+                admission_.on_idle();
+            }
+            if (!throttled_.empty()) {
+                resume_throttled();
+            }
+            continue;
+        }
+        
+        // 估计本批事件的就绪时刻：epoll_wait 未阻塞说明事件在上一轮处理期间就已就绪，
+        // 取上一轮处理区间的中点；阻塞过则视为刚刚就绪
+        uint64_t ready_us = 0;
+        if (admission_enabled) {
+            uint64_t now = now_us();
+            constexpr uint64_t BLOCKED_THRESHOLD_US = 50;
+            ready_us = (now - wait_start_us < BLOCKED_THRESHOLD_US && last_batch_start_us > 0 && !spun_empty)
+                ? last_batch_start_us + (wait_start_us - last_batch_start_us) / 2
+                : now;
+            last_batch_start_us = now;
+        }
+        spun_empty = false;
+        
+        // 处理事件（期间心跳标记为忙碌，超时由看门狗抓栈）
+        heartbeat_.begin();
         for (int i = 0; i < n; ++i) {
-            handle_client_event(events[i].data.fd, events[i].events);
+            if (admission_enabled) {
+                uint64_t now = now_us();
+                admission_.on_event(now, now - ready_us);
+            }
+            uint64_t data = events[i].data.u64;
+            if (data & COMPLETION_EVENT_TAG) {
+                handle_completions();
+                handle_evictions();
+            } else if (data & SHM_EVENT_TAG) {
+                handle_shm_event(static_cast<int>(data & 0xffffffffu));
+            } else {
+                handle_client_event(static_cast<int>(data), events[i].events);
+            }
+        }
+        if (!throttled_.empty()) {
+            resume_throttled();
+        }
+        uint64_t elapsed_ms = static_cast<uint64_t>(heartbeat_.end() / 1000);
+        if (latency_monitor.enabled() && elapsed_ms >= latency_monitor.threshold_ms()) {
+            latency_monitor.add_sample_if_needed("event-loop-stall", elapsed_ms, heartbeat_.take_stack_sample());
+        }
+        if (busy_poll_enabled) {
+            busy_poll_.on_processed(now_us());
         }
     }
 }
 
+WorkerThread::ClientInfo* WorkerThread::find_client(int client_fd) {
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    auto it = clients_.find(client_fd);
+    return it == clients_.end() ? nullptr : it->second.get();
+}
+
 void WorkerThread::handle_client_event(int client_fd, uint32_t events) {
     if (events & (EPOLLERR | EPOLLHUP)) {
         remove_client(client_fd);
         return;
     }
     
-    if (events & EPOLLIN) {
-        process_client_data(client_fd);
+    ClientInfo* client = find_client(client_fd);
+    if (!client) {
+        return;
     }
     
-    if (events & EPOLLOUT) {
-        // 处理写事件（如果需要）
+    // 发送缓冲区重新可写：继续发送积压的回复
+    if ((events & EPOLLOUT) && client->write_pos < client->write_buffer.size()) {
+        if (!flush_output(client_fd, *client)) {
+            return;
+        }
+    }
+    
+    if (events & EPOLLIN) {
+        process_client_data(client_fd, *client);
     }
 }
 
 void WorkerThread::process_client_data(int client_fd) {
-    std::unique_ptr<ClientInfo>* client_ptr = nullptr;
-    
-    {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        auto it = clients_.find(client_fd);
-        if (it == clients_.end()) return;
-        client_ptr = &it->second;
+    if (ClientInfo* client = find_client(client_fd)) {
+        process_client_data(client_fd, *client);
+    }
+}
+
+void WorkerThread::process_client_data(int client_fd, ClientInfo& client) {
+    // 慢命令执行期间或限速中暂停读取：数据留在套接字缓冲区，稍后再继续
+    if (client.parked || client.throttled) {
+        return;
     }
-    
-    auto& client = **client_ptr;
     
     // 动态缓冲区：根据数据量调整大小
     constexpr size_t INITIAL_BUFFER_SIZE = 8 * 1024;  // 8KB初始缓冲区
@@ -169,59 +371,638 @@ void WorkerThread::process_client_data(int client_fd) {
             return;
         }
         
+        client.last_active_ms = Clock::coarse_ms32();
+        if (client.byte_bucket.limited()) {
+            client.byte_bucket.consume(static_cast<double>(n), now_us());
+        }
+        
         // 解析命令
         std::string_view data(client.read_buffer.data(), n);
-        auto commands = client.parser.parse(data);
+        client.parser.parse(data, batch_, spare_commands_);
         
-        // 处理命令（针对管道模式优化）
-        if (!commands.empty()) {
-            // 预分配响应缓冲区以减少重分配
-            std::string batch_response;
-            batch_response.reserve(commands.size() * 64); // 预估每个响应64字节
-            
-            size_t valid_count = 0;
-            
-            for (const auto& cmd : commands) {
-                if (!cmd.empty()) {
-                    std::string response = handler_->handle(cmd);
-                    batch_response += response;
-                    valid_count++;
+        bool alive = batch_.empty() || execute_commands(client_fd, client, batch_, 0);
+        RESPParser::recycle(batch_, spare_commands_);
+        if (!alive) {
+            return;  // 连接已关闭
+        }
+        if (throttle_if_needed(client_fd, client) || client.parked) {
+            return;
+        }
+    }
+}
+
+bool WorkerThread::execute_commands(int client_fd, ClientInfo& client,
+                                    std::vector<std::vector<std::string>>& commands, size_t begin) {
+    // 回复直接写入连接的输出缓冲区（跨批次复用容量）
+    ReplyBuilder reply(client.write_buffer);
+    size_t reply_start = reply.size();
+    
+    size_t valid_count = 0;
+    auto& capture = CommandCapture::instance();
+    
+    for (size_t i = begin; i < commands.size(); ++i) {
+        const auto& cmd = commands[i];
+        if (cmd.empty()) {
+            continue;
+        }
+        if (client.command_bucket.limited() && !client.command_bucket.try_consume(1, now_us())) {
+            // 命令令牌不足：剩余命令留到令牌补足后执行
+            client.parked_commands.assign(std::make_move_iterator(commands.begin() + i),
+                                          std::make_move_iterator(commands.end()));
+            throttle(client_fd, client, client.command_bucket.wait_us(1));
+            break;
+        }
+        if (capture.active()) {
+            capture.record(client.id, cmd);
+        }
+        // CLIENT 作用于连接本身，由连接层处理
+        if (cmd[0].size() == 6 && strncasecmp(cmd[0].data(), "client", 6) == 0) {
+            handle_client_command(client_fd, client, cmd, reply);
+            valid_count++;
+            continue;
+        }
+        if (admission_.overloaded() && should_shed(cmd)) {
+            reply.raw(BUSY_REPLY);
+            continue;
+        }
+        if (slow_pool_ && handler_->is_slow(cmd) && offload(client_fd, client.id, cmd)) {
+            // 其后的命令等慢命令完成后再执行，保证回复顺序
+            client.parked = true;
+            client.parked_commands.assign(std::make_move_iterator(commands.begin() + i + 1),
+                                          std::make_move_iterator(commands.end()));
+            break;
+        }
+        // 连续的 SET 合并写入：同一子map只加一次锁（限速中的连接逐条执行，按条扣减令牌）
+        if (!client.command_bucket.limited()) {
+            size_t combined = handler_->handle_set_run(commands, i, reply);
+            if (combined > 0) {
+                if (capture.active()) {
+                    for (size_t k = i + 1; k < i + combined; ++k) {
+                        capture.record(client.id, commands[k]);
+                    }
                 }
+                valid_count += combined;
+                i += combined - 1;
+                continue;
+            }
+        }
+        handler_->handle(cmd, reply);
+        valid_count++;
+    }
+    
+    single_writer_add(processed_commands_, valid_count);
+    
+    // 慢命令之前的回复先发出；慢命令的结果只会在本函数返回后由事件循环处理
+    if (reply.size() != reply_start) {
+        return flush_output(client_fd, client);
+    }
+    return true;
+}
+
+bool WorkerThread::should_shed(const std::vector<std::string>& cmd) {
+    uint32_t flags = handler_->command_flags(cmd);
+    auto priority = (flags & CommandHandler::CMD_ADMIN) ? AdmissionControl::Priority::Critical
+                  : (flags & CommandHandler::CMD_SLOW) ? AdmissionControl::Priority::Low
+                  : AdmissionControl::Priority::Normal;
+    if (!admission_.should_shed(priority)) {
+        return false;
+    }
+    admission_.record_shed();
+    return true;
+}
+
+bool WorkerThread::offload(int client_fd, uint64_t client_id, const std::vector<std::string>& cmd) {
+    auto handler = handler_;
+    return slow_pool_->submit([this, handler, client_fd, client_id, cmd]() {
+        post_completion(client_fd, client_id, handler->handle(cmd));
+    });
+}
+
+void WorkerThread::post_completion(int client_fd, uint64_t client_id, std::string response) {
+    {
+        std::lock_guard<std::mutex> lock(completion_mutex_);
+        completions_.push_back(Completion{client_fd, client_id, std::move(response)});
+    }
+    uint64_t one = 1;
+    ssize_t n = write(completion_fd_, &one, sizeof(one));
+    (void)n;
+}
+
+void WorkerThread::handle_completions() {
+    uint64_t value;
+    ssize_t n = read(completion_fd_, &value, sizeof(value));
+    (void)n;
+    
+    std::vector<Completion> done;
+    {
+        std::lock_guard<std::mutex> lock(completion_mutex_);
+        done.swap(completions_);
+    }
+    
+    for (auto& completion : done) {
+        ClientInfo* client = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex_);
+            auto it = clients_.find(completion.client_fd);
+            // 连接ID不符说明原连接已关闭、描述符被新连接复用
+            if (it != clients_.end() && it->second->id == completion.client_id) {
+                client = it->second.get();
             }
-            
-            if (!batch_response.empty()) {
-                send_response(client_fd, batch_response);
+        }
+        if (!client) {
+            complete_shm_request(completion);
+            continue;
+        }
+        if (!client->parked) {
+            continue;
+        }
+        
+        client->parked = false;
+        single_writer_add(processed_commands_);
+        if (!send_response(completion.client_fd, *client, completion.response)) {
+            continue;
+        }
+        
+        // 执行慢命令之后排队的命令（可能再次遇到慢命令），再继续读取暂停期间到达的数据
+        auto pending = std::move(client->parked_commands);
+        client->parked_commands.clear();
+        if (!pending.empty() && !execute_commands(completion.client_fd, *client, pending, 0)) {
+            continue;
+        }
+        if (!client->parked) {
+            process_client_data(completion.client_fd);
+        }
+    }
+}
+
+void WorkerThread::complete_shm_request(Completion& completion) {
+    auto session = find_shm_session(completion.client_fd);
+    if (!session || session->id() != completion.client_id || !session->parked) {
+        return;
+    }
+    
+    session->parked = false;
+    single_writer_add(processed_commands_);
+    // 慢命令挂起时不再读取请求，暂存回复必然为空；由 process_shm_requests 先发出它，再继续处理积压的请求
+    session->pending_response = std::move(completion.response);
+    process_shm_requests(session);
+}
+
+void WorkerThread::add_shm_session(std::unique_ptr<ShmSession> session) {
+    std::shared_ptr<ShmSession> shared(std::move(session));
+    shared->addr = peer_address(shared->control_fd());
+    // 在接受线程中执行：读取线程池发布的快照（同 add_client）
+    if (pool_) {
+        apply_rate_rule(*shared, *pool_->client_limits().load());
+    } else {
+        apply_rate_rule(*shared, limits_);
+    }
+    
+    // 同TCP连接：先登记再加入epoll
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        shm_sessions_[shared->doorbell_fd()] = shared;
+        shm_sessions_[shared->control_fd()] = shared;
+        client_count_++;
+    }
+    
+    for (int fd : {shared->doorbell_fd(), shared->control_fd()}) {
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.u64 = SHM_EVENT_TAG | static_cast<uint32_t>(fd);
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            remove_shm_session(shared);
+            return;
+        }
+    }
+}
+
+void WorkerThread::remove_shm_session(const std::shared_ptr<ShmSession>& session) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, session->doorbell_fd(), nullptr);
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, session->control_fd(), nullptr);
+    
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    if (shm_sessions_.erase(session->doorbell_fd()) > 0) {
+        g_client_memory.fetch_sub(session->memory.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        session->memory.store(0, std::memory_order_relaxed);
+        client_count_--;
+    }
+    shm_sessions_.erase(session->control_fd());
+}
+
+std::shared_ptr<ShmSession> WorkerThread::find_shm_session(int fd) {
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    auto it = shm_sessions_.find(fd);
+    return it == shm_sessions_.end() ? nullptr : it->second;
+}
+
+void WorkerThread::handle_shm_event(int fd) {
+    auto session = find_shm_session(fd);
+    if (!session) return;
+    
+    // 控制连接握手后不再有数据，可读即表示客户端已退出
+    if (fd == session->control_fd()) {
+        LOG_DEBUG("Shared memory client %lu disconnected", static_cast<unsigned long>(session->id()));
+        remove_shm_session(session);
+        return;
+    }
+    
+    session->clear_doorbell();
+    process_shm_requests(session);
+}
+
+void WorkerThread::process_shm_requests(const std::shared_ptr<ShmSession>& shared) {
+    auto& session = *shared;
+    auto& requests = session.requests();
+    auto& capture = CommandCapture::instance();
+    shm::Consumer::Message message;
+    std::vector<std::string> cmd;
+    uint64_t processed = 0;
+    
+    while (!session.parked && !session.throttled) {
+        // 先发出上次因响应通道满而暂存的回复
+        if (!session.pending_response.empty()) {
+            if (!session.send_response(session.pending_response)) break;
+            session.pending_response.clear();
+            if (session.pending_response.capacity() > OUTPUT_BUFFER_KEEP) {
+                std::string().swap(session.pending_response);
+            }
+        }
+        
+        // 命令令牌不足：请求留在通道中，令牌补足后再处理
+        if (session.command_bucket.limited() && !requests.empty() &&
+            !session.command_bucket.try_consume(1, now_us())) {
+            throttle(session, session.command_bucket.wait_us(1));
+            break;
+        }
+        
+        if (!requests.peek(message)) {
+            if (requests.corrupted()) break;
+            // 登记等待后复查，期间到达的请求由客户端敲门铃或在此直接处理
+            if (requests.prepare_wait()) break;
+            continue;
+        }
+        
+        if (session.byte_bucket.limited()) {
+            size_t bytes = 0;
+            for (const auto& part : message.parts) {
+                bytes += part.size();
             }
-            processed_commands_ += valid_count;
+            session.byte_bucket.consume(static_cast<double>(bytes), now_us());
+        }
+        
+        // 参数复制出共享段后即可释放请求占用的空间
+        cmd.assign(message.parts.begin(), message.parts.end());
+        if (requests.release(message)) {
+            session.ring_client();
+        }
+        if (capture.active()) {
+            capture.record(session.id(), cmd);
+        }
+        std::string response;
+        if (cmd.empty()) {
+            response = "-ERR empty command\r\n";
+        } else if (admission_.overloaded() && should_shed(cmd)) {
+            response = BUSY_REPLY;
+        } else if (slow_pool_ && handler_->is_slow(cmd) && offload(session.doorbell_fd(), session.id(), cmd)) {
+            // 其后的请求留在通道中，等慢命令完成后再处理
+            session.parked = true;
+            break;
+        } else {
+            response = handler_->handle(cmd);
+            processed++;
+        }
+        
+        if (!session.send_response(response)) {
+            session.pending_response = std::move(response);
+            break;
         }
         
-        client.last_active = std::chrono::steady_clock::now();
+        // 字节令牌透支：暂停读取后续请求
+        uint64_t wait = session.byte_bucket.wait_us();
+        if (wait > 0) {
+            throttle(session, wait);
+        }
+    }
+    update_client_memory(session);
+    
+    single_writer_add(processed_commands_, processed);
+    
+    // 客户端写坏了共享段：不再分发其中的任何内容，直接关闭会话
+    if (session.broken()) {
+        LOG_WARN("Shared memory client %lu violated the ring protocol, closing session",
+                 static_cast<unsigned long>(session.id()));
+        remove_shm_session(shared);
     }
 }
 
-void WorkerThread::send_response(int client_fd, const std::string& response) {
-    size_t total_sent = 0;
-    size_t total_size = response.size();
-    const char* data = response.data();
+bool WorkerThread::send_response(int client_fd, ClientInfo& client, const std::string& response) {
+    // 追加在积压数据之后，保证回复顺序
+    client.write_buffer.append(response);
+    return flush_output(client_fd, client);
+}
+
+bool WorkerThread::flush_output(int client_fd, ClientInfo& client) {
+    while (client.write_pos < client.write_buffer.size()) {
+        ssize_t sent = send(client_fd, client.write_buffer.data() + client.write_pos,
+                            client.write_buffer.size() - client.write_pos, MSG_NOSIGNAL);
+        if (sent > 0) {
+            client.write_pos += sent;
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        remove_client(client_fd);
+        return false;
+    }
     
-    while (total_sent < total_size) {
-        ssize_t sent = send(client_fd, data + total_sent, total_size - total_sent, MSG_NOSIGNAL);
-        if (sent < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // 对于非阻塞socket，这是正常的，应该稍后重试
-                // 但为了简化，我们这里继续尝试
-                continue;
-            } else {
-                // 真正的错误
-                remove_client(client_fd);
+    if (client.write_pos == client.write_buffer.size()) {
+        // 全部发出：保留容量供下一批回复复用，过大时才释放
+        client.write_pos = 0;
+        client.write_buffer.clear();
+        client.soft_limit_since_ms = 0;
+        if (client.write_buffer.capacity() > OUTPUT_BUFFER_KEEP) {
+            std::string().swap(client.write_buffer);
+        }
+        update_client_memory(client);
+        return true;
+    }
+    
+    // 已发送部分过半时前移剩余数据，避免积压期间缓冲区只增不减
+    if (client.write_pos >= client.write_buffer.size() / 2) {
+        client.write_buffer.erase(0, client.write_pos);
+        client.write_pos = 0;
+    }
+    
+    // 输出缓冲区限制：超过硬限制立即断开，持续超过软限制达到时限后断开
+    size_t pending = client.write_buffer.size() - client.write_pos;
+    const char* exceeded = nullptr;
+    if (limits_.output_hard_bytes > 0 && pending > limits_.output_hard_bytes) {
+        exceeded = "hard";
+    } else if (limits_.output_soft_bytes > 0 && pending > limits_.output_soft_bytes) {
+        uint32_t now = std::max<uint32_t>(1, Clock::coarse_ms32());
+        if (client.soft_limit_since_ms == 0) {
+            client.soft_limit_since_ms = now;
+        } else if (Clock::elapsed_ms(client.soft_limit_since_ms, now) >= limits_.output_soft_seconds * 1000u) {
+            exceeded = "soft";
+        }
+    } else {
+        client.soft_limit_since_ms = 0;
+    }
+    if (exceeded) {
+        LOG_WARN("Closing client %lu (%s): output buffer %zu bytes over %s limit",
+                 static_cast<unsigned long>(client.id), client.addr.c_str(), pending, exceeded);
+        g_evicted_clients.fetch_add(1, std::memory_order_relaxed);
+        remove_client(client_fd);
+        return false;
+    }
+    
+    update_client_memory(client);
+    return true;
+}
+
+void WorkerThread::update_client_memory(ClientInfo& client) {
+    size_t current = client.read_buffer.capacity() + client.write_buffer.capacity();
+    size_t previous = client.memory.load(std::memory_order_relaxed);
+    if (current != previous) {
+        client.memory.store(current, std::memory_order_relaxed);
+        // 无符号回绕加法同样适用于减少的情况
+        g_client_memory.fetch_add(current - previous, std::memory_order_relaxed);
+    }
+}
+
+void WorkerThread::update_client_memory(ShmSession& session) {
+    // 共享段大小固定、与客户端数据量无关，只计入堆上暂存的回复
+    size_t current = session.pending_response.capacity();
+    size_t previous = session.memory.load(std::memory_order_relaxed);
+    if (current != previous) {
+        session.memory.store(current, std::memory_order_relaxed);
+        g_client_memory.fetch_add(current - previous, std::memory_order_relaxed);
+    }
+}
+
+void WorkerThread::collect_memory_usage(size_t worker, std::vector<MemoryUsage>& out) {
+    // 由线程池的后台任务调用：只读取已计入的字节数（原子量），逐出交给本线程执行
+    // （共享内存会话以门铃描述符登记，只有暂存回复时才会成为候选）
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    for (const auto& [fd, client] : clients_) {
+        size_t memory = client->memory.load(std::memory_order_relaxed);
+        if (memory > CLIENT_BASE_MEMORY) {
+            out.push_back(MemoryUsage{memory, fd, client->id, worker});
+        }
+    }
+    for (const auto& [fd, session] : shm_sessions_) {
+        size_t memory = session->memory.load(std::memory_order_relaxed);
+        if (fd == session->doorbell_fd() && memory > 0) {
+            out.push_back(MemoryUsage{memory, fd, session->id(), worker});
+        }
+    }
+}
+
+void WorkerThread::request_eviction(const MemoryUsage& usage, size_t limit) {
+    // 在本线程关闭之前，这部分内存视为即将释放，避免下一轮扫描重复挑选
+    g_pending_eviction.fetch_add(usage.memory, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(completion_mutex_);
+        evictions_.push_back(Eviction{usage.fd, usage.id, usage.memory, limit});
+    }
+    uint64_t one = 1;
+    ssize_t n = write(completion_fd_, &one, sizeof(one));
+    (void)n;
+}
+
+void WorkerThread::handle_evictions() {
+    std::vector<Eviction> pending;
+    {
+        std::lock_guard<std::mutex> lock(completion_mutex_);
+        pending.swap(evictions_);
+    }
+    
+    for (const auto& eviction : pending) {
+        g_pending_eviction.fetch_sub(eviction.memory, std::memory_order_relaxed);
+        // 连接ID不符说明原连接已关闭、描述符被新连接复用
+        bool tcp = false;
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex_);
+            auto it = clients_.find(eviction.fd);
+            tcp = it != clients_.end() && it->second->id == eviction.id;
+        }
+        auto session = tcp ? nullptr : find_shm_session(eviction.fd);
+        if (!tcp && (!session || session->id() != eviction.id)) {
+            continue;
+        }
+        
+        LOG_WARN("Closing client on fd %d: using %zu bytes while client memory is over the %zu byte limit",
+                 eviction.fd, eviction.memory, eviction.limit);
+        g_evicted_clients.fetch_add(1, std::memory_order_relaxed);
+        if (tcp) {
+            remove_client(eviction.fd);
+        } else {
+            remove_shm_session(session);
+        }
+    }
+}
+
+void WorkerThread::apply_rate_rule(ClientInfo& client, const ClientLimits& limits) {
+    configure_rate(limits, client.name, client.addr, client.command_bucket, client.byte_bucket);
+}
+
+void WorkerThread::apply_rate_rule(ShmSession& session, const ClientLimits& limits) {
+    // 共享内存会话不经过连接层的 CLIENT 命令，没有名称，只按来源地址匹配
+    configure_rate(limits, std::string(), session.addr, session.command_bucket, session.byte_bucket);
+}
+
+void WorkerThread::refresh_limits() {
+    uint64_t version = pool_->client_limits().version();
+    if (version == limits_version_) {
+        return;
+    }
+    limits_version_ = version;
+    limits_ = *pool_->client_limits().load();
+    
+    // 规则可能变化：现有连接重新匹配（令牌桶按新速率重置）
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    for (auto& entry : clients_) {
+        apply_rate_rule(*entry.second, limits_);
+    }
+    for (auto& [fd, session] : shm_sessions_) {
+        if (fd == session->doorbell_fd()) {
+            apply_rate_rule(*session, limits_);
+        }
+    }
+}
+
+void WorkerThread::throttle(int client_fd, ClientInfo& client, uint64_t wait_us) {
+    client.throttled = true;
+    client.throttle_until_us = now_us() + wait_us;
+    throttled_.emplace_back(client_fd, client.id);
+}
+
+void WorkerThread::throttle(ShmSession& session, uint64_t wait_us) {
+    session.throttled = true;
+    session.throttle_until_us = now_us() + wait_us;
+    throttled_.emplace_back(session.doorbell_fd(), session.id());
+}
+
+bool WorkerThread::throttle_if_needed(int client_fd, ClientInfo& client) {
+    if (client.throttled) {
+        return true;
+    }
+    uint64_t wait = client.byte_bucket.wait_us();
+    if (wait == 0) {
+        return false;
+    }
+    throttle(client_fd, client, wait);
+    return true;
+}
+
+void WorkerThread::resume_throttled() {
+    uint64_t now = now_us();
+    auto waiting = std::move(throttled_);
+    throttled_.clear();
+    
+    for (const auto& [fd, id] : waiting) {
+        ClientInfo* client = find_client(fd);
+        if (!client || client->id != id) {
+            resume_throttled_shm(fd, id, now);
+            continue;
+        }
+        if (now < client->throttle_until_us) {
+            throttled_.emplace_back(fd, id);
+            continue;
+        }
+        client->throttled = false;
+        
+        // 先执行限速时留下的命令（可能再次限速或遇到慢命令），再继续读取
+        auto pending = std::move(client->parked_commands);
+        client->parked_commands.clear();
+        if (!pending.empty() && !execute_commands(fd, *client, pending, 0)) {
+            continue;
+        }
+        process_client_data(fd, *client);
+    }
+}
+
+void WorkerThread::resume_throttled_shm(int fd, uint64_t id, uint64_t now) {
+    auto session = find_shm_session(fd);
+    if (!session || session->id() != id) {
+        return;
+    }
+    if (now < session->throttle_until_us) {
+        throttled_.emplace_back(fd, id);
+        return;
+    }
+    session->throttled = false;
+    process_shm_requests(session);
+}
+
+void WorkerThread::handle_client_command(int client_fd, ClientInfo& client,
+                                         const std::vector<std::string>& cmd, ReplyBuilder& reply) {
+    if (cmd.size() < 2) {
+        reply.error("ERR wrong number of arguments for 'client' command");
+        return;
+    }
+    std::string sub = cmd[1];
+    std::transform(sub.begin(), sub.end(), sub.begin(), ::tolower);
+    
+    if (sub == "id" && cmd.size() == 2) {
+        reply.integer(static_cast<int64_t>(client.id));
+        return;
+    }
+    if (sub == "getname" && cmd.size() == 2) {
+        if (client.name.empty()) {
+            reply.nil();
+        } else {
+            reply.bulk(client.name);
+        }
+        return;
+    }
+    if (sub == "setname" && cmd.size() == 3) {
+        const std::string& name = cmd[2];
+        for (char c : name) {
+            if (c < '!' || c > '~') {
+                reply.error("ERR Client names cannot contain spaces, newlines or special characters.");
                 return;
             }
-        } else if (sent == 0) {
-            // 连接关闭
-            remove_client(client_fd);
-            return;
         }
-        total_sent += sent;
+        // 名称变化后重新匹配限速规则
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        client.name = name;
+        apply_rate_rule(client, limits_);
+        reply.ok();
+        return;
+    }
+    if (sub == "info" && cmd.size() == 2) {
+        std::string line;
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex_);
+            describe_client(client, client_fd, line);
+        }
+        reply.bulk(line);
+        return;
+    }
+    if (sub == "list" && cmd.size() == 2) {
+        reply.bulk(pool_ ? pool_->describe_clients() : std::string());
+        return;
+    }
+    reply.error("ERR unknown subcommand or wrong number of arguments for 'client' command");
+}
+
+void WorkerThread::describe_client(const ClientInfo& client, int client_fd, std::string& out) {
+    uint32_t now = Clock::coarse_ms32();
+    char line[256];
+    snprintf(line, sizeof(line), " fd=%d age=%u tot-mem=%zu rl-cmd=%.0f rl-bytes=%.0f worker=%d\n",
+             client_fd, Clock::elapsed_ms(client.created_ms, now) / 1000,
+             client.memory.load(std::memory_order_relaxed),
+             client.command_bucket.rate, client.byte_bucket.rate, worker_id_);
+    out += "id=" + std::to_string(client.id) + " addr=" + client.addr + " name=" + client.name;
+    out += line;
+}
+
+void WorkerThread::describe_clients(std::string& out) {
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    for (const auto& [fd, client] : clients_) {
+        describe_client(*client, fd, out);
     }
 }
 
@@ -231,20 +1012,34 @@ ThreadPool::ThreadPool(size_t worker_count, std::shared_ptr<CommandHandler> hand
 }
 
 ThreadPool::ThreadPool(size_t worker_count, std::shared_ptr<CommandHandler> handler, const Options& options)
-    : handler_(handler), options_(options) {
+    : handler_(handler), options_(options), client_limits_(options.client_limits) {
     
     // 初始化CPU分配方案
     initialize_cpu_assignment(worker_count);
     
+    if (options_.slow_threads > 0) {
+        SlowCommandPool::Options slow_options;
+        slow_options.threads = options_.slow_threads;
+        slow_options.queue_limit = options_.slow_queue_limit;
+        slow_pool_ = std::make_unique<SlowCommandPool>(slow_options);
+    }
+    
     workers_.reserve(worker_count);
     for (size_t i = 0; i < worker_count; ++i) {
         int cpu_id = options_.enable_cpu_affinity ? cpu_assignments_[i] : -1;
-        workers_.emplace_back(std::make_unique<WorkerThread>(i, handler, cpu_id));
+        workers_.emplace_back(std::make_unique<WorkerThread>(i, handler, cpu_id, options_.admission,
+                                                                options_.client_limits, options_.busy_poll));
+        workers_.back()->set_slow_pool(slow_pool_.get());
+        workers_.back()->set_pool(this);
+    }
+    
+    if (options_.steer_by_incoming_cpu) {
+        initialize_locality();
     }
     
     // 打印CPU分配信息
     if (options_.enable_cpu_affinity) {
-        std::cout << "Thread Pool CPU Affinity Configuration:" << std::endl;
+        LOG_INFO("Thread Pool CPU Affinity Configuration:");
         ThreadAffinity::print_system_info();
         print_cpu_assignment();
     }
@@ -255,18 +1050,84 @@ ThreadPool::~ThreadPool() {
 }
 
 void ThreadPool::start() {
+    if (slow_pool_) {
+        slow_pool_->start();
+    }
     for (auto& worker : workers_) {
         worker->start();
     }
+    
+    // 与 Worker 事件循环的空闲唤醒同一节奏检查客户端内存
+    TaskScheduler::TaskOptions memory_options;
+    memory_options.name = "client-memory";
+    memory_options.priority = TaskScheduler::Priority::HIGH;
+    memory_options.delay = std::chrono::milliseconds(100);
+    memory_options.period = std::chrono::milliseconds(100);
+    memory_task_ = TaskScheduler::instance().schedule([this] { enforce_client_memory_cap(); }, memory_options);
 }
 
 void ThreadPool::stop() {
+    // 等待正在执行的扫描结束，之后不会再向 Worker 投递逐出请求
+    if (memory_task_ != 0) {
+        TaskScheduler::instance().cancel(memory_task_);
+        memory_task_ = 0;
+    }
+    // 先停慢命令线程池：排队的任务执行完并把结果投递给仍然存在的 Worker
+    if (slow_pool_) {
+        slow_pool_->stop();
+    }
     for (auto& worker : workers_) {
         worker->stop();
     }
 }
 
-void ThreadPool::assign_client(int client_fd) {
+void ThreadPool::enforce_client_memory_cap() {
+    size_t limit = client_limits_.load()->max_client_memory;
+    // 已选中、尚未关闭的连接按已释放计算，避免在 Worker 处理之前重复逐出
+    size_t used = g_client_memory.load(std::memory_order_relaxed);
+    size_t pending = g_pending_eviction.load(std::memory_order_relaxed);
+    if (limit == 0 || used <= pending || used - pending <= limit) {
+        return;
+    }
+    
+    // 汇总所有Worker的连接，按占用从全局最大开始逐出，直到预计总量回到上限以下
+    std::vector<WorkerThread::MemoryUsage> candidates;
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i]->collect_memory_usage(i, candidates);
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto& a, const auto& b) { return a.memory > b.memory; });
+    
+    size_t remaining = used - pending;
+    for (const auto& usage : candidates) {
+        if (remaining <= limit) {
+            break;
+        }
+        workers_[usage.worker]->request_eviction(usage, limit);
+        remaining -= std::min(remaining, usage.memory);
+    }
+}
+
+uint64_t ThreadPool::next_connection_id() {
+    return g_next_connection_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ThreadPool::assign_shm_session(std::unique_ptr<ShmSession> session) {
+    size_t best_worker = 0;
+    size_t min_clients = workers_[0]->get_client_count();
+    
+    for (size_t i = 1; i < workers_.size(); ++i) {
+        size_t count = workers_[i]->get_client_count();
+        if (count < min_clients) {
+            min_clients = count;
+            best_worker = i;
+        }
+    }
+    
+    workers_[best_worker]->add_shm_session(std::move(session));
+}
+
+void ThreadPool::assign_client(int client_fd, bool tcp) {
     // 负载均衡：选择客户端数量最少的Worker
     size_t best_worker = 0;
     size_t min_clients = workers_[0]->get_client_count();
@@ -279,13 +1140,96 @@ void ThreadPool::assign_client(int client_fd) {
         }
     }
     
-    workers_[best_worker]->add_client(client_fd);
+    // 按收包CPU引导：RX软中断与命令处理在同一核心（或共享缓存的核心）上，请求数据不跨核心搬运
+    if (tcp && !cpu_locality_.empty()) {
+        best_worker = steer(client_fd, best_worker, min_clients);
+    }
+    
+    workers_[best_worker]->add_client(client_fd, tcp);
     
     // 记录映射关系
     std::lock_guard<std::mutex> lock(mapping_mutex_);
     client_to_worker_[client_fd] = best_worker;
 }
 
+size_t ThreadPool::steer(int client_fd, size_t fallback, size_t min_clients) {
+    // 就近的Worker比最空闲的多出不到 1/4（加少量余量）时才采用，避免收包集中在少数队列时连接全部堆到一个Worker
+    constexpr size_t STEERING_SLACK = 8;
+    int cpu = -1;
+#ifdef SO_INCOMING_CPU
+    socklen_t len = sizeof(cpu);
+    if (getsockopt(client_fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) < 0) {
+        cpu = -1;
+    }
+#endif
+    if (cpu >= 0 && static_cast<size_t>(cpu) < cpu_locality_.size()) {
+        size_t limit = min_clients + min_clients / 4 + STEERING_SLACK;
+        for (size_t tier = 0; tier < LOCALITY_TIERS; ++tier) {
+            size_t best = workers_.size();
+            size_t best_clients = 0;
+            for (size_t worker : cpu_locality_[cpu][tier]) {
+                size_t count = workers_[worker]->get_client_count();
+                if (best == workers_.size() || count < best_clients) {
+                    best = worker;
+                    best_clients = count;
+                }
+            }
+            if (best != workers_.size() && best_clients <= limit) {
+                steered_[tier].fetch_add(1, std::memory_order_relaxed);
+                return best;
+            }
+        }
+    }
+    steered_[LOCALITY_TIERS].fetch_add(1, std::memory_order_relaxed);
+    return fallback;
+}
+
+void ThreadPool::initialize_locality() {
+    if (!options_.enable_cpu_affinity) {
+        LOG_WARN("Connection steering by incoming CPU needs CPU affinity; using least-loaded assignment");
+        return;
+    }
+    
+    // 每个CPU上绑定的Worker
+    size_t cpu_count = ThreadAffinity::get_cpu_count();
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        cpu_count = std::max(cpu_count, static_cast<size_t>(std::max(0, workers_[i]->get_cpu_affinity()) + 1));
+    }
+    std::vector<std::vector<size_t>> workers_on_cpu(cpu_count);
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        int cpu = workers_[i]->get_cpu_affinity();
+        if (cpu >= 0) {
+            workers_on_cpu[cpu].push_back(i);
+        }
+    }
+    
+    cpu_locality_.assign(cpu_count, {});
+    size_t local_cpus = 0;
+    for (size_t cpu = 0; cpu < cpu_count; ++cpu) {
+        auto& tiers = cpu_locality_[cpu];
+        tiers[0] = workers_on_cpu[cpu];
+        // 离得更近的一层已经包含的CPU不再重复列出
+        std::vector<int> seen = {static_cast<int>(cpu)};
+        auto add_tier = [&](size_t tier, const std::vector<int>& cpus) {
+            for (int other : cpus) {
+                if (other < 0 || static_cast<size_t>(other) >= cpu_count ||
+                    std::find(seen.begin(), seen.end(), other) != seen.end()) {
+                    continue;
+                }
+                seen.push_back(other);
+                tiers[tier].insert(tiers[tier].end(), workers_on_cpu[other].begin(), workers_on_cpu[other].end());
+            }
+        };
+        add_tier(1, ThreadAffinity::smt_siblings(static_cast<int>(cpu)));
+        add_tier(2, ThreadAffinity::llc_siblings(static_cast<int>(cpu)));
+        if (!tiers[0].empty() || !tiers[1].empty() || !tiers[2].empty()) {
+            local_cpus++;
+        }
+    }
+    LOG_INFO("Connection steering by incoming CPU: %zu of %zu CPUs have a worker on the same core or L3",
+             local_cpus, cpu_count);
+}
+
 void ThreadPool::remove_client(int client_fd) {
     std::lock_guard<std::mutex> lock(mapping_mutex_);
     auto it = client_to_worker_.find(client_fd);
@@ -295,6 +1239,43 @@ void ThreadPool::remove_client(int client_fd) {
     }
 }
 
+size_t ThreadPool::client_count() const {
+    size_t total = 0;
+    for (const auto& worker : workers_) {
+        total += worker->get_client_count();
+    }
+    return total;
+}
+
+bool ThreadPool::overloaded() const {
+    if (!options_.admission.enabled) {
+        return false;
+    }
+    for (const auto& worker : workers_) {
+        if (!worker->is_overloaded()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string ThreadPool::describe_clients() {
+    std::string out;
+    for (auto& worker : workers_) {
+        worker->describe_clients(out);
+    }
+    return out;
+}
+
+std::vector<LoopHeartbeat*> ThreadPool::get_heartbeats() const {
+    std::vector<LoopHeartbeat*> heartbeats;
+    heartbeats.reserve(workers_.size());
+    for (const auto& worker : workers_) {
+        heartbeats.push_back(worker->get_heartbeat());
+    }
+    return heartbeats;
+}
+
 ThreadPool::Stats ThreadPool::get_stats() const {
     Stats stats;
     stats.total_clients = 0;
@@ -311,6 +1292,28 @@ ThreadPool::Stats ThreadPool::get_stats() const {
         stats.total_commands += stats.worker_commands[i];
     }
     
+    for (const auto& worker : workers_) {
+        stats.worker_busy_poll.push_back(worker->get_busy_poll_stats());
+        stats.shed_commands += worker->get_shed_commands();
+        if (worker->is_overloaded()) {
+            stats.overloaded_workers++;
+        }
+    }
+    
+    stats.steered_same_cpu = steered_[0].load(std::memory_order_relaxed);
+    stats.steered_smt = steered_[1].load(std::memory_order_relaxed);
+    stats.steered_llc = steered_[2].load(std::memory_order_relaxed);
+    stats.steered_remote = steered_[LOCALITY_TIERS].load(std::memory_order_relaxed);
+    
+    stats.client_memory = g_client_memory.load(std::memory_order_relaxed);
+    stats.evicted_clients = g_evicted_clients.load(std::memory_order_relaxed);
+    
+    if (slow_pool_) {
+        auto slow_stats = slow_pool_->stats();
+        stats.offloaded_commands = slow_stats.submitted;
+        stats.offload_rejected = slow_stats.rejected;
+    }
+    
     return stats;
 }
 
@@ -340,16 +1343,24 @@ void ThreadPool::initialize_cpu_assignment(size_t worker_count) {
 void ThreadPool::enable_cpu_affinity(bool enable) {
     options_.enable_cpu_affinity = enable;
     // 注意：这个方法只在重启线程池后生效
-    std::cout << "CPU affinity " << (enable ? "enabled" : "disabled") 
-              << ". Restart required for changes to take effect." << std::endl;
+    LOG_INFO("CPU affinity %s. Restart required for changes to take effect.",
+             enable ? "enabled" : "disabled");
+}
+
+std::vector<int> ThreadPool::worker_cpus() const {
+    std::vector<int> cpus;
+    for (const auto& worker : workers_) {
+        int cpu_id = worker->get_cpu_affinity();
+        if (cpu_id >= 0) cpus.push_back(cpu_id);
+    }
+    return cpus;
 }
 
 void ThreadPool::print_cpu_assignment() const {
-    std::cout << "Worker Thread CPU Assignments:" << std::endl;
+    LOG_INFO("Worker Thread CPU Assignments:");
     for (size_t i = 0; i < workers_.size(); ++i) {
         int cpu_id = workers_[i]->get_cpu_affinity();
-        std::cout << "  Worker " << i << " -> CPU " 
-                  << (cpu_id >= 0 ? std::to_string(cpu_id) : "Not bound") << std::endl;
+        LOG_INFO("  Worker %zu -> CPU %s", i,
+                 cpu_id >= 0 ? std::to_string(cpu_id).c_str() : "Not bound");
     }
-    std::cout << std::endl;
 }
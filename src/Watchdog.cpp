@@ -0,0 +1,147 @@
+#include "Watchdog.h"
+#include "Logger.h"
+#include <execinfo.h>
+#include <signal.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    // 栈采样信号
+    constexpr int STACK_SAMPLE_SIGNAL = SIGUSR2;
+    constexpr int MAX_FRAMES = 48;
+
+    // 采样状态：看门狗同一时间只采一个线程
+    enum SampleState : int {
+        SAMPLE_IDLE = 0,
+        SAMPLE_REQUESTED = 1,
+        SAMPLE_DONE = 2
+    };
+
+    std::atomic<int> g_sample_state{SAMPLE_IDLE};
+    void* g_sample_frames[MAX_FRAMES];
+    std::atomic<int> g_sample_depth{0};
+
+    void stack_sample_handler(int) {
+        if (g_sample_state.load(std::memory_order_acquire) != SAMPLE_REQUESTED) return;
+        int saved_errno = errno;
+        // backtrace 在首次调用后不再分配内存（安装处理函数时已预热）
+        int depth = backtrace(g_sample_frames, MAX_FRAMES);
+        g_sample_depth.store(depth, std::memory_order_relaxed);
+        g_sample_state.store(SAMPLE_DONE, std::memory_order_release);
+        errno = saved_errno;
+    }
+}
+
+Watchdog::Watchdog(const Options& options)
+    : options_(options) {
+}
+
+Watchdog::~Watchdog() {
+    stop();
+}
+
+void Watchdog::watch(const std::string& name, LoopHeartbeat* heartbeat) {
+    watched_.push_back(Watched{name, heartbeat});
+}
+
+void Watchdog::start() {
+    if (running_.exchange(true)) return;
+    install_signal_handler();
+    thread_ = std::thread(&Watchdog::watch_loop, this);
+}
+
+void Watchdog::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void Watchdog::install_signal_handler() {
+    // 预热 backtrace：首次调用会加载 libgcc，可能分配内存，不能发生在信号处理函数中
+    void* warmup[2];
+    backtrace(warmup, 2);
+
+    struct sigaction sa;
+    std::memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = stack_sample_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;  // 被打断的 recv/send 自动重启，不影响连接处理
+    sigaction(STACK_SAMPLE_SIGNAL, &sa, nullptr);
+}
+
+std::string Watchdog::capture_stack(pthread_t thread) {
+    g_sample_depth.store(0, std::memory_order_relaxed);
+    g_sample_state.store(SAMPLE_REQUESTED, std::memory_order_release);
+
+    if (pthread_kill(thread, STACK_SAMPLE_SIGNAL) != 0) {
+        g_sample_state.store(SAMPLE_IDLE, std::memory_order_relaxed);
+        return "";
+    }
+
+    // 最多等待100ms
+    for (int i = 0; i < 100 && g_sample_state.load(std::memory_order_acquire) != SAMPLE_DONE; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (g_sample_state.load(std::memory_order_acquire) != SAMPLE_DONE) {
+        g_sample_state.store(SAMPLE_IDLE, std::memory_order_relaxed);
+        return "";
+    }
+
+    int depth = g_sample_depth.load(std::memory_order_relaxed);
+    std::string result;
+    char** symbols = backtrace_symbols(g_sample_frames, depth);
+    // 跳过信号处理函数自身和内核信号跳板两帧
+    for (int i = 2; i < depth; ++i) {
+        result += "  #" + std::to_string(i - 2) + " ";
+        result += symbols ? symbols[i] : "?";
+        result += "\n";
+    }
+    std::free(symbols);
+
+    g_sample_state.store(SAMPLE_IDLE, std::memory_order_relaxed);
+    return result;
+}
+
+void Watchdog::watch_loop() {
+    const int64_t threshold_us = options_.threshold.count() * 1000;
+
+    while (running_) {
+        std::this_thread::sleep_for(options_.check_interval);
+
+        int64_t now = LoopHeartbeat::now_us();
+        for (auto& watched : watched_) {
+            auto* hb = watched.heartbeat;
+            int64_t busy_since = hb->busy_since_us.load(std::memory_order_relaxed);
+            if (busy_since == 0 || now - busy_since < threshold_us) continue;
+            if (!hb->thread_valid.load(std::memory_order_acquire)) continue;
+
+            {
+                std::lock_guard<std::mutex> lock(hb->stack_mutex);
+                if (hb->sampled_busy_since_us == busy_since) continue;  // 本次卡顿已采样
+                hb->sampled_busy_since_us = busy_since;
+            }
+
+            stalls_detected_.fetch_add(1, std::memory_order_relaxed);
+            std::string stack = capture_stack(hb->thread);
+
+            // 单条日志长度有限，栈逐帧输出
+            LOG_WARN("%s event loop stalled for %lld ms%s", watched.name.c_str(),
+                     static_cast<long long>((now - busy_since) / 1000),
+                     stack.empty() ? ", stack sample unavailable" : ", stack sample:");
+            size_t pos = 0;
+            while (pos < stack.size()) {
+                size_t eol = stack.find('\n', pos);
+                if (eol == std::string::npos) eol = stack.size();
+                LOG_WARN("%.*s", static_cast<int>(eol - pos), stack.data() + pos);
+                pos = eol + 1;
+            }
+
+            std::lock_guard<std::mutex> lock(hb->stack_mutex);
+            if (hb->sampled_busy_since_us == busy_since) {
+                hb->stack_sample = watched.name + " stalled, stack:\n" + stack;
+            }
+        }
+    }
+}
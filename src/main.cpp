@@ -1,6 +1,10 @@
 #include "Config.h"
+#include "AutoTune.h"
 #include "RedisServer.h"
 #include "Logo.h"
+#include "Logger.h"
+#include "Clock.h"
+#include "TaskScheduler.h"
 #include <iostream>
 #include <signal.h>
 
@@ -10,7 +14,7 @@ std::unique_ptr<RedisServer> g_server;
 void signal_handler(int signal) {
     if (g_server) {
         std::cout << "\nReceived signal " << signal << ", shutting down gracefully..." << std::endl;
-        g_server->stop();
+        g_server->request_stop();
     }
 }
 
@@ -31,25 +35,44 @@ int main(int argc, char* argv[]) {
         // 加载配置
         auto config = Config::load_from_file(config_file);
         
-        std::cout << "Loaded configuration from: " << config_file << std::endl;
-        std::cout << "Server configuration:" << std::endl;
-        std::cout << "  Host: " << config.host << std::endl;
-        std::cout << "  Port: " << config.port << std::endl;
-        std::cout << "  Worker threads: " << config.worker_threads << std::endl;
-        std::cout << "  IO threads: " << config.io_threads << std::endl;
-        std::cout << "  Shard count: " << config.shard_count << std::endl;
-        std::cout << "  Max connections: " << config.max_connections << std::endl;
-        std::cout << std::endl;
+        // 启动异步日志
+        Logger::Options log_options;
+        Logger::parse_level(config.log_level, log_options.level);  // 加载配置时已校验
+        log_options.rate_limit_per_sec = config.log_rate_limit;
+        Logger::instance().start(log_options);
+        
+        // 启动时间服务（粗粒度时钟与TSC校准），须在创建工作线程之前
+        Clock::instance().start();
+        
+        LOG_INFO("Loaded configuration from: %s", config_file.c_str());
+        
+        // 取值为 auto 的参数按硬件推导（可能附带短暂的自校准压测）
+        AutoTune::apply(config);
+        
+        LOG_INFO("Server configuration:");
+        LOG_INFO("  Host: %s", config.host.c_str());
+        LOG_INFO("  Port: %d", config.port);
+        LOG_INFO("  Worker threads: %zu", config.worker_threads);
+        LOG_INFO("  IO threads: %zu", config.io_threads);
+        LOG_INFO("  Shard count: %zu (%zu buckets each)", config.shard_count, config.bucket_per_shard);
+        LOG_INFO("  Max connections: %zu", config.max_connections);
         
         // 创建并启动服务器
         g_server = std::make_unique<RedisServer>(config);
         g_server->run();
+        g_server->stop();
         
     } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
+        LOG_ERROR("Error: %s", e.what());
+        TaskScheduler::instance().stop();
+        Clock::instance().stop();
+        Logger::instance().stop();
         return 1;
     }
     
-    std::cout << "===== Optimized Redis Server Stopped =====" << std::endl;
+    LOG_INFO("===== Optimized Redis Server Stopped =====");
+    TaskScheduler::instance().stop();
+    Clock::instance().stop();
+    Logger::instance().stop();
     return 0;
 }
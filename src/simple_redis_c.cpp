@@ -0,0 +1,111 @@
+#include "simple_redis.h"
+#include "EmbeddedStore.h"
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+
+struct sr_store {
+    EmbeddedStore store;
+
+    explicit sr_store(const EmbeddedStore::Options& options) : store(options) {}
+};
+
+namespace {
+    // 以 malloc 分配的副本返回给 C 调用方，由 sr_free 释放
+    char* copy_out(const char* data, size_t len) {
+        char* out = static_cast<char*>(std::malloc(len + 1));
+        if (!out) return nullptr;
+        std::memcpy(out, data, len);
+        out[len] = '\0';
+        return out;
+    }
+}
+
+extern "C" {
+
+void sr_options_init(sr_options* options) {
+    if (!options) return;
+    EmbeddedStore::Options defaults;
+    options->shard_count = defaults.shard_count;
+    options->cache_size = defaults.cache_size;
+    options->cache_shards = defaults.cache_shards;
+    options->enable_compression = defaults.enable_compression ? 1 : 0;
+    options->persist_path = nullptr;
+    options->sync_interval_sec = static_cast<uint32_t>(defaults.sync_interval.count());
+}
+
+sr_store* sr_open(const sr_options* options, char** error) {
+    EmbeddedStore::Options store_options;
+    if (options) {
+        store_options.shard_count = options->shard_count;
+        store_options.cache_size = options->cache_size;
+        store_options.cache_shards = options->cache_shards;
+        store_options.enable_compression = options->enable_compression != 0;
+        if (options->persist_path) store_options.persist_path = options->persist_path;
+        store_options.sync_interval = std::chrono::seconds(options->sync_interval_sec);
+    }
+
+    try {
+        return new sr_store(store_options);
+    } catch (const std::exception& e) {
+        if (error) *error = copy_out(e.what(), std::strlen(e.what()));
+    } catch (...) {
+        if (error) *error = copy_out("unknown error", 13);
+    }
+    return nullptr;
+}
+
+void sr_close(sr_store* store) {
+    delete store;
+}
+
+int sr_set(sr_store* store, const char* key, size_t key_len, const char* value, size_t value_len) {
+    if (!store || !key || (!value && value_len > 0)) return -1;
+    try {
+        store->store.set(std::string_view(key, key_len), std::string_view(value, value_len));
+        return 0;
+    } catch (...) {
+        return -1;
+    }
+}
+
+int sr_get(sr_store* store, const char* key, size_t key_len, char** value, size_t* value_len) {
+    if (!store || !key || !value) return -1;
+    try {
+        thread_local std::string buffer;
+        if (!store->store.get(std::string_view(key, key_len), buffer)) return 0;
+        *value = copy_out(buffer.data(), buffer.size());
+        if (!*value) return -1;
+        if (value_len) *value_len = buffer.size();
+        return 1;
+    } catch (...) {
+        return -1;
+    }
+}
+
+int sr_del(sr_store* store, const char* key, size_t key_len) {
+    if (!store || !key) return -1;
+    try {
+        return store->store.del(std::string_view(key, key_len)) ? 1 : 0;
+    } catch (...) {
+        return -1;
+    }
+}
+
+void sr_get_stats(sr_store* store, sr_stats* stats) {
+    if (!store || !stats) return;
+    auto s = store->store.stats();
+    stats->cache_hits = s.cache_hits;
+    stats->cache_misses = s.cache_misses;
+    stats->cache_evictions = s.cache_evictions;
+    stats->cache_items = s.cache_items;
+    stats->persistence_saves = s.persistence_saves;
+    stats->persistence_failures = s.persistence_failures;
+}
+
+void sr_free(void* ptr) {
+    std::free(ptr);
+}
+
+} // extern "C"
@@ -0,0 +1,343 @@
+// 热路径内存分配预算检查：统计 GET 命中 / SET 覆盖写在各层每条命令的堆分配次数
+// 替换全局 operator new 计数（标准容器与字符串的分配都经过它），超出预算时退出码为 1，
+// 可以在 CI 中直接作为回归检查运行。
+// 用法示例：
+//   simple_redis_bench_alloc -n 200000 -P 32
+//   simple_redis_bench_alloc --budget 0.01
+#include "RESPParser.h"
+#include "DataStore.h"
+#include "CommandHandler.h"
+#include "ReplyBuilder.h"
+#include "ThreadPool.h"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 计数范围：本线程打开 t_counting 时只统计本线程；端到端阶段打开 g_count_all 统计所有线程
+std::atomic<bool> g_count_all{false};
+std::atomic<uint64_t> g_allocations{0};
+thread_local bool t_counting = false;
+
+inline void note_allocation() {
+    if (t_counting || g_count_all.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void* allocate(std::size_t size) {
+    note_allocation();
+    return std::malloc(size ? size : 1);
+}
+
+void* allocate_aligned(std::size_t size, std::align_val_t align) {
+    note_allocation();
+    size_t alignment = static_cast<size_t>(align);
+    // aligned_alloc 要求大小是对齐值的整数倍
+    size_t rounded = (size + alignment - 1) / alignment * alignment;
+    return std::aligned_alloc(alignment, rounded ? rounded : alignment);
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (void* p = allocate(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+    if (void* p = allocate(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t align) {
+    if (void* p = allocate_aligned(size, align)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size, std::align_val_t align) {
+    if (void* p = allocate_aligned(size, align)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocate_aligned(size, align);
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocate_aligned(size, align);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+
+struct Options {
+    size_t ops = 200000;        // 每项测量的命令数
+    size_t keyspace = 1000;
+    size_t data_size = 64;
+    size_t pipeline = 32;
+    double budget = 0;          // 每条命令允许的分配次数
+    std::string path = "./bench_alloc_data/";
+};
+
+void usage() {
+    std::cout <<
+        "Usage: simple_redis_bench_alloc [options]\n"
+        "  -n <ops>           每项测量的命令数 (默认 200000)\n"
+        "  -r <keyspace>      键数量，GET 全部命中 (默认 1000)\n"
+        "  -d <size>          值大小（字节，默认 64）\n"
+        "  -P <pipeline>      每批命令数 (默认 32)\n"
+        "  --budget <n>       每条命令允许的分配次数，超出时退出码为 1 (默认 0)\n"
+        "  --dir <path>       临时持久化目录 (默认 ./bench_alloc_data/，结束后删除)\n";
+}
+
+std::string encode(const std::vector<std::string>& cmd) {
+    std::string out = "*" + std::to_string(cmd.size()) + "\r\n";
+    for (const auto& arg : cmd) {
+        out += "$" + std::to_string(arg.size()) + "\r\n" + arg + "\r\n";
+    }
+    return out;
+}
+
+struct Workload {
+    const char* name;
+    std::vector<std::vector<std::string>> commands;   // 每条命令
+    std::vector<std::string> batches;                 // 按流水线深度拼好的请求
+    std::vector<size_t> batch_commands;               // 每批的命令数
+    std::vector<size_t> batch_reply_bytes;            // 每批回复的总字节数
+};
+
+Workload make_workload(const char* name, const std::vector<std::string>& keys, const std::string& value,
+                       bool set, size_t pipeline) {
+    Workload w;
+    w.name = name;
+    for (const auto& key : keys) {
+        if (set) {
+            w.commands.push_back({"SET", key, value});
+        } else {
+            w.commands.push_back({"GET", key});
+        }
+    }
+    size_t reply_bytes = set ? ReplyBuilder::OK.size()
+                             : 1 + std::to_string(value.size()).size() + 2 + value.size() + 2;
+    for (size_t i = 0; i < w.commands.size(); i += pipeline) {
+        std::string batch;
+        size_t n = 0;
+        for (; n < pipeline && i + n < w.commands.size(); ++n) {
+            batch += encode(w.commands[i + n]);
+        }
+        w.batches.push_back(std::move(batch));
+        w.batch_commands.push_back(n);
+        w.batch_reply_bytes.push_back(n * reply_bytes);
+    }
+    return w;
+}
+
+struct Result {
+    std::string stage;
+    uint64_t allocations = 0;
+    size_t commands = 0;
+};
+
+// 先预热一轮让各级缓冲区容量稳定，再统计
+template <typename Body>
+Result measure(const std::string& stage, size_t ops, bool all_threads, Body body) {
+    size_t done = 0;
+    while (done < ops / 10 + 1) done += body();
+
+    g_allocations.store(0, std::memory_order_relaxed);
+    if (all_threads) {
+        g_count_all.store(true, std::memory_order_relaxed);
+    } else {
+        t_counting = true;
+    }
+    done = 0;
+    while (done < ops) done += body();
+    t_counting = false;
+    g_count_all.store(false, std::memory_order_relaxed);
+
+    Result result;
+    result.stage = stage;
+    result.allocations = g_allocations.load(std::memory_order_relaxed);
+    result.commands = done;
+    return result;
+}
+
+bool write_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = write(fd, data.data() + sent, data.size() - sent);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool read_exact(int fd, char* buf, size_t cap, size_t bytes) {
+    while (bytes > 0) {
+        ssize_t n = read(fd, buf, std::min(cap, bytes));
+        if (n <= 0) return false;
+        bytes -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage();
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-n") opt.ops = std::max<size_t>(1, std::stoul(next()));
+        else if (arg == "-r") opt.keyspace = std::max<size_t>(1, std::stoul(next()));
+        else if (arg == "-d") opt.data_size = std::stoul(next());
+        else if (arg == "-P") opt.pipeline = std::max<size_t>(1, std::stoul(next()));
+        else if (arg == "--budget") opt.budget = std::stod(next());
+        else if (arg == "--dir") opt.path = next();
+        else if (arg == "--help") {
+            usage();
+            return 0;
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            usage();
+            return 1;
+        }
+    }
+    if (opt.path.back() != '/') opt.path += '/';
+
+    // 键超过 SSO 长度，确保测到的是真实的堆分配而不是短字符串优化
+    std::vector<std::string> keys;
+    keys.reserve(opt.keyspace);
+    for (size_t i = 0; i < opt.keyspace; ++i) keys.push_back("bench:alloc:key:" + std::to_string(i));
+    const std::string value(opt.data_size, 'x');
+
+    std::vector<Workload> workloads;
+    workloads.push_back(make_workload("GET hit", keys, value, false, opt.pipeline));
+    workloads.push_back(make_workload("SET overwrite", keys, value, true, opt.pipeline));
+
+    std::vector<Result> results;
+    {
+        DataStore::Options store_options;
+        store_options.persist_path = opt.path;
+        store_options.cache_size = opt.keyspace * 2;
+        store_options.adaptive_cache_sizing = false;
+        store_options.sync_interval = std::chrono::seconds(3600);
+        auto store = std::make_shared<DataStore>(store_options);
+        for (const auto& key : keys) store->set(key, value);
+
+        auto handler = std::make_shared<CommandHandler>(store);
+
+        for (const auto& w : workloads) {
+            const std::string label = std::string(w.name) + " ";
+
+            // 1. RESP 解析
+            RESPParser parser;
+            RESPParser::CommandList batch;
+            RESPParser::CommandList spare;
+            size_t b = 0;
+            results.push_back(measure(label + "parse", opt.ops, false, [&]() {
+                size_t idx = b++ % w.batches.size();
+                parser.parse(w.batches[idx], batch, spare);
+                size_t n = batch.size();
+                RESPParser::recycle(batch, spare);
+                return n;
+            }));
+
+            // 2. 存储层
+            std::string out;
+            size_t k = 0;
+            bool set = w.commands[0].size() == 3;
+            results.push_back(measure(label + "datastore", opt.ops, false, [&]() {
+                const auto& key = keys[k++ % keys.size()];
+                if (set) {
+                    store->set(key, value);
+                } else {
+                    store->get_into(key, out);
+                }
+                return size_t(1);
+            }));
+
+            // 3. 命令处理与回复编码
+            std::string reply_buffer;
+            size_t c = 0;
+            results.push_back(measure(label + "command", opt.ops, false, [&]() {
+                reply_buffer.clear();
+                ReplyBuilder reply(reply_buffer);
+                handler->handle(w.commands[c++ % w.commands.size()], reply);
+                return size_t(1);
+            }));
+        }
+
+        // 4. 端到端：Worker 事件循环经 Unix 套接字对收发流水线请求
+        WorkerThread worker(0, handler);
+        worker.start();
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            std::perror("socketpair");
+            return 1;
+        }
+        worker.add_client(fds[1], false);
+
+        std::vector<char> reply(256 * 1024);
+        bool io_ok = true;
+        for (const auto& w : workloads) {
+            size_t b = 0;
+            results.push_back(measure(std::string(w.name) + " end-to-end", opt.ops, true, [&]() -> size_t {
+                size_t idx = b++ % w.batches.size();
+                if (!io_ok || !write_all(fds[0], w.batches[idx]) ||
+                    !read_exact(fds[0], reply.data(), reply.size(), w.batch_reply_bytes[idx])) {
+                    io_ok = false;
+                    return opt.ops;
+                }
+                return w.batch_commands[idx];
+            }));
+        }
+        close(fds[0]);
+        worker.stop();
+        if (!io_ok) {
+            std::cerr << "end-to-end I/O failed" << std::endl;
+            return 1;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(opt.path, ec);
+
+    bool over_budget = false;
+    std::printf("%-28s %12s %12s %10s\n", "stage", "commands", "allocations", "per cmd");
+    for (const auto& r : results) {
+        double per_command = static_cast<double>(r.allocations) / r.commands;
+        bool over = per_command > opt.budget;
+        over_budget |= over;
+        std::printf("%-28s %12zu %12llu %10.4f%s\n", r.stage.c_str(), r.commands,
+                    static_cast<unsigned long long>(r.allocations), per_command, over ? "  OVER BUDGET" : "");
+    }
+    return over_budget ? 1 : 0;
+}
@@ -0,0 +1,167 @@
+// AdaptiveCache 进程内基准测试（不经过网络）
+// 用法示例：
+//   simple_redis_bench_cache -t 1,8,32,64 -n 1000000 -r 100000
+//   simple_redis_bench_cache --counters -t 1,8,32,64
+#include "AdaptiveCache.h"
+#include "ShardedCounter.h"
+#include "Clock.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::vector<size_t> threads{1, 2, 4, 8};
+    size_t ops_per_thread = 1000000;
+    size_t keyspace = 100000;
+    size_t data_size = 16;
+    bool counters = false;      // 只测计数器本身
+};
+
+void usage() {
+    std::cout <<
+        "Usage: simple_redis_bench_cache [options]\n"
+        "  -t <threads>       逗号分隔的线程数列表 (默认 1,2,4,8)\n"
+        "  -n <ops>           每个线程的操作数 (默认 1000000)\n"
+        "  -r <keyspace>      预热的键数量，GET 全部命中 (默认 100000)\n"
+        "  -d <size>          值大小（字节，默认 16）\n"
+        "  --counters         对比单个原子计数与分片计数的递增吞吐\n";
+}
+
+std::vector<size_t> parse_list(const std::string& s) {
+    std::vector<size_t> result;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) result.push_back(std::strtoul(item.c_str(), nullptr, 10));
+    }
+    return result;
+}
+
+// 启动 threads 个线程同时执行 body(thread_index)，返回总耗时（秒）
+template <typename Body>
+double run_threads(size_t threads, Body body) {
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            body(t);
+        });
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& w : workers) w.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* name, size_t threads, size_t ops, double seconds) {
+    std::printf("%-18s threads=%-4zu %10.2f Mops/s\n", name, threads, ops / seconds / 1e6);
+}
+
+void bench_cache_get(const Options& opt) {
+    AdaptiveCache::Options cache_options;
+    cache_options.initial_capacity = opt.keyspace * 2;
+    cache_options.max_capacity = std::max(cache_options.max_capacity, opt.keyspace * 2);
+    cache_options.enable_adaptive_sizing = false;
+    AdaptiveCache cache(cache_options);
+
+    std::vector<std::string> keys;
+    keys.reserve(opt.keyspace);
+    std::string value(opt.data_size, 'x');
+    for (size_t i = 0; i < opt.keyspace; ++i) {
+        keys.push_back("key:" + std::to_string(i));
+        cache.put(keys.back(), value);
+    }
+
+    for (size_t threads : opt.threads) {
+        double seconds = run_threads(threads, [&](size_t t) {
+            std::mt19937_64 rng(t + 1);
+            size_t found = 0;
+            for (size_t i = 0; i < opt.ops_per_thread; ++i) {
+                if (cache.get(keys[rng() % keys.size()])) ++found;
+            }
+            if (found != opt.ops_per_thread) std::fprintf(stderr, "unexpected cache miss\n");
+        });
+        report("cache get (hit)", threads, threads * opt.ops_per_thread, seconds);
+    }
+}
+
+void bench_counters(const Options& opt) {
+    for (size_t threads : opt.threads) {
+        std::atomic<size_t> shared{0};
+        double seconds = run_threads(threads, [&](size_t) {
+            for (size_t i = 0; i < opt.ops_per_thread; ++i) {
+                shared.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+        report("atomic counter", threads, threads * opt.ops_per_thread, seconds);
+
+        ShardedCounter sharded;
+        seconds = run_threads(threads, [&](size_t) {
+            for (size_t i = 0; i < opt.ops_per_thread; ++i) {
+                sharded.inc();
+            }
+        });
+        report("sharded counter", threads, threads * opt.ops_per_thread, seconds);
+
+        if (shared.load() != sharded.load()) {
+            std::fprintf(stderr, "counter mismatch: %zu vs %zu\n", shared.load(), sharded.load());
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage();
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-t") opt.threads = parse_list(next());
+        else if (arg == "-n") opt.ops_per_thread = std::stoul(next());
+        else if (arg == "-r") opt.keyspace = std::max<size_t>(1, std::stoul(next()));
+        else if (arg == "-d") opt.data_size = std::stoul(next());
+        else if (arg == "--counters") opt.counters = true;
+        else if (arg == "--help") {
+            usage();
+            return 0;
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            usage();
+            return 1;
+        }
+    }
+
+    Clock::instance().start();
+
+    if (opt.counters) {
+        bench_counters(opt);
+    } else {
+        bench_cache_get(opt);
+    }
+    Clock::instance().stop();
+    return 0;
+}
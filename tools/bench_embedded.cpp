@@ -0,0 +1,116 @@
+// 嵌入式接口进程内基准测试：测量 C++ 与 C 接口的单次操作耗时（不经过网络与 RESP）
+// 用法示例：
+//   simple_redis_bench_embedded -n 1000000 -r 100000 -d 16
+#include "EmbeddedStore.h"
+#include "simple_redis.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    size_t ops = 1000000;
+    size_t keyspace = 100000;
+    size_t data_size = 16;
+    std::string path = "./bench_embedded_data/";
+};
+
+void usage() {
+    std::cout <<
+        "Usage: simple_redis_bench_embedded [options]\n"
+        "  -n <ops>           每项测试的操作数 (默认 1000000)\n"
+        "  -r <keyspace>      键数量 (默认 100000)\n"
+        "  -d <size>          值大小（字节，默认 16）\n"
+        "  --dir <path>       临时持久化目录 (默认 ./bench_embedded_data/，结束后删除)\n";
+}
+
+template <typename Body>
+void measure(const char* name, size_t ops, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ops; ++i) body(i);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-10s %12.2f ops/s %10.1f ns/op\n", name, ops / seconds, seconds * 1e9 / ops);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage();
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-n") opt.ops = std::max<size_t>(1, std::stoul(next()));
+        else if (arg == "-r") opt.keyspace = std::max<size_t>(1, std::stoul(next()));
+        else if (arg == "-d") opt.data_size = std::stoul(next());
+        else if (arg == "--dir") opt.path = next();
+        else if (arg == "--help") {
+            usage();
+            return 0;
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            usage();
+            return 1;
+        }
+    }
+    if (opt.path.back() != '/') opt.path += '/';
+
+    std::vector<std::string> keys;
+    keys.reserve(opt.keyspace);
+    for (size_t i = 0; i < opt.keyspace; ++i) keys.push_back("key:" + std::to_string(i));
+    const std::string value(opt.data_size, 'x');
+
+    {
+        EmbeddedStore::Options store_options;
+        store_options.persist_path = opt.path;
+        store_options.cache_size = opt.keyspace;
+        EmbeddedStore store(store_options);
+
+        measure("SET", opt.ops, [&](size_t i) { store.set(keys[i % keys.size()], value); });
+        std::string out;
+        measure("GET", opt.ops, [&](size_t i) { store.get(keys[i % keys.size()], out); });
+    }
+
+    {
+        sr_options options;
+        sr_options_init(&options);
+        options.persist_path = opt.path.c_str();
+        options.cache_size = opt.keyspace;
+        char* error = nullptr;
+        sr_store* store = sr_open(&options, &error);
+        if (!store) {
+            std::cerr << "sr_open failed: " << (error ? error : "") << std::endl;
+            sr_free(error);
+            return 1;
+        }
+
+        measure("C SET", opt.ops, [&](size_t i) {
+            const auto& key = keys[i % keys.size()];
+            sr_set(store, key.data(), key.size(), value.data(), value.size());
+        });
+        measure("C GET", opt.ops, [&](size_t i) {
+            const auto& key = keys[i % keys.size()];
+            char* v = nullptr;
+            size_t len = 0;
+            if (sr_get(store, key.data(), key.size(), &v, &len) == 1) sr_free(v);
+        });
+        sr_close(store);
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(opt.path, ec);
+    return 0;
+}
@@ -0,0 +1,183 @@
+// 离线缓存模拟器：把抓取的追踪文件依次交给每种缓存策略与容量，对比命中率
+// 用法示例：
+//   simple_redis_cachesim -f traces/capture-1700000000.trace -s 1000,10000,100000
+// 读写路径与 DataStore 一致：SET/MSET 写入缓存，GET/MGET 未命中时从存储回填，DEL 从缓存移除。
+// 抓取开始前已存在的键视为存在于存储中（回填时值为占位符）。
+#include "AdaptiveCache.h"
+#include "CachePolicy.h"
+#include "Clock.h"
+#include "TraceFormat.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string file;
+    std::vector<size_t> capacities{1000, 10000, 100000};
+    size_t shards = 16;
+};
+
+void usage() {
+    std::cout <<
+        "Usage: simple_redis_cachesim -f <trace> [options]\n"
+        "  -f <trace>         抓取得到的追踪文件\n"
+        "  -s <sizes>         逗号分隔的缓存容量（条目数）列表 (默认 1000,10000,100000)\n"
+        "  --shards <n>       缓存分片数 (默认 16，与服务器一致)\n";
+}
+
+std::vector<size_t> parse_list(const std::string& s) {
+    std::vector<size_t> result;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) result.push_back(std::strtoul(item.c_str(), nullptr, 10));
+    }
+    return result;
+}
+
+std::string lower(const std::string& s) {
+    std::string out = s;
+    std::transform(out.begin(), out.end(), out.begin(), ::tolower);
+    return out;
+}
+
+struct Result {
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    uint64_t evictions = 0;
+};
+
+Result simulate(const std::vector<trace::Record>& records, CachePolicy::Type policy,
+                size_t capacity, size_t shards) {
+    AdaptiveCache::Options cache_options;
+    cache_options.shard_count = shards;
+    cache_options.initial_capacity = capacity;
+    cache_options.min_capacity = std::min(cache_options.min_capacity, capacity);
+    cache_options.max_capacity = std::max(cache_options.max_capacity, capacity);
+    cache_options.policy_type = policy;
+    cache_options.enable_adaptive_sizing = false;
+    AdaptiveCache cache(cache_options);
+
+    // 模拟的后端存储：抓取期间写入的值与删除的键
+    std::unordered_map<std::string, std::string> written;
+    std::unordered_set<std::string> deleted;
+    const std::string placeholder = "?";
+
+    Result result;
+    auto lookup = [&](const std::string& key) {
+        result.lookups++;
+        if (cache.get(key)) {
+            result.hits++;
+            return;
+        }
+        if (deleted.count(key)) return;
+        auto it = written.find(key);
+        cache.put(key, it != written.end() ? it->second : placeholder);
+    };
+    auto store = [&](const std::string& key, const std::string& value) {
+        deleted.erase(key);
+        written[key] = value;
+        cache.put(key, value);
+    };
+
+    for (const auto& record : records) {
+        if (record.args.empty()) continue;
+        std::string cmd = lower(record.args[0]);
+        const auto& args = record.args;
+
+        if (cmd == "get" && args.size() == 2) {
+            lookup(args[1]);
+        } else if (cmd == "mget") {
+            for (size_t i = 1; i < args.size(); ++i) lookup(args[i]);
+        } else if (cmd == "set" && args.size() >= 3) {
+            store(args[1], args[2]);
+        } else if (cmd == "mset") {
+            for (size_t i = 1; i + 1 < args.size(); i += 2) store(args[i], args[i + 1]);
+        } else if (cmd == "del" || cmd == "unlink") {
+            for (size_t i = 1; i < args.size(); ++i) {
+                cache.remove(args[i]);
+                written.erase(args[i]);
+                deleted.insert(args[i]);
+            }
+        }
+    }
+
+    result.evictions = cache.get_stats().evictions;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage();
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-f") opt.file = next();
+        else if (arg == "-s") opt.capacities = parse_list(next());
+        else if (arg == "--shards") opt.shards = std::max<size_t>(1, std::stoul(next()));
+        else if (arg == "--help") {
+            usage();
+            return 0;
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            usage();
+            return 1;
+        }
+    }
+
+    if (opt.file.empty() || opt.capacities.empty()) {
+        usage();
+        return 1;
+    }
+
+    trace::Reader reader;
+    std::string error;
+    if (!reader.open(opt.file, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    std::vector<trace::Record> records;
+    trace::Record record;
+    while (reader.next(record)) {
+        records.push_back(std::move(record));
+    }
+    std::stable_sort(records.begin(), records.end(), [](const trace::Record& a, const trace::Record& b) {
+        return a.timestamp_us < b.timestamp_us;
+    });
+
+    Clock::instance().start();
+
+    std::printf("%zu commands loaded from %s\n", records.size(), opt.file.c_str());
+    std::printf("%-8s %12s %12s %12s %10s %12s\n", "policy", "capacity", "lookups", "hits", "hit_ratio", "evictions");
+    for (auto policy : all_cache_policy_types()) {
+        std::string name = create_cache_policy(policy)->name();
+        for (size_t capacity : opt.capacities) {
+            Result r = simulate(records, policy, capacity, opt.shards);
+            double ratio = r.lookups > 0 ? static_cast<double>(r.hits) / r.lookups : 0.0;
+            std::printf("%-8s %12zu %12lu %12lu %9.2f%% %12lu\n", name.c_str(), capacity,
+                        static_cast<unsigned long>(r.lookups), static_cast<unsigned long>(r.hits),
+                        ratio * 100.0, static_cast<unsigned long>(r.evictions));
+        }
+    }
+
+    Clock::instance().stop();
+    return 0;
+}
@@ -0,0 +1,529 @@
+// simple_redis 负载生成器
+// 用法示例：
+//   simple_redis_loadgen -t set,get -n 1000000 -c 50 -P 16 -r 100000 --zipf 0.99
+//   simple_redis_loadgen --hotkeys 20
+//   simple_redis_loadgen --shm /tmp/simple_redis.shm.sock -t set,get -P 16
+//   simple_redis_loadgen -s /tmp/simple_redis.sock -t set,get
+#include "ShmClient.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 6379;
+    size_t clients = 50;
+    size_t requests = 100000;
+    size_t pipeline = 1;
+    size_t data_size = 3;
+    size_t keyspace = 0;        // 0 表示所有请求使用同一个键
+    double zipf = 0.0;          // >0 时按 Zipf 分布选择键
+    std::vector<std::string> tests{"set", "get"};
+    bool quiet = false;
+    bool hotkeys = false;       // 热点键查询模式
+    size_t hotkeys_count = 10;
+    std::string shm_path;       // 非空时经共享内存传输访问服务器
+    std::string socket_path;    // 非空时经 Unix 域套接字连接
+};
+
+void usage() {
+    std::cout <<
+        "Usage: simple_redis_loadgen [options]\n"
+        "  -h <host>          服务器地址 (默认 127.0.0.1)\n"
+        "  -p <port>          服务器端口 (默认 6379)\n"
+        "  -s <socket>        经 Unix 域套接字连接（覆盖 -h/-p），与 TCP 对比\n"
+        "  -c <clients>       并发连接数 (默认 50)\n"
+        "  -n <requests>      每项测试的请求总数 (默认 100000)\n"
+        "  -P <numreq>        流水线深度 (默认 1)\n"
+        "  -d <size>          SET 值大小（字节，默认 3）\n"
+        "  -r <keyspace>      随机键空间大小 (默认 0：固定键)\n"
+        "  -t <tests>         逗号分隔的测试列表：set,get,mset,mget,del\n"
+        "  --zipf <s>         按 Zipf(s) 分布选择键，制造热点（需配合 -r）\n"
+        "  --hotkeys [N]      查询服务器热点键并输出前 N 项，不产生负载\n"
+        "  --shm <path>       经共享内存传输连接（握手套接字路径），与 TCP 对比\n"
+        "  -q                 只输出每项测试的 QPS\n";
+}
+
+int connect_unix(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return -1;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+int connect_to(const Options& opt) {
+    if (!opt.socket_path.empty()) {
+        return connect_unix(opt.socket_path);
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(opt.host.c_str(), std::to_string(opt.port).c_str(), &hints, &res) != 0 || !res) {
+        return -1;
+    }
+    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) < 0) {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+bool send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+// 解析一条完整的RESP回复，返回结束位置；数据不完整时返回 npos
+size_t skip_reply(const std::string& buf, size_t pos) {
+    if (pos >= buf.size()) return std::string::npos;
+    size_t crlf = buf.find("\r\n", pos);
+    if (crlf == std::string::npos) return std::string::npos;
+    char type = buf[pos];
+    if (type == '+' || type == '-' || type == ':') {
+        return crlf + 2;
+    }
+    long long len = std::atoll(buf.c_str() + pos + 1);
+    if (type == '$') {
+        if (len < 0) return crlf + 2;
+        size_t end = crlf + 2 + static_cast<size_t>(len) + 2;
+        return end <= buf.size() ? end : std::string::npos;
+    }
+    if (type == '*') {
+        size_t p = crlf + 2;
+        for (long long i = 0; i < len; ++i) {
+            p = skip_reply(buf, p);
+            if (p == std::string::npos) return p;
+        }
+        return p;
+    }
+    return std::string::npos;
+}
+
+// 读取 expected 条回复，返回是否成功
+bool read_replies(int fd, std::string& buf, size_t expected) {
+    size_t done = 0;
+    size_t pos = 0;
+    char chunk[16384];
+    while (true) {
+        while (done < expected) {
+            size_t next = skip_reply(buf, pos);
+            if (next == std::string::npos) break;
+            pos = next;
+            ++done;
+        }
+        if (done == expected) break;
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buf.append(chunk, n);
+    }
+    buf.erase(0, pos);
+    return true;
+}
+
+void append_command(std::string& out, const std::vector<std::string>& args) {
+    out += "*" + std::to_string(args.size()) + "\r\n";
+    for (const auto& a : args) {
+        out += "$" + std::to_string(a.size()) + "\r\n";
+        out += a;
+        out += "\r\n";
+    }
+}
+
+// 键选择器：固定键 / 均匀随机 / Zipf
+class KeyPicker {
+public:
+    KeyPicker(const Options& opt) : keyspace_(opt.keyspace) {
+        if (opt.zipf > 0.0 && keyspace_ > 0) {
+            cdf_.resize(keyspace_);
+            double sum = 0.0;
+            for (size_t i = 0; i < keyspace_; ++i) {
+                sum += 1.0 / std::pow(static_cast<double>(i + 1), opt.zipf);
+                cdf_[i] = sum;
+            }
+            for (auto& v : cdf_) v /= sum;
+        }
+    }
+
+    std::string pick(std::mt19937_64& rng) const {
+        if (keyspace_ == 0) return "key:__rand_int__";
+        size_t idx;
+        std::uniform_real_distribution<double> uni(0.0, 1.0);
+        if (!cdf_.empty()) {
+            idx = std::lower_bound(cdf_.begin(), cdf_.end(), uni(rng)) - cdf_.begin();
+            if (idx >= keyspace_) idx = keyspace_ - 1;
+        } else {
+            idx = rng() % keyspace_;
+        }
+        char name[32];
+        std::snprintf(name, sizeof(name), "key:%012zu", idx);
+        return name;
+    }
+
+private:
+    size_t keyspace_;
+    std::vector<double> cdf_;
+};
+
+struct ThreadResult {
+    uint64_t completed = 0;
+    bool failed = false;
+    std::vector<uint32_t> latencies_us;  // 每个流水线批次的往返时延
+};
+
+std::vector<std::string> make_command(const std::string& test, const KeyPicker& picker,
+                                      std::mt19937_64& rng, const std::string& value) {
+    if (test == "set") return {"SET", picker.pick(rng), value};
+    if (test == "get") return {"GET", picker.pick(rng)};
+    if (test == "del") return {"DEL", picker.pick(rng)};
+    if (test == "mset") {
+        std::vector<std::string> cmd{"MSET"};
+        for (int i = 0; i < 10; ++i) {
+            cmd.push_back(picker.pick(rng));
+            cmd.push_back(value);
+        }
+        return cmd;
+    }
+    if (test == "mget") {
+        std::vector<std::string> cmd{"MGET"};
+        for (int i = 0; i < 10; ++i) cmd.push_back(picker.pick(rng));
+        return cmd;
+    }
+    return {};
+}
+
+void run_shm_client(const Options& opt, const std::string& test, const KeyPicker& picker,
+                    size_t requests, uint64_t seed, ThreadResult& result) {
+    ShmClient client;
+    std::string error;
+    if (!client.connect(opt.shm_path, error)) {
+        std::cerr << error << std::endl;
+        result.failed = true;
+        return;
+    }
+
+    std::mt19937_64 rng(seed);
+    std::string value(opt.data_size, 'x');
+    std::vector<std::vector<std::string>> commands;
+    std::vector<std::vector<std::string_view>> views;
+    result.latencies_us.reserve(requests / opt.pipeline + 1);
+
+    size_t remaining = requests;
+    while (remaining > 0) {
+        size_t batch = std::min(opt.pipeline, remaining);
+        commands.resize(batch);
+        views.resize(batch);
+        for (size_t i = 0; i < batch; ++i) {
+            commands[i] = make_command(test, picker, rng, value);
+            views[i].assign(commands[i].begin(), commands[i].end());
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (!client.pipeline(views, [](std::string_view) {})) {
+            std::cerr << client.last_error() << std::endl;
+            result.failed = true;
+            break;
+        }
+        auto end = std::chrono::steady_clock::now();
+        result.latencies_us.push_back(static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()));
+
+        result.completed += batch;
+        remaining -= batch;
+    }
+}
+
+void run_client(const Options& opt, const std::string& test, const KeyPicker& picker,
+                size_t requests, uint64_t seed, ThreadResult& result) {
+    if (!opt.shm_path.empty()) {
+        run_shm_client(opt, test, picker, requests, seed, result);
+        return;
+    }
+
+    int fd = connect_to(opt);
+    if (fd < 0) {
+        result.failed = true;
+        return;
+    }
+
+    std::mt19937_64 rng(seed);
+    std::string value(opt.data_size, 'x');
+    std::string out;
+    std::string in;
+    result.latencies_us.reserve(requests / opt.pipeline + 1);
+
+    size_t remaining = requests;
+    while (remaining > 0) {
+        size_t batch = std::min(opt.pipeline, remaining);
+        out.clear();
+        for (size_t i = 0; i < batch; ++i) {
+            append_command(out, make_command(test, picker, rng, value));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (!send_all(fd, out) || !read_replies(fd, in, batch)) {
+            result.failed = true;
+            break;
+        }
+        auto end = std::chrono::steady_clock::now();
+        result.latencies_us.push_back(static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()));
+
+        result.completed += batch;
+        remaining -= batch;
+    }
+
+    close(fd);
+}
+
+void run_test(const Options& opt, const std::string& test, const KeyPicker& picker) {
+    std::vector<ThreadResult> results(opt.clients);
+    std::vector<std::thread> threads;
+    threads.reserve(opt.clients);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < opt.clients; ++i) {
+        size_t share = opt.requests / opt.clients + (i < opt.requests % opt.clients ? 1 : 0);
+        threads.emplace_back(run_client, std::cref(opt), std::cref(test), std::cref(picker),
+                             share, 0x5eed0000 + i, std::ref(results[i]));
+    }
+    for (auto& t : threads) t.join();
+    auto end = std::chrono::steady_clock::now();
+
+    uint64_t completed = 0;
+    size_t failed = 0;
+    std::vector<uint32_t> latencies;
+    for (auto& r : results) {
+        completed += r.completed;
+        failed += r.failed ? 1 : 0;
+        latencies.insert(latencies.end(), r.latencies_us.begin(), r.latencies_us.end());
+    }
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double qps = seconds > 0 ? completed / seconds : 0.0;
+
+    std::string name = test;
+    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+    if (opt.quiet) {
+        std::cout << name << ": " << std::fixed << std::setprecision(2) << qps
+                  << " requests per second" << std::endl;
+        return;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto pct = [&](double p) -> double {
+        if (latencies.empty()) return 0.0;
+        size_t idx = std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()));
+        return latencies[idx] / 1000.0;
+    };
+
+    std::cout << "====== " << name << " ======" << std::endl;
+    std::cout << "  " << completed << " requests completed in " << std::fixed
+              << std::setprecision(2) << seconds << " seconds" << std::endl;
+    std::cout << "  " << opt.clients << " parallel clients, pipeline " << opt.pipeline
+              << ", " << opt.data_size << " bytes payload" << std::endl;
+    if (failed > 0) {
+        std::cout << "  " << failed << " clients failed" << std::endl;
+    }
+    std::cout << "  latency per batch (ms): p50=" << std::setprecision(3) << pct(0.50)
+              << " p99=" << pct(0.99) << " p99.9=" << pct(0.999)
+              << " max=" << (latencies.empty() ? 0.0 : latencies.back() / 1000.0) << std::endl;
+    std::cout << "  " << std::setprecision(2) << qps << " requests per second" << std::endl
+              << std::endl;
+}
+
+// 简单的RESP值，用于展示 HOTKEYS 结果
+struct Reply {
+    char type = 0;
+    std::string str;
+    long long integer = 0;
+    std::vector<Reply> elements;
+};
+
+size_t parse_reply(const std::string& buf, size_t pos, Reply& out) {
+    size_t crlf = buf.find("\r\n", pos);
+    if (crlf == std::string::npos) return std::string::npos;
+    out.type = buf[pos];
+    std::string line = buf.substr(pos + 1, crlf - pos - 1);
+    size_t p = crlf + 2;
+    switch (out.type) {
+        case '+':
+        case '-':
+            out.str = line;
+            return p;
+        case ':':
+            out.integer = std::atoll(line.c_str());
+            return p;
+        case '$': {
+            long long len = std::atoll(line.c_str());
+            if (len < 0) return p;
+            if (p + len + 2 > buf.size()) return std::string::npos;
+            out.str = buf.substr(p, len);
+            return p + len + 2;
+        }
+        case '*': {
+            long long len = std::atoll(line.c_str());
+            for (long long i = 0; i < len; ++i) {
+                Reply child;
+                p = parse_reply(buf, p, child);
+                if (p == std::string::npos) return p;
+                out.elements.push_back(std::move(child));
+            }
+            return p;
+        }
+    }
+    return std::string::npos;
+}
+
+int run_hotkeys(const Options& opt) {
+    int fd = connect_to(opt);
+    if (fd < 0) {
+        std::cerr << "Could not connect to " << opt.host << ":" << opt.port << std::endl;
+        return 1;
+    }
+
+    std::string out;
+    append_command(out, {"HOTKEYS", "COUNT", std::to_string(opt.hotkeys_count)});
+    std::string in;
+    if (!send_all(fd, out)) {
+        close(fd);
+        return 1;
+    }
+
+    Reply reply;
+    char chunk[16384];
+    while (parse_reply(in, 0, reply) == std::string::npos) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            close(fd);
+            return 1;
+        }
+        in.append(chunk, n);
+        reply = Reply{};
+    }
+    close(fd);
+
+    if (reply.type == '-') {
+        std::cerr << "Server error: " << reply.str << std::endl;
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(6) << "rank" << std::setw(40) << "key"
+              << std::right << std::setw(14) << "ops/sec" << std::setw(14) << "accesses"
+              << std::setw(12) << "error" << std::endl;
+    size_t rank = 1;
+    for (const auto& item : reply.elements) {
+        if (item.elements.size() < 4) continue;
+        std::cout << std::left << std::setw(6) << rank++ << std::setw(40) << item.elements[0].str
+                  << std::right << std::setw(14) << item.elements[1].str
+                  << std::setw(14) << item.elements[2].integer
+                  << std::setw(12) << item.elements[3].integer << std::endl;
+    }
+    return 0;
+}
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, sep)) {
+        if (!item.empty()) parts.push_back(item);
+    }
+    return parts;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage();
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-h") opt.host = next();
+        else if (arg == "-p") opt.port = std::stoi(next());
+        else if (arg == "-s") opt.socket_path = next();
+        else if (arg == "-c") opt.clients = std::max<size_t>(1, std::stoul(next()));
+        else if (arg == "-n") opt.requests = std::stoul(next());
+        else if (arg == "-P") opt.pipeline = std::max<size_t>(1, std::stoul(next()));
+        else if (arg == "-d") opt.data_size = std::stoul(next());
+        else if (arg == "-r") opt.keyspace = std::stoul(next());
+        else if (arg == "-t") opt.tests = split(next(), ',');
+        else if (arg == "--zipf") opt.zipf = std::stod(next());
+        else if (arg == "-q") opt.quiet = true;
+        else if (arg == "--shm") opt.shm_path = next();
+        else if (arg == "--hotkeys") {
+            opt.hotkeys = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                opt.hotkeys_count = std::stoul(argv[++i]);
+            }
+        }
+        else if (arg == "--help") {
+            usage();
+            return 0;
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            usage();
+            return 1;
+        }
+    }
+
+    if (opt.hotkeys) {
+        return run_hotkeys(opt);
+    }
+
+    KeyPicker picker(opt);
+    for (const auto& test : opt.tests) {
+        std::string lower = test;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        run_test(opt, lower, picker);
+    }
+    return 0;
+}
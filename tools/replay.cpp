@@ -0,0 +1,332 @@
+// 追踪文件回放工具：按原始节奏、缩放节奏或最快速度把抓取的命令重新发给服务器
+// 用法示例：
+//   simple_redis_replay -f traces/capture-1700000000.trace
+//   simple_redis_replay -f capture.trace --speed 4
+//   simple_redis_replay -f capture.trace --max
+// 回放是确定的：记录按时间戳稳定排序，每个原始连接对应一条新连接，连接内命令顺序不变。
+#include "TraceFormat.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string file;
+    std::string host = "127.0.0.1";
+    int port = 6379;
+    double speed = 1.0;         // 节奏倍数：2 表示以两倍速度回放
+    bool max_speed = false;     // 忽略时间戳，尽快发送
+    size_t window = 256;        // 每个连接最多未收到回复的命令数
+};
+
+void usage() {
+    std::cout <<
+        "Usage: simple_redis_replay -f <trace> [options]\n"
+        "  -f <trace>         抓取得到的追踪文件\n"
+        "  -h <host>          服务器地址 (默认 127.0.0.1)\n"
+        "  -p <port>          服务器端口 (默认 6379)\n"
+        "  --speed <x>        按原始节奏的 x 倍回放 (默认 1)\n"
+        "  --max              忽略时间戳，以最快速度回放\n"
+        "  --window <n>       每个连接最多 n 条命令未收到回复 (默认 256)\n";
+}
+
+using Clock = std::chrono::steady_clock;
+
+int connect_to(const Options& opt) {
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(opt.host.c_str(), std::to_string(opt.port).c_str(), &hints, &res) != 0 || !res) {
+        return -1;
+    }
+    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) < 0) {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+bool send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+// 解析一条完整的RESP回复，返回结束位置；数据不完整时返回 npos
+size_t skip_reply(const std::string& buf, size_t pos) {
+    if (pos >= buf.size()) return std::string::npos;
+    size_t crlf = buf.find("\r\n", pos);
+    if (crlf == std::string::npos) return std::string::npos;
+    char type = buf[pos];
+    if (type == '+' || type == '-' || type == ':') {
+        return crlf + 2;
+    }
+    long long len = std::atoll(buf.c_str() + pos + 1);
+    if (type == '$') {
+        if (len < 0) return crlf + 2;
+        size_t end = crlf + 2 + static_cast<size_t>(len) + 2;
+        return end <= buf.size() ? end : std::string::npos;
+    }
+    if (type == '*') {
+        size_t p = crlf + 2;
+        for (long long i = 0; i < len; ++i) {
+            p = skip_reply(buf, p);
+            if (p == std::string::npos) return p;
+        }
+        return p;
+    }
+    return std::string::npos;
+}
+
+void append_command(std::string& out, const std::vector<std::string>& args) {
+    out += "*" + std::to_string(args.size()) + "\r\n";
+    for (const auto& a : args) {
+        out += "$" + std::to_string(a.size()) + "\r\n";
+        out += a;
+        out += "\r\n";
+    }
+}
+
+struct Connection {
+    int fd = -1;
+    std::string out;            // 待发送的命令
+    std::string in;             // 未解析完的回复
+    size_t outstanding = 0;     // 已发送未收到回复的命令数
+    uint64_t errors = 0;        // 错误回复数
+};
+
+class Replayer {
+public:
+    explicit Replayer(const Options& opt) : opt_(opt) {}
+
+    ~Replayer() {
+        for (auto& [id, conn] : conns_) {
+            if (conn.fd >= 0) close(conn.fd);
+        }
+    }
+
+    bool run(std::vector<trace::Record>& records) {
+        // 按时间戳稳定排序：同一连接的记录时间戳单调，排序不会打乱连接内顺序
+        std::stable_sort(records.begin(), records.end(), [](const trace::Record& a, const trace::Record& b) {
+            return a.timestamp_us < b.timestamp_us;
+        });
+
+        auto start = Clock::now();
+        uint64_t base_us = records.empty() ? 0 : records.front().timestamp_us;
+        double max_lag_ms = 0.0;
+        double total_lag_ms = 0.0;
+
+        for (const auto& record : records) {
+            if (!opt_.max_speed) {
+                auto target = start + std::chrono::microseconds(
+                    static_cast<int64_t>((record.timestamp_us - base_us) / opt_.speed));
+                if (!wait_until(target)) return false;
+                double lag = std::chrono::duration<double, std::milli>(Clock::now() - target).count();
+                max_lag_ms = std::max(max_lag_ms, lag);
+                total_lag_ms += lag;
+            }
+
+            Connection* conn = connection(record.connection_id);
+            if (!conn) return false;
+            if (conn->outstanding >= opt_.window) {
+                if (!flush(*conn) || !drain(*conn, opt_.window / 2)) return false;
+            }
+            append_command(conn->out, record.args);
+            conn->outstanding++;
+
+            // 按原始节奏回放时立即发送；最快速度时攒到一定大小再发送
+            if (!opt_.max_speed || conn->out.size() >= 16384) {
+                if (!flush(*conn)) return false;
+            }
+        }
+
+        for (auto& [id, conn] : conns_) {
+            if (!flush(conn) || !drain(conn, 0)) return false;
+        }
+
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        uint64_t errors = 0;
+        for (const auto& [id, conn] : conns_) errors += conn.errors;
+
+        double original = records.empty() ? 0.0 : (records.back().timestamp_us - base_us) / 1e6;
+        std::printf("Replayed %zu commands over %zu connections in %.3f s (%.2f ops/s)\n",
+                    records.size(), conns_.size(), elapsed, elapsed > 0 ? records.size() / elapsed : 0.0);
+        std::printf("Original duration %.3f s, error replies %lu\n", original, static_cast<unsigned long>(errors));
+        if (!opt_.max_speed && !records.empty()) {
+            std::printf("Schedule lag: avg %.3f ms, max %.3f ms\n", total_lag_ms / records.size(), max_lag_ms);
+        }
+        return true;
+    }
+
+private:
+    Connection* connection(uint64_t id) {
+        auto it = conns_.find(id);
+        if (it != conns_.end()) return &it->second;
+        Connection conn;
+        conn.fd = connect_to(opt_);
+        if (conn.fd < 0) {
+            std::cerr << "Failed to connect to " << opt_.host << ":" << opt_.port << std::endl;
+            return nullptr;
+        }
+        return &conns_.emplace(id, std::move(conn)).first->second;
+    }
+
+    bool flush(Connection& conn) {
+        if (conn.out.empty()) return true;
+        if (!send_all(conn.fd, conn.out)) {
+            std::cerr << "Send failed" << std::endl;
+            return false;
+        }
+        conn.out.clear();
+        return true;
+    }
+
+    // 解析已收到的回复
+    void consume(Connection& conn) {
+        size_t pos = 0;
+        while (conn.outstanding > 0) {
+            size_t next = skip_reply(conn.in, pos);
+            if (next == std::string::npos) break;
+            if (conn.in[pos] == '-') conn.errors++;
+            pos = next;
+            conn.outstanding--;
+        }
+        conn.in.erase(0, pos);
+    }
+
+    bool read_some(Connection& conn, int flags) {
+        char chunk[65536];
+        ssize_t n = recv(conn.fd, chunk, sizeof(chunk), flags);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            std::cerr << "Connection closed by server" << std::endl;
+            return false;
+        }
+        if (n > 0) {
+            conn.in.append(chunk, n);
+            consume(conn);
+        }
+        return true;
+    }
+
+    // 阻塞读取直到未完成命令数不超过 limit
+    bool drain(Connection& conn, size_t limit) {
+        while (conn.outstanding > limit) {
+            if (!read_some(conn, 0)) return false;
+        }
+        return true;
+    }
+
+    // 等待到目标时间，期间收取各连接的回复
+    bool wait_until(Clock::time_point target) {
+        std::vector<pollfd> fds;
+        std::vector<Connection*> owners;
+        while (true) {
+            auto now = Clock::now();
+            if (now >= target) return true;
+
+            fds.clear();
+            owners.clear();
+            for (auto& [id, conn] : conns_) {
+                if (conn.outstanding > 0) {
+                    fds.push_back(pollfd{conn.fd, POLLIN, 0});
+                    owners.push_back(&conn);
+                }
+            }
+            int timeout_ms = static_cast<int>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(target - now).count());
+            if (fds.empty()) {
+                std::this_thread::sleep_until(target);
+                return true;
+            }
+            if (poll(fds.data(), fds.size(), timeout_ms) < 0 && errno != EINTR) return false;
+            for (size_t i = 0; i < fds.size(); ++i) {
+                if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                    if (!read_some(*owners[i], MSG_DONTWAIT)) return false;
+                }
+            }
+        }
+    }
+
+    const Options& opt_;
+    std::unordered_map<uint64_t, Connection> conns_;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage();
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-f") opt.file = next();
+        else if (arg == "-h") opt.host = next();
+        else if (arg == "-p") opt.port = std::stoi(next());
+        else if (arg == "--speed") opt.speed = std::stod(next());
+        else if (arg == "--max") opt.max_speed = true;
+        else if (arg == "--window") opt.window = std::max<size_t>(1, std::stoul(next()));
+        else if (arg == "--help") {
+            usage();
+            return 0;
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            usage();
+            return 1;
+        }
+    }
+
+    if (opt.file.empty() || opt.speed <= 0) {
+        usage();
+        return 1;
+    }
+
+    trace::Reader reader;
+    std::string error;
+    if (!reader.open(opt.file, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    std::vector<trace::Record> records;
+    trace::Record record;
+    while (reader.next(record)) {
+        records.push_back(std::move(record));
+    }
+
+    Replayer replayer(opt);
+    return replayer.run(records) ? 0 : 1;
+}